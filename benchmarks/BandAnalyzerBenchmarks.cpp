@@ -0,0 +1,87 @@
+#include "BenchmarkClock.h"
+
+#include "dsp/BandAnalyzer.h"
+#include "dsp/BandAnalyzer3.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+constexpr auto benchSampleRate = 48000.0;
+
+// One frame of colour analysis for a view `width` columns wide: a 12 ms window per column,
+// per-column scalar calls against the batched SIMD path.
+void benchmarkColumns(int width)
+{
+    constexpr auto windowSamples = 576;
+    const auto columnStep = 40;
+
+    std::vector<float> history(static_cast<size_t>(width * columnStep + windowSamples));
+    for (size_t i = 0; i < history.size(); ++i)
+        history[i] = 0.001f * static_cast<float>((i * 7) % 997) - 0.5f;
+
+    std::vector<const float*> segments(static_cast<size_t>(width));
+    std::vector<int> lengths(static_cast<size_t>(width), windowSamples);
+    std::vector<wvfrm::BandEnergies> results(static_cast<size_t>(width));
+
+    for (int x = 0; x < width; ++x)
+        segments[static_cast<size_t>(x)] = history.data() + x * columnStep;
+
+    wvfrm::BandAnalyzer3 analyzer;
+    const auto samplesPerFrame = static_cast<int64_t>(width) * windowSamples;
+
+    const auto scalar = wvfrm::bench::measurePerSample(samplesPerFrame, 8, [&]
+    {
+        for (int x = 0; x < width; ++x)
+            results[static_cast<size_t>(x)] = analyzer.analyzeSegment(segments[static_cast<size_t>(x)], windowSamples, benchSampleRate, 0.35f);
+    });
+
+    const auto batched = wvfrm::bench::measurePerSample(samplesPerFrame, 8, [&]
+    {
+        // The view hands over one batch at a time as columns miss the band-energy ring.
+        for (int x = 0; x < width; x += wvfrm::BandAnalyzer3::batchSize)
+        {
+            const auto count = juce::jmin(wvfrm::BandAnalyzer3::batchSize, width - x);
+            analyzer.analyzeSegments(segments.data() + x, lengths.data() + x, count, benchSampleRate, 0.35f, results.data() + x);
+        }
+    });
+
+    std::printf("bands    width %5d : scalar %6.2f  batched %6.2f cycles/sample  %5.2fx  (%6.2f ms/frame batched)\n",
+                width,
+                scalar.cyclesPerSample,
+                batched.cyclesPerSample,
+                scalar.cyclesPerSample / batched.cyclesPerSample,
+                batched.nanosPerSample * static_cast<double>(samplesPerFrame) * 1.0e-6);
+}
+
+// Streaming cost per input sample of the Linkwitz-Riley bank at several band counts.
+template <int NumBands>
+void benchmarkCrossover(const char* name, const std::vector<float>& input)
+{
+    const wvfrm::BandAnalyzer<NumBands> analyzer;
+    typename wvfrm::BandAnalyzer<NumBands>::Stream stream;
+    typename wvfrm::BandAnalyzer<NumBands>::Energies sums {};
+
+    const auto result = wvfrm::bench::measurePerSample(static_cast<int64_t>(input.size()), 16, [&]
+    {
+        analyzer.accumulate(stream, input.data(), static_cast<int>(input.size()), sums);
+    });
+
+    std::printf("bands    %-16s : %6.2f cycles/sample\n", name, result.cyclesPerSample);
+}
+}
+
+void runBandAnalyzerBenchmarks()
+{
+    for (const auto width : { 1920, 3840 })
+        benchmarkColumns(width);
+
+    std::vector<float> input(48000);
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = 0.001f * static_cast<float>((i * 7) % 997) - 0.5f;
+
+    benchmarkCrossover<3>("LR4 3", input);
+    benchmarkCrossover<4>("LR4 4", input);
+    benchmarkCrossover<8>("LR4 8", input);
+}
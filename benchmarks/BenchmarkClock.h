@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+ #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+ #include <x86intrin.h>
+#endif
+
+namespace wvfrm::bench
+{
+
+// Reads the CPU timestamp counter where available; elsewhere falls back to nanoseconds.
+inline uint64_t readCycleCounter() noexcept
+{
+   #if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return static_cast<uint64_t>(__rdtsc());
+   #else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+   #endif
+}
+
+struct Measurement
+{
+    double cyclesPerSample = 0.0;
+    double nanosPerSample = 0.0;
+};
+
+template <typename Body>
+Measurement measurePerSample(int64_t samplesPerRun, int runs, Body&& body)
+{
+    body(); // warm caches and branch predictors
+
+    const auto wallStart = std::chrono::steady_clock::now();
+    const auto cycleStart = readCycleCounter();
+
+    for (int run = 0; run < runs; ++run)
+        body();
+
+    const auto cycleEnd = readCycleCounter();
+    const auto wallEnd = std::chrono::steady_clock::now();
+
+    const auto totalSamples = static_cast<double>(samplesPerRun) * static_cast<double>(runs);
+    const auto nanos = std::chrono::duration<double, std::nano>(wallEnd - wallStart).count();
+
+    Measurement result;
+    result.cyclesPerSample = static_cast<double>(cycleEnd - cycleStart) / totalSamples;
+    result.nanosPerSample = nanos / totalSamples;
+    return result;
+}
+
+} // namespace wvfrm::bench
@@ -0,0 +1,145 @@
+#include "BenchmarkClock.h"
+
+#include "dsp/AnalysisRingBuffer.h"
+#include "dsp/BlockSummary.h"
+#include "dsp/HalfBandDecimator.h"
+
+#include <cstdio>
+
+namespace
+{
+constexpr auto benchSampleRate = 48000;
+constexpr auto benchBlockSize = 512;
+
+// Everything processBlock does with the input for one block: ring push (with its pyramid and
+// band energies) and summaries.
+void benchmarkCapture(int channels)
+{
+    wvfrm::AnalysisRingBuffer ring;
+    ring.prepare(channels, benchSampleRate * 9);
+    ring.enableBandEnergies(benchSampleRate);
+
+    wvfrm::BlockSummaryQueue queue(4096);
+    wvfrm::BlockSummarizer summarizer;
+    summarizer.prepare(wvfrm::BlockSummarizer::defaultSamplesPerSummary);
+
+    juce::AudioBuffer<float> block(channels, benchBlockSize);
+    for (int channel = 0; channel < channels; ++channel)
+        for (int s = 0; s < benchBlockSize; ++s)
+            block.setSample(channel, s, 0.001f * static_cast<float>((s * (channel + 3)) % 997) - 0.5f);
+
+    constexpr auto blocksPerRun = (benchSampleRate * 10) / benchBlockSize;
+    int64_t position = 0;
+    wvfrm::BlockSummary drained;
+
+    const auto result = wvfrm::bench::measurePerSample(static_cast<int64_t>(blocksPerRun) * benchBlockSize, 8, [&]
+    {
+        for (int b = 0; b < blocksPerRun; ++b)
+        {
+            ring.pushBuffer(block);
+            summarizer.process(block, position, 0.0, 0.0, queue);
+            position += benchBlockSize;
+
+            // Stand-in for the UI draining at its own pace so the queue never saturates.
+            while (queue.pop(drained))
+            {
+            }
+        }
+    });
+
+    const auto budgetNanosPerFrame = 1.0e9 / benchSampleRate;
+    std::printf("capture  channels %3d : %7.2f cycles/frame  %6.2f cycles/channel-sample  %5.2f%% of real time\n",
+                channels,
+                result.cyclesPerSample,
+                result.cyclesPerSample / channels,
+                100.0 * result.nanosPerSample / budgetNanosPerFrame);
+}
+
+// The reduced analysis rate: half-band cascade in front of the same capture path. The UI's
+// per-frame work scales with the samples per window, printed alongside.
+void benchmarkReducedCapture(double sampleRate)
+{
+    constexpr auto channels = 2;
+
+    wvfrm::HalfBandDecimator decimator;
+    decimator.prepare(channels, benchBlockSize);
+    decimator.setNumStages(wvfrm::HalfBandDecimator::stagesForRate(sampleRate));
+
+    wvfrm::AnalysisRingBuffer ring;
+    ring.prepare(channels, static_cast<int>(sampleRate) * 9 / decimator.getFactor());
+    ring.enableBandEnergies(sampleRate / decimator.getFactor());
+
+    wvfrm::BlockSummaryQueue queue(4096);
+    wvfrm::BlockSummarizer summarizer;
+    summarizer.prepare(wvfrm::BlockSummarizer::defaultSamplesPerSummary);
+
+    juce::AudioBuffer<float> block(channels, benchBlockSize);
+    for (int channel = 0; channel < channels; ++channel)
+        for (int s = 0; s < benchBlockSize; ++s)
+            block.setSample(channel, s, 0.001f * static_cast<float>((s * (channel + 3)) % 997) - 0.5f);
+
+    const auto blocksPerRun = static_cast<int>(sampleRate * 10.0) / benchBlockSize;
+    wvfrm::BlockSummary drained;
+
+    const auto result = wvfrm::bench::measurePerSample(static_cast<int64_t>(blocksPerRun) * benchBlockSize, 8, [&]
+    {
+        for (int b = 0; b < blocksPerRun; ++b)
+        {
+            const auto produced = decimator.process(block.getArrayOfReadPointers(), channels, benchBlockSize);
+            const auto start = ring.getTotalWrittenSamples();
+            ring.pushSamples(decimator.getOutput(), decimator.getEnvelopeMinimum(), decimator.getEnvelopeMaximum(), channels, produced);
+            summarizer.process(decimator.getOutput(), channels, produced, start, 0.0, 0.0, queue,
+                               decimator.getEnvelopeMinimum(), decimator.getEnvelopeMaximum());
+
+            while (queue.pop(drained))
+            {
+            }
+        }
+    });
+
+    const auto budgetNanosPerFrame = 1.0e9 / sampleRate;
+    std::printf("reduced  rate %6.0f : %7.2f cycles/frame  %5.2f%% of real time  %6.0f UI samples per 1 s window\n",
+                sampleRate,
+                result.cyclesPerSample,
+                100.0 * result.nanosPerSample / budgetNanosPerFrame,
+                sampleRate / decimator.getFactor());
+}
+
+void benchmarkPeakQuery(int channels, int windowSamples)
+{
+    wvfrm::AnalysisRingBuffer ring;
+    ring.prepare(channels, benchSampleRate * 9);
+
+    juce::AudioBuffer<float> block(channels, 4096);
+    block.clear();
+    for (int i = 0; i < (benchSampleRate * 9) / 4096 + 8; ++i)
+        ring.pushBuffer(block);
+
+    const auto end = ring.getTotalWrittenSamples();
+    float minimum = 0.0f;
+    float maximum = 0.0f;
+
+    const auto result = wvfrm::bench::measurePerSample(static_cast<int64_t>(windowSamples) * channels, 64, [&]
+    {
+        for (int channel = 0; channel < channels; ++channel)
+            ring.getPeakRange(channel, end - windowSamples, end, minimum, maximum);
+    });
+
+    std::printf("min/max  channels %3d window %7d : %9.5f cycles/channel-sample\n",
+                channels,
+                windowSamples,
+                result.cyclesPerSample);
+}
+}
+
+void runCaptureBenchmarks()
+{
+    for (const auto channels : { 1, 2, 6, 12 })
+        benchmarkCapture(channels);
+
+    for (const auto rate : { 48000.0, 96000.0, 192000.0 })
+        benchmarkReducedCapture(rate);
+
+    for (const auto channels : { 1, 2, 12 })
+        benchmarkPeakQuery(channels, benchSampleRate);
+}
@@ -0,0 +1,159 @@
+#include "BenchmarkClock.h"
+
+#include "ui/BandColumnPasses.h"
+#include "ui/ColourLut.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+// Colouring every column of a frame in three-band mode: band shaping plus colourFor() per
+// column, against the same through a ColourLut.
+void benchmarkColours(int width)
+{
+    std::vector<wvfrm::BandEnergies> energies(static_cast<size_t>(width));
+    std::vector<float> amplitudes(static_cast<size_t>(width));
+    std::vector<juce::uint32> colours(static_cast<size_t>(width));
+
+    for (int x = 0; x < width; ++x)
+    {
+        energies[static_cast<size_t>(x)] = { static_cast<float>((x * 37) % 101) / 100.0f,
+                                             static_cast<float>((x * 53) % 97) / 96.0f,
+                                             static_cast<float>((x * 71) % 89) / 88.0f };
+        amplitudes[static_cast<size_t>(x)] = static_cast<float>((x * 29) % 83) / 82.0f;
+    }
+
+    constexpr auto theme = wvfrm::ThemePreset::rekordboxInspired;
+    constexpr auto mode = wvfrm::ColorMode::threeBand;
+    constexpr auto intensity = 80.0f;
+    constexpr auto colorMatch = 60.0f;
+
+    wvfrm::ThemeEngine engine;
+    const auto direct = wvfrm::bench::measurePerSample(width, 16, [&]
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const auto& e = energies[static_cast<size_t>(x)];
+            const wvfrm::BandEnergies shaped { wvfrm::ThemeEngine::shapeBandIntensity(e.low, intensity),
+                                               wvfrm::ThemeEngine::shapeBandIntensity(e.mid, intensity),
+                                               wvfrm::ThemeEngine::shapeBandIntensity(e.high, intensity) };
+            colours[static_cast<size_t>(x)] = engine.colourFor(shaped, theme, mode, intensity, amplitudes[static_cast<size_t>(x)], colorMatch).getARGB();
+        }
+    });
+
+    wvfrm::ColourLut lut;
+    const auto build = wvfrm::bench::measurePerSample(1, 4, [&]
+    {
+        lut.prepare(engine, { theme, mode, intensity, colorMatch });
+        lut.prepare(engine, { theme, mode, intensity, colorMatch + 1.0f });
+    });
+
+    const auto table = wvfrm::bench::measurePerSample(width, 16, [&]
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const auto& e = energies[static_cast<size_t>(x)];
+            const wvfrm::BandEnergies shaped { lut.shapeBand(e.low), lut.shapeBand(e.mid), lut.shapeBand(e.high) };
+            colours[static_cast<size_t>(x)] = lut.lookup(shaped, amplitudes[static_cast<size_t>(x)]);
+        }
+    });
+
+    std::printf("colour   width %5d : colourFor %8.1f  lut %8.1f cycles/column  %5.2fx  (rebuild %6.3f ms)\n",
+                width,
+                direct.cyclesPerSample,
+                table.cyclesPerSample,
+                direct.cyclesPerSample / table.cyclesPerSample,
+                build.nanosPerSample * 0.5e-6);
+}
+
+// A frame's band post-processing in three-band mode: the per-column blur of AoS energies with
+// an exp() per band for the smoothing, against the SoA passes with per-frame alphas.
+void benchmarkColourPasses(int width)
+{
+    const auto size = static_cast<size_t>(width);
+    std::vector<wvfrm::BandEnergies> energies(size), state(size, wvfrm::BandEnergies { 0.5f, 0.5f, 0.5f }), out(size);
+    std::vector<float> amplitudes(size);
+    std::vector<uint8_t> active(size, 1), initialised(size, 1);
+    wvfrm::BandPlanes planes, statePlanes;
+    planes.assign(size);
+    statePlanes.assign(size, 0.5f);
+
+    for (size_t x = 0; x < size; ++x)
+    {
+        energies[x] = { static_cast<float>((x * 37) % 101) / 100.0f,
+                        static_cast<float>((x * 53) % 97) / 96.0f,
+                        static_cast<float>((x * 71) % 89) / 88.0f };
+        planes.set(x, energies[x]);
+        amplitudes[x] = static_cast<float>((x * 29) % 83) / 82.0f;
+    }
+
+    constexpr auto colorMatch = 0.6f;
+    constexpr auto dt = 1.0 / 60.0;
+    constexpr auto attackMs = 18.0;
+    constexpr auto releaseMs = 140.0;
+
+    const auto perColumn = wvfrm::bench::measurePerSample(width, 16, [&]
+    {
+        const auto mix = juce::jmap(colorMatch, 0.0f, 1.0f, 0.2f, 1.0f);
+        const float weights[5] = { 1.0f, 2.0f, 3.0f, 2.0f, 1.0f };
+
+        for (int x = 0; x < width; ++x)
+        {
+            const auto& self = energies[static_cast<size_t>(x)];
+            float weightSum = 0.0f, low = 0.0f, mid = 0.0f, high = 0.0f;
+
+            for (int i = 0; i < 5; ++i)
+            {
+                const auto nx = static_cast<size_t>((x + i - 2 + width) % width);
+                if (active[nx] == 0)
+                    continue;
+
+                weightSum += weights[i];
+                low += energies[nx].low * weights[i];
+                mid += energies[nx].mid * weights[i];
+                high += energies[nx].high * weights[i];
+            }
+
+            const wvfrm::BandEnergies blurred { juce::jmap(mix, self.low, low / weightSum),
+                                                juce::jmap(mix, self.mid, mid / weightSum),
+                                                juce::jmap(mix, self.high, high / weightSum) };
+
+            auto smooth = [&](float& previous, float value)
+            {
+                const auto ms = value > previous ? attackMs : releaseMs;
+                const auto alpha = static_cast<float>(std::exp(-dt * 1000.0 / ms));
+                previous = alpha * previous + (1.0f - alpha) * value;
+                return previous;
+            };
+
+            auto& s = state[static_cast<size_t>(x)];
+            out[static_cast<size_t>(x)] = { smooth(s.low, blurred.low), smooth(s.mid, blurred.mid), smooth(s.high, blurred.high) };
+        }
+    });
+
+    std::vector<float> low(size), mid(size), high(size);
+    const auto passes = wvfrm::bench::measurePerSample(width, 16, [&]
+    {
+        const auto attack = static_cast<float>(std::exp(-dt * 1000.0 / attackMs));
+        const auto release = static_cast<float>(std::exp(-dt * 1000.0 / releaseMs));
+        const wvfrm::BandSpans spans { low.data(), mid.data(), high.data() };
+
+        wvfrm::blurBandColumns(planes, active.data(), amplitudes.data(), colorMatch, true, 0, width, spans);
+        wvfrm::smoothBandColumns(statePlanes, initialised.data(), active.data(), 0, width, attack, release, false, spans);
+    });
+
+    std::printf("passes   width %5d : per-column %7.1f  passes %7.1f cycles/column  %5.2fx\n",
+                width,
+                perColumn.cyclesPerSample,
+                passes.cyclesPerSample,
+                perColumn.cyclesPerSample / passes.cyclesPerSample);
+}
+} // namespace
+
+void runColourBenchmarks()
+{
+    benchmarkColours(3840);
+    benchmarkColourPasses(3840);
+}
@@ -0,0 +1,145 @@
+#include "BenchmarkClock.h"
+
+#include "ui/ColumnRasterizer.h"
+#include "ui/WorkStealingPool.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+std::vector<wvfrm::ColumnRasterizer::Column> makeColumns(int width, int height)
+{
+    std::vector<wvfrm::ColumnRasterizer::Column> columns(static_cast<size_t>(width));
+    for (int x = 0; x < width; ++x)
+    {
+        const auto amplitude = 0.1f + 0.8f * static_cast<float>((x * 37) % 101) / 100.0f;
+        const auto half = 0.5f * static_cast<float>(height);
+        columns[static_cast<size_t>(x)] = { 0xff000000u | static_cast<juce::uint32>((x * 2654435761u) & 0x00ffffffu),
+                                            half - amplitude * half * 0.92f,
+                                            half + amplitude * half * 0.8f };
+    }
+
+    return columns;
+}
+
+wvfrm::ColumnRasterizer::Style threeBandStyle()
+{
+    wvfrm::ColumnRasterizer::Style style;
+    style.coreThickness = 1.15f;
+    style.glowThickness = 3.75f;
+    style.glowAlpha = 0.42f;
+    return style;
+}
+
+// One full redraw of a track `width` columns wide in three-band style (glow plus core), through
+// each backend into the same software image.
+void benchmarkTrack(int width, int height, float scale)
+{
+    const auto columns = makeColumns(width, height);
+
+    juce::Image image(juce::Image::ARGB,
+                      juce::roundToInt(static_cast<float>(width) * scale),
+                      juce::roundToInt(static_cast<float>(height) * scale),
+                      true,
+                      juce::SoftwareImageType());
+
+    wvfrm::ColumnRasterizer::Strip strip;
+    strip.pixelEnd = image.getWidth();
+    strip.centreY = height / 2;
+    strip.background = juce::Colour::fromRGB(4, 4, 6);
+    strip.centreLine = juce::Colour::fromRGB(24, 24, 26);
+
+    const auto style = threeBandStyle();
+
+    wvfrm::ColumnRasterizer rasterizer;
+    auto measure = [&](wvfrm::RasterBackend backend)
+    {
+        rasterizer.setBackend(backend);
+        return wvfrm::bench::measurePerSample(width, 8, [&]
+        {
+            rasterizer.paintStrip(image, scale, strip, columns.data(), 0, width, style);
+        });
+    };
+
+    const auto graphics = measure(wvfrm::RasterBackend::graphics);
+    const auto direct = measure(wvfrm::RasterBackend::direct);
+
+    std::printf("raster   width %5d x%.1f : graphics %8.1f  direct %8.1f cycles/column  %5.2fx  (%6.3f ms/frame direct)\n",
+                width,
+                static_cast<double>(scale),
+                graphics.cyclesPerSample,
+                direct.cyclesPerSample,
+                graphics.cyclesPerSample / direct.cyclesPerSample,
+                direct.nanosPerSample * static_cast<double>(width) * 1.0e-6);
+}
+
+// A full redraw of an L/R split frame, direct backend: the tracks one after the other on this
+// thread, then cut into 128-column tiles shared out across a work-stealing pool.
+void benchmarkTiles(int width, int height, int numTracks, int numWorkers)
+{
+    constexpr auto tileColumns = 128;
+    const auto columns = makeColumns(width, height);
+    const auto style = threeBandStyle();
+    wvfrm::ColumnRasterizer rasterizer;
+
+    std::vector<juce::Image> images;
+    for (int track = 0; track < numTracks; ++track)
+        images.emplace_back(juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+
+    auto paintColumns = [&](int track, int firstColumn, int endColumn)
+    {
+        wvfrm::ColumnRasterizer::Strip strip;
+        strip.pixelStart = firstColumn;
+        strip.pixelEnd = endColumn;
+        strip.centreY = height / 2;
+        strip.background = juce::Colour::fromRGB(4, 4, 6);
+        strip.centreLine = juce::Colour::fromRGB(24, 24, 26);
+        rasterizer.paintStrip(images[static_cast<size_t>(track)],
+                              1.0f,
+                              strip,
+                              columns.data(),
+                              juce::jmax(0, firstColumn - 4),
+                              juce::jmin(width, endColumn + 4),
+                              style);
+    };
+
+    const auto serial = wvfrm::bench::measurePerSample(static_cast<int64_t>(width) * numTracks, 8, [&]
+    {
+        for (int track = 0; track < numTracks; ++track)
+            paintColumns(track, 0, width);
+    });
+
+    wvfrm::WorkStealingPool pool(numWorkers);
+    const auto tilesPerTrack = (width + tileColumns - 1) / tileColumns;
+    auto paintTile = [&](int tile, int)
+    {
+        const auto firstColumn = (tile % tilesPerTrack) * tileColumns;
+        paintColumns(tile / tilesPerTrack, firstColumn, juce::jmin(width, firstColumn + tileColumns));
+    };
+
+    const auto tiled = wvfrm::bench::measurePerSample(static_cast<int64_t>(width) * numTracks, 8, [&]
+    {
+        pool.run(tilesPerTrack * numTracks, paintTile);
+    });
+
+    std::printf("tiles    width %5d x%d tracks, %d lanes : serial %7.3f  tiled %7.3f ms/frame  %5.2fx\n",
+                width,
+                numTracks,
+                pool.getNumLanes(),
+                serial.nanosPerSample * static_cast<double>(width * numTracks) * 1.0e-6,
+                tiled.nanosPerSample * static_cast<double>(width * numTracks) * 1.0e-6,
+                serial.nanosPerSample / tiled.nanosPerSample);
+}
+} // namespace
+
+void runRasterBenchmarks()
+{
+    benchmarkTrack(1920, 240, 1.0f);
+    benchmarkTrack(3840, 240, 1.0f);
+    benchmarkTrack(1920, 240, 2.0f);
+
+    const auto workers = wvfrm::WorkStealingPool::suggestedWorkerCount();
+    benchmarkTiles(3840, 600, 2, workers);
+    benchmarkTiles(5120, 800, 2, workers);
+}
@@ -0,0 +1,85 @@
+#include "BenchmarkClock.h"
+
+#include "dsp/AnalysisRingBuffer.h"
+
+#include <cstdio>
+
+namespace
+{
+constexpr auto benchSampleRate = 48000;
+constexpr auto ringCapacity = benchSampleRate * 9;
+
+const char* formatName(wvfrm::SampleFormat format)
+{
+    switch (format)
+    {
+        case wvfrm::SampleFormat::float16: return "f16";
+        case wvfrm::SampleFormat::int16: return "i16";
+        case wvfrm::SampleFormat::float32:
+        default: return "f32";
+    }
+}
+
+void benchmarkPush(wvfrm::SampleFormat format, int blockSize)
+{
+    wvfrm::AnalysisRingBuffer ring;
+    ring.prepare(2, ringCapacity, format);
+
+    juce::AudioBuffer<float> block(2, blockSize);
+    for (int channel = 0; channel < 2; ++channel)
+        for (int s = 0; s < blockSize; ++s)
+            block.setSample(channel, s, 0.001f * static_cast<float>(s % 997) - 0.5f);
+
+    // Roughly ten seconds of audio per run regardless of block size.
+    const auto blocksPerRun = juce::jmax(1, (benchSampleRate * 10) / blockSize);
+
+    const auto result = wvfrm::bench::measurePerSample(static_cast<int64_t>(blocksPerRun) * blockSize, 8, [&]
+    {
+        for (int b = 0; b < blocksPerRun; ++b)
+            ring.pushBuffer(block);
+    });
+
+    std::printf("pushBuffer         %s block  %7d : %7.2f cycles/sample  %7.3f ns/sample\n",
+                formatName(format),
+                blockSize,
+                result.cyclesPerSample,
+                result.nanosPerSample);
+}
+
+void benchmarkCopy(wvfrm::SampleFormat format, int windowSamples)
+{
+    wvfrm::AnalysisRingBuffer ring;
+    ring.prepare(2, ringCapacity, format);
+
+    juce::AudioBuffer<float> block(2, 4096);
+    block.clear();
+    for (int i = 0; i < (ringCapacity / 4096) + 8; ++i)
+        ring.pushBuffer(block);
+
+    juce::AudioBuffer<float> destination;
+    const auto end = ring.getTotalWrittenSamples();
+
+    const auto result = wvfrm::bench::measurePerSample(windowSamples, 64, [&]
+    {
+        ring.copyWindowEndingAt(destination, windowSamples, end);
+    });
+
+    std::printf("copyWindowEndingAt %s window %7d : %7.2f cycles/sample  %7.3f ns/sample\n",
+                formatName(format),
+                windowSamples,
+                result.cyclesPerSample,
+                result.nanosPerSample);
+}
+}
+
+void runRingBufferBenchmarks()
+{
+    for (const auto format : { wvfrm::SampleFormat::float32, wvfrm::SampleFormat::float16, wvfrm::SampleFormat::int16 })
+    {
+        for (const auto blockSize : { 32, 64, 512, 4096 })
+            benchmarkPush(format, blockSize);
+
+        for (const auto window : { 480, 48000, 240000 })
+            benchmarkCopy(format, window);
+    }
+}
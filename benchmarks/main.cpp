@@ -0,0 +1,20 @@
+#include <cstdlib>
+#include <iostream>
+
+void runRingBufferBenchmarks();
+void runCaptureBenchmarks();
+void runBandAnalyzerBenchmarks();
+void runRasterBenchmarks();
+void runColourBenchmarks();
+
+int main()
+{
+    runRingBufferBenchmarks();
+    runCaptureBenchmarks();
+    runBandAnalyzerBenchmarks();
+    runRasterBenchmarks();
+    runColourBenchmarks();
+
+    std::cout << "Benchmarks finished." << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -18,6 +18,10 @@ constexpr auto defaultSmoothing = 35.0f;
 constexpr auto defaultUiScale = 100.0f;
 constexpr auto defaultWaveLoop = true;
 constexpr auto defaultColorMatch = 100.0f;
+constexpr auto defaultAnalysisPrecision = 0;
+constexpr auto defaultAnalysisRate = 0;
+constexpr auto defaultBandAnalysis = 0;
+constexpr auto defaultRasterBackend = 0;
 }
 
 juce::StringArray getTimeModeChoices()
@@ -45,6 +49,26 @@ juce::StringArray getThemePresetChoices()
     return { "minimeters_3band", "rekordbox_inspired", "classic_amber", "ice_blue" };
 }
 
+juce::StringArray getAnalysisPrecisionChoices()
+{
+    return { "float32", "float16", "int16" };
+}
+
+juce::StringArray getAnalysisRateChoices()
+{
+    return { "full", "reduced" };
+}
+
+juce::StringArray getBandAnalysisChoices()
+{
+    return { "filters", "spectral" };
+}
+
+juce::StringArray getRasterBackendChoices()
+{
+    return { "direct", "graphics" };
+}
+
 juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout()
 {
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
@@ -120,23 +144,65 @@ juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout()
         juce::NormalisableRange<float>(0.0f, 100.0f, 0.01f),
         defaultColorMatch));
 
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        ParamIDs::analysisPrecision,
+        "Analysis Precision",
+        getAnalysisPrecisionChoices(),
+        defaultAnalysisPrecision));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        ParamIDs::analysisRate,
+        "Analysis Rate",
+        getAnalysisRateChoices(),
+        defaultAnalysisRate));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        ParamIDs::bandAnalysis,
+        "Band Analysis",
+        getBandAnalysisChoices(),
+        defaultBandAnalysis));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        ParamIDs::rasterBackend,
+        "Raster Backend",
+        getRasterBackendChoices(),
+        defaultRasterBackend));
+
     return { params.begin(), params.end() };
 }
 
 int getChoiceIndex(const juce::AudioProcessorValueTreeState& state, const juce::String& paramId)
 {
-    if (const auto* value = state.getRawParameterValue(paramId))
+    return getChoiceIndex(state.getRawParameterValue(paramId));
+}
+
+float getFloatValue(const juce::AudioProcessorValueTreeState& state, const juce::String& paramId, float fallback) noexcept
+{
+    return getFloatValue(state.getRawParameterValue(paramId), fallback);
+}
+
+int getChoiceIndex(const std::atomic<float>* value) noexcept
+{
+    if (value != nullptr)
         return juce::jmax(0, static_cast<int>(std::lround(value->load())));
 
     return 0;
 }
 
-float getFloatValue(const juce::AudioProcessorValueTreeState& state, const juce::String& paramId, float fallback) noexcept
+float getFloatValue(const std::atomic<float>* value, float fallback) noexcept
 {
-    if (const auto* value = state.getRawParameterValue(paramId))
+    if (value != nullptr)
         return value->load();
 
     return fallback;
 }
 
+bool getBoolValue(const std::atomic<float>* value, bool fallback) noexcept
+{
+    if (value != nullptr)
+        return value->load() >= 0.5f;
+
+    return fallback;
+}
+
 } // namespace wvfrm
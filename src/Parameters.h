@@ -2,6 +2,8 @@
 
 #include "JuceIncludes.h"
 
+#include <atomic>
+
 namespace wvfrm
 {
 namespace ParamIDs
@@ -18,6 +20,10 @@ static constexpr auto smoothing = "smoothing";
 static constexpr auto uiScale = "ui_scale";
 static constexpr auto waveLoop = "wave_loop";
 static constexpr auto colorMatch = "color_match";
+static constexpr auto analysisPrecision = "analysis_precision";
+static constexpr auto analysisRate = "analysis_rate";
+static constexpr auto bandAnalysis = "band_analysis";
+static constexpr auto rasterBackend = "raster_backend";
 }
 
 enum class TimeMode
@@ -50,6 +56,31 @@ enum class ThemePreset
     iceBlue
 };
 
+enum class AnalysisPrecision
+{
+    float32 = 0,
+    float16,
+    int16
+};
+
+enum class AnalysisRate
+{
+    full = 0,
+    reduced
+};
+
+enum class BandAnalysis
+{
+    filters = 0,
+    spectral
+};
+
+enum class RasterBackend
+{
+    direct = 0,
+    graphics
+};
+
 juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
 juce::StringArray getTimeModeChoices();
@@ -57,8 +88,18 @@ juce::StringArray getTimeDivisionChoices();
 juce::StringArray getChannelViewChoices();
 juce::StringArray getColorModeChoices();
 juce::StringArray getThemePresetChoices();
+juce::StringArray getAnalysisPrecisionChoices();
+juce::StringArray getAnalysisRateChoices();
+juce::StringArray getBandAnalysisChoices();
+juce::StringArray getRasterBackendChoices();
 
 int getChoiceIndex(const juce::AudioProcessorValueTreeState& state, const juce::String& paramId);
 float getFloatValue(const juce::AudioProcessorValueTreeState& state, const juce::String& paramId, float fallback) noexcept;
 
+// For values looked up once with getRawParameterValue(): reading them builds no ID string, so
+// they suit paths that must not allocate.
+int getChoiceIndex(const std::atomic<float>* value) noexcept;
+float getFloatValue(const std::atomic<float>* value, float fallback) noexcept;
+bool getBoolValue(const std::atomic<float>* value, bool fallback) noexcept;
+
 } // namespace wvfrm
@@ -270,10 +270,6 @@ void WaveformAudioProcessorEditor::updateTimeControls()
     timeMsLabel.setEnabled(! syncSelected);
 }
 
-void WaveformAudioProcessorEditor::timerCallback()
-{
-}
-
 bool WaveformAudioProcessorEditor::keyPressed(const juce::KeyPress& key)
 {
     if (key.getModifiers().isCtrlDown() && (key.getTextCharacter() == 'd' || key.getTextCharacter() == 'D'))
@@ -8,8 +8,7 @@
 namespace wvfrm
 {
 
-class WaveformAudioProcessorEditor : public juce::AudioProcessorEditor,
-                                     private juce::Timer
+class WaveformAudioProcessorEditor : public juce::AudioProcessorEditor
 {
 public:
     explicit WaveformAudioProcessorEditor(WaveformAudioProcessor&);
@@ -26,7 +25,6 @@ private:
     void configureCombo(juce::ComboBox& box, const juce::StringArray& choices);
     void configureKnob(juce::Slider& slider, const juce::String& suffix);
     void updateTimeControls();
-    void timerCallback() override;
 
     WaveformAudioProcessor& processor;
     juce::AudioProcessorValueTreeState& state;
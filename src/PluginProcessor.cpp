@@ -2,6 +2,7 @@
 #include "PluginEditor.h"
 
 #include <cmath>
+#include <limits>
 
 namespace wvfrm
 {
@@ -12,6 +13,9 @@ constexpr auto stateType = "wvfrm_state";
 constexpr auto editorWidthProperty = "editor_width";
 constexpr auto editorHeightProperty = "editor_height";
 
+// How often the message thread looks for ring work the other threads flagged.
+constexpr int ringWorkPollMs = 30;
+
 double getDivisionBeats(int divisionIndex) noexcept
 {
     const auto clamped = juce::jlimit(0, static_cast<int>(TimeWindowResolver::divisions.size()) - 1, divisionIndex);
@@ -19,6 +23,40 @@ double getDivisionBeats(int divisionIndex) noexcept
     return 4.0 * static_cast<double>(division.numerator) / static_cast<double>(division.denominator);
 }
 
+SampleFormat toSampleFormat(AnalysisPrecision precision) noexcept
+{
+    switch (precision)
+    {
+        case AnalysisPrecision::float16: return SampleFormat::float16;
+        case AnalysisPrecision::int16: return SampleFormat::int16;
+        case AnalysisPrecision::float32:
+        default: return SampleFormat::float32;
+    }
+}
+
+// Parameters that change how much history, or in what form, the analysis ring has to hold.
+constexpr const char* ringLayoutParameters[] {
+    ParamIDs::timeMode,
+    ParamIDs::timeSyncDivision,
+    ParamIDs::timeMs,
+    ParamIDs::analysisPrecision,
+    ParamIDs::analysisRate
+};
+
+// Parameters that only change what the view draws; they need no work on the processor's side.
+constexpr const char* viewParameters[] {
+    ParamIDs::channelView,
+    ParamIDs::colorMode,
+    ParamIDs::themePreset,
+    ParamIDs::themeIntensity,
+    ParamIDs::waveGainVisual,
+    ParamIDs::smoothing,
+    ParamIDs::uiScale,
+    ParamIDs::waveLoop,
+    ParamIDs::colorMatch,
+    ParamIDs::rasterBackend
+};
+
 double positiveFraction(double value) noexcept
 {
     const auto floored = std::floor(value);
@@ -31,42 +69,131 @@ WaveformAudioProcessor::WaveformAudioProcessor()
     : AudioProcessor(BusesProperties()
                          .withInput("Input", juce::AudioChannelSet::stereo(), true)
                          .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
-      parameters(*this, nullptr, stateType, createParameterLayout())
+      parameters(*this, nullptr, stateType, createParameterLayout()),
+      timeModeValue(parameters.getRawParameterValue(ParamIDs::timeMode)),
+      timeSyncDivisionValue(parameters.getRawParameterValue(ParamIDs::timeSyncDivision)),
+      timeMsValue(parameters.getRawParameterValue(ParamIDs::timeMs))
+{
+    for (const auto* id : ringLayoutParameters)
+        parameters.addParameterListener(id, this);
+
+    for (const auto* id : viewParameters)
+        parameters.addParameterListener(id, this);
+
+    parameters.addParameterListener(ParamIDs::bandAnalysis, this);
+    startTimer(ringWorkPollMs);
+}
+
+WaveformAudioProcessor::~WaveformAudioProcessor()
 {
+    for (const auto* id : ringLayoutParameters)
+        parameters.removeParameterListener(id, this);
+
+    for (const auto* id : viewParameters)
+        parameters.removeParameterListener(id, this);
+
+    parameters.removeParameterListener(ParamIDs::bandAnalysis, this);
+    stopTimer();
 }
 
-void WaveformAudioProcessor::prepareToPlay(double sampleRate, int)
+void WaveformAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     currentSampleRate.store(sampleRate);
-    processedSamples.store(0);
     syncClockState = {};
+    viewActivity = {};
+    viewSettledAt.store(-1);
 
+    // The sample clock keeps running across re-prepares so the history already captured stays
+    // addressable; the ring host resamples it if the rate moved.
+    const auto resumeSample = analysisRing.reader().getTotalWrittenSamples();
     renderClockSeq.store(0);
-    lastClockPhaseSample.store(0);
+    lastClockPhaseSample.store(resumeSample);
     lastClockPhase.store(0.0f);
     lastClockReliable.store(false);
     lastClockBpm.store(juce::jmax(1.0, lastKnownBpm.load()));
     lastClockResetSuggested.store(false);
     lastClockIsPlaying.store(false);
 
-    const auto capacity = juce::jlimit(65536, 2 * 1024 * 1024, static_cast<int>(std::ceil(sampleRate * 9.0)));
-    analysisBuffer.prepare(2, capacity);
+    analysisDecimator.prepare(juce::jlimit(1, maxCaptureChannels, getTotalNumInputChannels()),
+                              juce::jmax(512, samplesPerBlock));
+
+    // The replacement is left to the timer rather than built here, so prepareToPlay never waits
+    // on a renderer pinning the old ring. Until it is adopted the audio thread keeps writing the
+    // old ring, which takes any channel count; what it records there is already at the new
+    // rate, so only history from before resumeSample gets resampled.
+    analysisRing.noteSampleRateChange(desiredRingLayout().sampleRate, resumeSample);
+    ringWorkPending.store(true, std::memory_order_release);
+
+    blockSummarizer.prepare(BlockSummarizer::defaultSamplesPerSummary);
 }
 
 void WaveformAudioProcessor::releaseResources()
 {
-    analysisBuffer.clear();
+    // The ring is kept: its history is still worth showing when playback resumes.
+}
+
+AnalysisRingHost::Layout WaveformAudioProcessor::desiredRingLayout() const noexcept
+{
+    const auto sampleRate = juce::jmax(1.0, currentSampleRate.load());
+    const auto windowSamples = resolveCurrentWindow().ms * 0.001 * sampleRate;
+    const auto precision = static_cast<AnalysisPrecision>(getChoiceIndex(parameters, ParamIDs::analysisPrecision));
+
+    const auto rate = static_cast<AnalysisRate>(getChoiceIndex(parameters, ParamIDs::analysisRate));
+
+    AnalysisRingHost::Layout layout;
+    layout.decimationStages = rate == AnalysisRate::reduced ? HalfBandDecimator::stagesForRate(sampleRate) : 0;
+    layout.sampleRate = sampleRate / static_cast<double>(1 << layout.decimationStages);
+    layout.channels = juce::jlimit(1, maxCaptureChannels, getTotalNumInputChannels());
+    layout.capacity = analysisRing.chooseCapacity(AnalysisRingHost::capacityForWindow(windowSamples / (1 << layout.decimationStages)));
+    layout.format = toSampleFormat(precision);
+    return layout;
+}
+
+void WaveformAudioProcessor::timerCallback()
+{
+    if (! ringWorkPending.exchange(false, std::memory_order_acquire))
+        return;
+
+    // Whatever cannot be done yet is left for a later tick rather than retried straight away.
+    if (! analysisRing.releaseRetired())
+        ringWorkPending.store(true, std::memory_order_relaxed); // the view's renderer is still reading the old ring
+
+    spectralBands.setEnabled(static_cast<BandAnalysis>(getChoiceIndex(parameters, ParamIDs::bandAnalysis)) == BandAnalysis::spectral);
+
+    const auto layout = desiredRingLayout();
+    const auto target = analysisRing.getTargetLayout();
+
+    if (layout == target)
+        return;
+
+    // Switching the analysis rate is a rate change as far as the stored history is concerned.
+    if (! juce::approximatelyEqual(layout.sampleRate, target.sampleRate))
+        analysisRing.noteSampleRateChange(layout.sampleRate, analysisRing.reader().getTotalWrittenSamples());
+
+    if (! analysisRing.rebuild(layout))
+        ringWorkPending.store(true, std::memory_order_relaxed); // the previous swap is still being adopted
+}
+
+void WaveformAudioProcessor::parameterChanged(const juce::String& parameterID, float)
+{
+    parameterGeneration.fetch_add(1, std::memory_order_release);
+
+    for (const auto* id : viewParameters)
+        if (parameterID == id)
+            return;
+
+    ringWorkPending.store(true, std::memory_order_release);
 }
 
 bool WaveformAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-    if (layouts.getMainInputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
+    const auto input = layouts.getMainInputChannelSet();
 
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    if (input.isDisabled() || input.size() > maxCaptureChannels)
         return false;
 
-    return true;
+    // Pass-through insert: whatever comes in goes out unchanged.
+    return layouts.getMainOutputChannelSet() == input;
 }
 
 void WaveformAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
@@ -139,16 +266,25 @@ void WaveformAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce
 
     const auto blockSamples = buffer.getNumSamples();
     const auto blockStartSample = processedSamples.fetch_add(blockSamples);
-    analysisBuffer.pushBuffer(buffer);
 
-    const auto mode = getChoiceIndex(parameters, ParamIDs::timeMode);
-    const auto division = getChoiceIndex(parameters, ParamIDs::timeSyncDivision);
+    auto adoptedRing = false;
+    auto& ring = analysisRing.beginBlock(adoptedRing);
+    if (adoptedRing)
+        ringWorkPending.store(true, std::memory_order_release); // frees the ring we just left
+
+    // Ring positions count analysis-rate samples, which is what readers anchor windows to.
+    const auto analysisBlockStart = ring.getTotalWrittenSamples();
+
+    const auto mode = getChoiceIndex(timeModeValue);
+    const auto division = getChoiceIndex(timeSyncDivisionValue);
 
     float phaseNormalized = 0.0f;
     auto phaseReliable = false;
     auto resetSuggested = false;
     auto bpmUsed = juce::jmax(1.0, lastKnownBpm.load());
-    auto phaseSample = blockStartSample;
+    auto phaseSample = analysisBlockStart;
+    auto phasePerSample = 0.0;
+    auto windowSamples = 0.0;
 
     if (mode == static_cast<int>(TimeMode::sync))
     {
@@ -174,6 +310,8 @@ void WaveformAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce
         phaseReliable = output.phaseReliable;
         resetSuggested = output.resetSuggested;
         bpmUsed = bpmForClock;
+        phasePerSample = bpmForClock / (60.0 * juce::jmax(1.0, currentSampleRate.load()) * beatsInLoop);
+        windowSamples = beatsInLoop * 60.0 / bpmForClock * currentSampleRate.load();
     }
     else
     {
@@ -184,9 +322,41 @@ void WaveformAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce
         phaseReliable = true;
         resetSuggested = false;
         bpmUsed = resolved.bpmUsed;
+        phasePerSample = 1.0 / intervalSamples;
+        windowSamples = intervalSamples;
         syncClockState = {};
     }
 
+    // Host tempo can stretch a synced window without any parameter changing.
+    const auto decimationFactor = 1 << analysisRing.getActiveDecimationStages();
+    if (analysisRing.needsResize(AnalysisRingHost::capacityForWindow(windowSamples / decimationFactor)))
+        ringWorkPending.store(true, std::memory_order_release);
+
+    const auto dropped = captureAnalysis(ring, buffer, phaseNormalized, phasePerSample);
+    if (dropped > 0)
+        droppedBlockSummaries.fetch_add(static_cast<uint64_t>(dropped), std::memory_order_relaxed);
+
+    // Only a stopped host can idle the view, so playing blocks skip the scan.
+    ViewActivityInput activity { hostIsPlaying,
+                                 0.0f,
+                                 0.0f,
+                                 ring.getTotalWrittenSamples(),
+                                 windowSamples / decimationFactor };
+    if (! hostIsPlaying)
+    {
+        activity.minimum = std::numeric_limits<float>::max();
+        activity.maximum = -std::numeric_limits<float>::max();
+
+        for (int channel = 0; channel < juce::jmin(totalInputChannels, buffer.getNumChannels()); ++channel)
+        {
+            const auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(channel), blockSamples);
+            activity.minimum = juce::jmin(activity.minimum, range.getStart());
+            activity.maximum = juce::jmax(activity.maximum, range.getEnd());
+        }
+    }
+
+    viewSettledAt.store(updateViewActivity(activity, viewActivity), std::memory_order_release);
+
     renderClockSeq.fetch_add(1, std::memory_order_acq_rel); // begin write (odd)
     lastClockPhaseSample.store(phaseSample, std::memory_order_relaxed);
     lastClockPhase.store(juce::jlimit(0.0f, 1.0f, phaseNormalized), std::memory_order_relaxed);
@@ -197,6 +367,81 @@ void WaveformAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce
     renderClockSeq.fetch_add(1, std::memory_order_release); // end write (even)
 }
 
+int WaveformAudioProcessor::captureAnalysis(AnalysisRingBuffer& ring,
+                                            const juce::AudioBuffer<float>& buffer,
+                                            double phaseAtBlockStart,
+                                            double phasePerSample) noexcept
+{
+    analysisDecimator.setNumStages(analysisRing.getActiveDecimationStages());
+
+    // The summarizer restarts its record by itself when the blocks it sees stop being contiguous.
+    const auto publishSummaries = summaryConsumerAttached.load(std::memory_order_acquire);
+
+    if (analysisDecimator.getNumStages() == 0)
+    {
+        const auto blockStart = ring.getTotalWrittenSamples();
+        ring.pushBuffer(buffer);
+
+        if (spectralBands.isEnabled())
+            spectralBands.push(buffer.getArrayOfReadPointers(),
+                               buffer.getNumChannels(),
+                               buffer.getNumSamples(),
+                               blockStart,
+                               analysisRing.getActiveSampleRate());
+
+        return publishSummaries
+            ? blockSummarizer.process(buffer, blockStart, phaseAtBlockStart, phasePerSample, blockSummaryQueue)
+            : 0;
+    }
+
+    // Reduced rate: the ring and the summaries get the half-band output, and their peaks, mid and
+    // side included, come from envelopes of the full-rate input so nothing the decimation smooths
+    // away goes missing.
+    const auto channels = juce::jmin(buffer.getNumChannels(), maxCaptureChannels);
+    const auto factor = analysisDecimator.getFactor();
+    const float* input[maxCaptureChannels] {};
+    auto dropped = 0;
+
+    for (int offset = 0; offset < buffer.getNumSamples();)
+    {
+        const auto count = juce::jmin(buffer.getNumSamples() - offset, analysisDecimator.getMaximumBlockSize());
+
+        for (int channel = 0; channel < channels; ++channel)
+            input[channel] = buffer.getReadPointer(channel, offset);
+
+        const auto produced = analysisDecimator.process(input, channels, count);
+        const auto start = ring.getTotalWrittenSamples();
+
+        ring.pushSamples(analysisDecimator.getOutput(),
+                         analysisDecimator.getEnvelopeMinimum(),
+                         analysisDecimator.getEnvelopeMaximum(),
+                         channels,
+                         produced);
+
+        if (spectralBands.isEnabled())
+            spectralBands.push(analysisDecimator.getOutput(), channels, produced, start, analysisRing.getActiveSampleRate());
+
+        if (produced > 0 && publishSummaries)
+        {
+            dropped += blockSummarizer.process(analysisDecimator.getOutput(),
+                                               channels,
+                                               produced,
+                                               start,
+                                               phaseAtBlockStart + phasePerSample * static_cast<double>(offset),
+                                               phasePerSample * static_cast<double>(factor),
+                                               blockSummaryQueue,
+                                               analysisDecimator.getEnvelopeMinimum(),
+                                               analysisDecimator.getEnvelopeMaximum(),
+                                               analysisDecimator.getDerivedEnvelopeMinimum(),
+                                               analysisDecimator.getDerivedEnvelopeMaximum());
+        }
+
+        offset += count;
+    }
+
+    return dropped;
+}
+
 juce::AudioProcessorEditor* WaveformAudioProcessor::createEditor()
 {
     return new WaveformAudioProcessorEditor(*this);
@@ -308,9 +553,9 @@ const juce::AudioProcessorValueTreeState& WaveformAudioProcessor::getValueTreeSt
 
 TimeWindowResolver::ResolvedWindow WaveformAudioProcessor::resolveCurrentWindow() const noexcept
 {
-    const auto mode = getChoiceIndex(parameters, ParamIDs::timeMode);
-    const auto division = getChoiceIndex(parameters, ParamIDs::timeSyncDivision);
-    const auto timeMs = static_cast<double>(getFloatValue(parameters, ParamIDs::timeMs, 1000.0f));
+    const auto mode = getChoiceIndex(timeModeValue);
+    const auto division = getChoiceIndex(timeSyncDivisionValue);
+    const auto timeMs = static_cast<double>(getFloatValue(timeMsValue, 1000.0f));
 
     const auto bpmFromHost = tempoReliable.load() ? std::optional<double> { hostTempoBpm.load() } : std::nullopt;
 
@@ -323,7 +568,7 @@ TimeWindowResolver::ResolvedWindow WaveformAudioProcessor::resolveCurrentWindow(
 
 bool WaveformAudioProcessor::copyRecentSamples(juce::AudioBuffer<float>& destination, int numSamples) const
 {
-    return analysisBuffer.copyMostRecent(destination, numSamples);
+    return analysisRing.reader().copyMostRecent(destination, numSamples);
 }
 
 double WaveformAudioProcessor::getLoopPhaseNormalized() const noexcept
@@ -331,11 +576,26 @@ double WaveformAudioProcessor::getLoopPhaseNormalized() const noexcept
     return juce::jlimit(0.0, 1.0, static_cast<double>(lastClockPhase.load()));
 }
 
+const std::atomic<float>* WaveformAudioProcessor::getViewParameter(const char* parameterID) const noexcept
+{
+    return parameters.getRawParameterValue(parameterID);
+}
+
+juce::AudioChannelSet WaveformAudioProcessor::getCaptureLayout() const
+{
+    return getChannelLayoutOfBus(true, 0);
+}
+
 bool WaveformAudioProcessor::getLoopRenderFrame(LoopRenderFrame& out, int requestedSamples) const
 {
     return buildLoopRenderFrame(out, requestedSamples);
 }
 
+AnalysisRingHost::ReadScope WaveformAudioProcessor::pinAnalysis() const noexcept
+{
+    return AnalysisRingHost::ReadScope(analysisRing);
+}
+
 bool WaveformAudioProcessor::buildLoopRenderFrame(LoopRenderFrame& out, int requestedSamples) const
 {
     int64_t phaseSample = 0;
@@ -370,7 +630,7 @@ bool WaveformAudioProcessor::buildLoopRenderFrame(LoopRenderFrame& out, int requ
     if (! snapshotReadOk)
         return false;
 
-    if (! analysisBuffer.copyWindowEndingAt(out.samples, requestedSamples, phaseSample))
+    if (! analysisRing.reader().readWindowEndingAt(out.spans, requestedSamples, phaseSample))
         return false;
 
     out.phaseNormalized = juce::jlimit(0.0f, 1.0f, phase);
@@ -382,14 +642,115 @@ bool WaveformAudioProcessor::buildLoopRenderFrame(LoopRenderFrame& out, int requ
     return true;
 }
 
+bool WaveformAudioProcessor::isAnalysisReadCurrent(const AnalysisRingBuffer::ReadSpans& spans) const noexcept
+{
+    return analysisRing.reader().isReadStillValid(spans);
+}
+
+bool WaveformAudioProcessor::copyAnalysisWindow(juce::AudioBuffer<float>& destination,
+                                                int numSamples,
+                                                int64_t endSample,
+                                                int64_t& firstSample) const
+{
+    return analysisRing.reader().copyWindowEndingAt(destination, numSamples, endSample, &firstSample);
+}
+
+bool WaveformAudioProcessor::getPeakRange(int channel,
+                                          int64_t startSample,
+                                          int64_t endSample,
+                                          float& minimum,
+                                          float& maximum) const noexcept
+{
+    const auto& ring = analysisRing.reader();
+
+    if (analysisRing.getActiveDecimationStages() > 0)
+    {
+        // Edges would be scanned from the smoothed samples; widen them to whole envelope blocks
+        // instead, the same way the summary history rounds out to whole records.
+        constexpr auto blockMask = (static_cast<int64_t>(1) << PeakPyramid::baseLevelShift) - 1;
+        startSample &= ~blockMask;
+        endSample = juce::jmin(ring.getTotalWrittenSamples(), (endSample + blockMask) & ~blockMask);
+    }
+
+    return ring.getPeakRange(channel, startSample, endSample, minimum, maximum);
+}
+
+bool WaveformAudioProcessor::getBandEnergies(BandEnergyRing::Lane lane,
+                                             int channel,
+                                             int64_t startSample,
+                                             int64_t endSample,
+                                             BandEnergies& energies) const noexcept
+{
+    // The spectral engine is sharper when it is on and has the frames; the filter records are
+    // always there behind it.
+    if (spectralBands.isEnabled() && spectralBands.getBandEnergies(lane, channel, startSample, endSample, energies))
+        return true;
+
+    return analysisRing.reader().getBandEnergies(lane, channel, startSample, endSample, energies);
+}
+
 double WaveformAudioProcessor::getCurrentSampleRateHz() const noexcept
 {
     return currentSampleRate.load();
 }
 
+double WaveformAudioProcessor::getAnalysisSampleRateHz() const noexcept
+{
+    return analysisRing.getActiveSampleRate();
+}
+
 int WaveformAudioProcessor::getAnalysisCapacity() const noexcept
 {
-    return analysisBuffer.getCapacity();
+    return analysisRing.reader().getCapacity();
+}
+
+AnalysisRingBuffer::ReadStats WaveformAudioProcessor::getAnalysisReadStats() const noexcept
+{
+    return analysisRing.reader().getReadStats();
+}
+
+int WaveformAudioProcessor::drainBlockSummaries(BlockSummaryHistory& history) noexcept
+{
+    return history.drain(blockSummaryQueue);
+}
+
+void WaveformAudioProcessor::setSummaryConsumerAttached(bool attached) noexcept
+{
+    // No renderer is draining while this runs, so the message thread may stand in as consumer.
+    if (attached)
+    {
+        BlockSummary stale;
+        while (blockSummaryQueue.pop(stale))
+        {
+        }
+    }
+
+    summaryConsumerAttached.store(attached, std::memory_order_release);
+}
+
+uint64_t WaveformAudioProcessor::getDroppedBlockSummaries() const noexcept
+{
+    return droppedBlockSummaries.load(std::memory_order_relaxed);
+}
+
+WaveformAudioProcessor::ViewStamp WaveformAudioProcessor::getViewStamp() const noexcept
+{
+    ViewStamp stamp;
+
+    // Settled: the window holds nothing but the flat input, so neither the sample counter nor the
+    // clock can change the picture until a block differs again.
+    if (const auto settledAt = viewSettledAt.load(std::memory_order_acquire); settledAt >= 0)
+    {
+        stamp.writtenSamples = settledAt;
+    }
+    else
+    {
+        stamp.writtenSamples = analysisRing.reader().getTotalWrittenSamples();
+        stamp.clockSequence = renderClockSeq.load(std::memory_order_acquire);
+    }
+
+    stamp.parameterGeneration = parameterGeneration.load(std::memory_order_acquire);
+    return stamp;
 }
 
 void WaveformAudioProcessor::setLastEditorSize(int width, int height) noexcept
@@ -4,28 +4,41 @@
 
 #include "Parameters.h"
 #include "dsp/AnalysisRingBuffer.h"
+#include "dsp/AnalysisRingHost.h"
+#include "dsp/BlockSummary.h"
+#include "dsp/HalfBandDecimator.h"
 #include "dsp/LoopClock.h"
+#include "dsp/SpectralBandEngine.h"
 #include "dsp/TimeWindowResolver.h"
+#include "dsp/ViewActivity.h"
+#include "ui/RenderSource.h"
 
 namespace wvfrm
 {
 
-class WaveformAudioProcessor : public juce::AudioProcessor
+class WaveformAudioProcessor : public juce::AudioProcessor,
+                               public RenderSource,
+                               private juce::Timer,
+                               private juce::AudioProcessorValueTreeState::Listener
 {
 public:
-    struct LoopRenderFrame
+    // Everything outside the editor that can change what the view shows. Equal stamps mean
+    // no new audio, no clock movement and no parameter change in between. Blocks that arrive
+    // with the transport stopped and the input flat leave it alone once they fill the window.
+    struct ViewStamp
     {
-        juce::AudioBuffer<float> samples;
-        float phaseNormalized = 0.0f;
-        bool phaseReliable = false;
-        int64_t phaseSample = 0;
-        bool isPlaying = false;
-        double bpmUsed = 120.0;
-        bool resetSuggested = false;
+        int64_t writtenSamples = -1;
+        uint64_t clockSequence = 0;
+        uint32_t parameterGeneration = 0;
+
+        bool operator==(const ViewStamp&) const noexcept = default;
     };
 
+    static constexpr int maxCaptureChannels = AnalysisRingBuffer::maxChannels;
+    static_assert(BlockSummary::maxChannels >= maxCaptureChannels);
+
     WaveformAudioProcessor();
-    ~WaveformAudioProcessor() override = default;
+    ~WaveformAudioProcessor() override;
 
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
@@ -55,20 +68,58 @@ public:
     juce::AudioProcessorValueTreeState& getValueTreeState() noexcept;
     const juce::AudioProcessorValueTreeState& getValueTreeState() const noexcept;
 
-    TimeWindowResolver::ResolvedWindow resolveCurrentWindow() const noexcept;
     bool copyRecentSamples(juce::AudioBuffer<float>& destination, int numSamples) const;
     double getLoopPhaseNormalized() const noexcept;
-    bool getLoopRenderFrame(LoopRenderFrame& out, int requestedSamples) const;
 
-    double getCurrentSampleRateHz() const noexcept;
-    int getAnalysisCapacity() const noexcept;
+    // RenderSource
+    const std::atomic<float>* getViewParameter(const char* parameterID) const noexcept override;
+    juce::AudioChannelSet getCaptureLayout() const override;
+    TimeWindowResolver::ResolvedWindow resolveCurrentWindow() const noexcept override;
+    bool getLoopRenderFrame(LoopRenderFrame& out, int requestedSamples) const override;
+    AnalysisRingHost::ReadScope pinAnalysis() const noexcept override;
+    bool isAnalysisReadCurrent(const AnalysisRingBuffer::ReadSpans& spans) const noexcept override;
+    bool copyAnalysisWindow(juce::AudioBuffer<float>& destination,
+                            int numSamples,
+                            int64_t endSample,
+                            int64_t& firstSample) const override;
+    bool getPeakRange(int channel, int64_t startSample, int64_t endSample, float& minimum, float& maximum) const noexcept override;
+    bool getBandEnergies(BandEnergyRing::Lane lane,
+                         int channel,
+                         int64_t startSample,
+                         int64_t endSample,
+                         BandEnergies& energies) const noexcept override;
+    double getCurrentSampleRateHz() const noexcept override;
+    double getAnalysisSampleRateHz() const noexcept override;
+    int getAnalysisCapacity() const noexcept override;
+    int drainBlockSummaries(BlockSummaryHistory& history) noexcept override;
+    void setSummaryConsumerAttached(bool attached) noexcept override;
+
+    AnalysisRingBuffer::ReadStats getAnalysisReadStats() const noexcept;
+    uint64_t getDroppedBlockSummaries() const noexcept;
+
+    // Message thread.
+    ViewStamp getViewStamp() const noexcept;
 
     void setLastEditorSize(int width, int height) noexcept;
     juce::Rectangle<int> getLastEditorBounds() const noexcept;
 
 private:
     juce::AudioProcessorValueTreeState parameters;
-    AnalysisRingBuffer analysisBuffer;
+    // Read on the audio thread every block, so looked up once rather than by ID.
+    const std::atomic<float>* timeModeValue = nullptr;
+    const std::atomic<float>* timeSyncDivisionValue = nullptr;
+    const std::atomic<float>* timeMsValue = nullptr;
+    AnalysisRingHost analysisRing;
+    BlockSummaryQueue blockSummaryQueue { 4096 };
+    BlockSummarizer blockSummarizer;
+    HalfBandDecimator analysisDecimator;
+    SpectralBandEngine spectralBands;
+    std::atomic<uint64_t> droppedBlockSummaries { 0 };
+    std::atomic<bool> summaryConsumerAttached { false };
+
+    // Set by any thread, the audio thread included, when the ring may need rebuilding or freeing;
+    // the message thread polls it, so nothing is ever posted from the audio thread.
+    std::atomic<bool> ringWorkPending { true };
 
     std::atomic<double> currentSampleRate { 44100.0 };
     std::atomic<double> hostTempoBpm { 120.0 };
@@ -85,9 +136,20 @@ private:
     std::atomic<double> lastClockBpm { 120.0 };
     std::atomic<bool> lastClockResetSuggested { false };
     std::atomic<bool> lastClockIsPlaying { false };
+    std::atomic<uint32_t> parameterGeneration { 0 };
     SyncClockState syncClockState;
+    ViewActivityState viewActivity;
+    std::atomic<int64_t> viewSettledAt { -1 }; // -1 while blocks still change the view
 
     bool buildLoopRenderFrame(LoopRenderFrame& out, int requestedSamples) const;
+    AnalysisRingHost::Layout desiredRingLayout() const noexcept;
+    int captureAnalysis(AnalysisRingBuffer& ring,
+                        const juce::AudioBuffer<float>& buffer,
+                        double phaseAtBlockStart,
+                        double phasePerSample) noexcept;
+
+    void timerCallback() override;
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
 
     std::atomic<int> editorWidth { 960 };
     std::atomic<int> editorHeight { 540 };
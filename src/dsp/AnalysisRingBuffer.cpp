@@ -1,15 +1,51 @@
 #include "AnalysisRingBuffer.h"
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
 namespace wvfrm
 {
 
-void AnalysisRingBuffer::prepare(int channels, int samplesPerChannel)
+namespace
+{
+// Shared by every ring so spans from a replaced ring never validate against its successor.
+std::atomic<uint64_t> nextGeneration { 1 };
+
+uint64_t takeGeneration() noexcept
+{
+    return nextGeneration.fetch_add(1, std::memory_order_relaxed);
+}
+} // namespace
+
+void AnalysisRingBuffer::prepare(int channels, int samplesPerChannel, SampleFormat formatToUse, int64_t startPosition)
 {
     sequence.fetch_add(1, std::memory_order_acq_rel); // begin write (odd)
-    storage.setSize(juce::jmax(1, channels), juce::jmax(1, samplesPerChannel), false, true, true);
-    storage.clear();
-    writeIndex.store(0, std::memory_order_relaxed);
-    totalWrittenSamples.store(0, std::memory_order_relaxed);
+    format = formatToUse;
+    storedChannels = juce::jlimit(1, maxChannels, channels);
+    storedCapacity = juce::jmax(1, samplesPerChannel);
+
+    if (format == SampleFormat::float32)
+    {
+        storage.setSize(storedChannels, storedCapacity, false, true, true);
+        storage.clear();
+        packedStorage = {};
+    }
+    else
+    {
+        storage = {};
+        packedStorage.assign(static_cast<size_t>(storedChannels) * static_cast<size_t>(storedCapacity), 0);
+    }
+
+    peaks.prepare(storedChannels, storedCapacity);
+    bandEnergies = {};
+    numChunks = ((storedCapacity - 1) >> chunkShift) + 1;
+    chunkStamps = std::make_unique<std::atomic<uint64_t>[]>(static_cast<size_t>(numChunks));
+    startPosition = juce::jmax<int64_t>(0, startPosition);
+    writeIndex.store(static_cast<int>(startPosition % storedCapacity), std::memory_order_relaxed);
+    totalWrittenSamples.store(startPosition, std::memory_order_relaxed);
+    writeHorizon.store(startPosition, std::memory_order_relaxed);
+    generation.store(takeGeneration(), std::memory_order_relaxed);
     sequence.fetch_add(1, std::memory_order_release); // end write (even)
 }
 
@@ -17,40 +53,118 @@ void AnalysisRingBuffer::clear()
 {
     sequence.fetch_add(1, std::memory_order_acq_rel); // begin write (odd)
     storage.clear();
+    std::fill(packedStorage.begin(), packedStorage.end(), static_cast<uint16_t>(0));
+    peaks.clear();
+    bandEnergies.clear();
     writeIndex.store(0, std::memory_order_relaxed);
     totalWrittenSamples.store(0, std::memory_order_relaxed);
+    writeHorizon.store(0, std::memory_order_relaxed);
+    generation.store(takeGeneration(), std::memory_order_relaxed);
+    sequence.fetch_add(1, std::memory_order_release); // end write (even)
+}
+
+void AnalysisRingBuffer::enableBandEnergies(double sampleRate)
+{
+    sequence.fetch_add(1, std::memory_order_acq_rel); // begin write (odd)
+    bandEnergies.prepare(storedChannels, storedCapacity, sampleRate);
     sequence.fetch_add(1, std::memory_order_release); // end write (even)
 }
 
 void AnalysisRingBuffer::pushBuffer(const juce::AudioBuffer<float>& buffer) noexcept
 {
-    const auto channels = juce::jmin(storage.getNumChannels(), buffer.getNumChannels());
-    const auto capacity = storage.getNumSamples();
+    pushSamples(buffer.getArrayOfReadPointers(), buffer.getNumChannels(), buffer.getNumSamples());
+}
 
-    if (channels <= 0 || capacity <= 0)
-        return;
+void AnalysisRingBuffer::pushSamples(const float* const* channelData, int numChannels, int numSamples) noexcept
+{
+    pushSamples(channelData, channelData, channelData, numChannels, numSamples);
+}
 
-    const auto numSamples = buffer.getNumSamples();
-    if (numSamples <= 0)
+void AnalysisRingBuffer::pushSamples(const float* const* channelData,
+                                     const float* const* envelopeMinimum,
+                                     const float* const* envelopeMaximum,
+                                     int numChannels,
+                                     int numSamples) noexcept
+{
+    const auto channels = juce::jmin(storedChannels, numChannels);
+    const auto capacity = storedCapacity;
+
+    if (channels <= 0 || capacity <= 0 || numSamples <= 0)
         return;
 
     sequence.fetch_add(1, std::memory_order_acq_rel); // begin write (odd)
     const auto localWriteIndex = writeIndex.load(std::memory_order_relaxed);
+    const auto writtenSamples = totalWrittenSamples.load(std::memory_order_relaxed);
+
+    // Published before the copy so in-place readers can tell which samples are about to go.
+    writeHorizon.store(writtenSamples + numSamples, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // Only the newest `capacity` samples survive, written as at most two spans split at the wrap.
+    const auto samplesToWrite = juce::jmin(numSamples, capacity);
+    const auto sourceOffset = numSamples - samplesToWrite;
+    const auto ringStart = static_cast<int>((static_cast<int64_t>(localWriteIndex) + sourceOffset) % capacity);
+    const auto firstPart = juce::jmin(samplesToWrite, capacity - ringStart);
 
-    for (int sample = 0; sample < numSamples; ++sample)
+    bumpChunkStamps(ringStart, firstPart, samplesToWrite - firstPart, std::memory_order_relaxed); // chunks odd
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int channel = 0; channel < channels; ++channel)
     {
-        const auto ringIndex = (localWriteIndex + sample) % capacity;
+        const auto* source = channelData[channel] + sourceOffset;
+        writeStored(channel, ringStart, source, firstPart);
 
-        for (int channel = 0; channel < channels; ++channel)
-            storage.setSample(channel, ringIndex, buffer.getSample(channel, sample));
+        if (samplesToWrite > firstPart)
+            writeStored(channel, 0, source + firstPart, samplesToWrite - firstPart);
     }
 
-    writeIndex.store((localWriteIndex + numSamples) % capacity, std::memory_order_relaxed);
-    const auto writtenSamples = totalWrittenSamples.load(std::memory_order_relaxed);
+    bumpChunkStamps(ringStart, firstPart, samplesToWrite - firstPart, std::memory_order_release); // chunks even
+
+    writeIndex.store(static_cast<int>((static_cast<int64_t>(localWriteIndex) + numSamples) % capacity), std::memory_order_relaxed);
+    peaks.update(envelopeMinimum, envelopeMaximum, channels, writtenSamples, numSamples);
+    bandEnergies.update(channelData, channels, writtenSamples, numSamples);
     totalWrittenSamples.store(writtenSamples + numSamples, std::memory_order_relaxed);
     sequence.fetch_add(1, std::memory_order_release); // end write (even)
 }
 
+void AnalysisRingBuffer::appendFrom(const AnalysisRingBuffer& source, int maxSamples) noexcept
+{
+    constexpr auto piece = 128;
+    float samples[maxChannels][piece];
+    const float* pointers[maxChannels];
+
+    const auto channels = juce::jmin(source.storedChannels, storedChannels, maxChannels);
+    const auto sourceEnd = source.getTotalWrittenSamples();
+    const auto tail = juce::jmin(juce::jmax(0, maxSamples), source.storedCapacity, storedCapacity);
+    auto position = getTotalWrittenSamples();
+
+    if (channels <= 0 || position >= sourceEnd)
+        return;
+
+    if (position < sourceEnd - tail)
+    {
+        position = sourceEnd - tail;
+        skipTo(position);
+    }
+
+    while (position < sourceEnd)
+    {
+        const auto ringIndex = static_cast<int>(position % source.storedCapacity);
+        const auto count = static_cast<int>(juce::jmin<int64_t>(piece,
+                                                                sourceEnd - position,
+                                                                source.storedCapacity - ringIndex));
+
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            source.readStored(channel, ringIndex, samples[channel], count);
+            pointers[channel] = samples[channel];
+        }
+
+        pushSamples(pointers, channels, count);
+        position += count;
+    }
+}
+
 bool AnalysisRingBuffer::copyMostRecent(juce::AudioBuffer<float>& destination, int numSamples) const
 {
     return copyWindowEndingAt(destination, numSamples, getTotalWrittenSamples());
@@ -58,7 +172,134 @@ bool AnalysisRingBuffer::copyMostRecent(juce::AudioBuffer<float>& destination, i
 
 bool AnalysisRingBuffer::copyWindowEndingAt(juce::AudioBuffer<float>& destination,
                                             int numSamples,
-                                            int64_t endSampleExclusive) const
+                                            int64_t endSampleExclusive,
+                                            int64_t* firstSampleOut) const
+{
+    auto channels = 0;
+    auto capacity = 0;
+    int64_t latestEnd = 0;
+    uint64_t readGeneration = 0;
+    auto snapshotOk = false;
+
+    for (int attempt = 0; attempt < 16; ++attempt)
+    {
+        const auto seqBegin = sequence.load(std::memory_order_acquire);
+        if ((seqBegin & 1u) != 0u)
+            continue;
+
+        channels = safeChannelCount();
+        capacity = storedCapacity;
+        latestEnd = totalWrittenSamples.load(std::memory_order_relaxed);
+        readGeneration = generation.load(std::memory_order_relaxed);
+
+        const auto seqEnd = sequence.load(std::memory_order_acquire);
+        if (seqBegin == seqEnd)
+        {
+            snapshotOk = true;
+            break;
+        }
+    }
+
+    if (! snapshotOk)
+    {
+        failedReads.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (channels <= 0 || capacity <= 0)
+        return false;
+
+    const auto earliestAvailable = juce::jmax<int64_t>(0, latestEnd - capacity);
+    const auto requestedEnd = juce::jlimit<int64_t>(earliestAvailable, latestEnd, endSampleExclusive);
+
+    if (requestedEnd <= earliestAvailable)
+        return false;
+
+    auto samplesToCopy = juce::jlimit(1, capacity, numSamples);
+    auto absoluteStart = requestedEnd - samplesToCopy;
+
+    if (absoluteStart < earliestAvailable)
+    {
+        absoluteStart = earliestAvailable;
+        samplesToCopy = static_cast<int>(requestedEnd - absoluteStart);
+    }
+
+    if (samplesToCopy <= 0)
+        return false;
+
+    destination.setSize(channels, samplesToCopy, false, true, true);
+
+    // Oldest chunk first; a piece is retried on its own if the writer stamped its chunk meanwhile.
+    auto validStart = absoluteStart;
+    auto copied = 0;
+
+    while (copied < samplesToCopy)
+    {
+        const auto ringIndex = static_cast<int>((absoluteStart + copied) % static_cast<int64_t>(capacity));
+        const auto chunk = ringIndex >> chunkShift;
+        const auto chunkEnd = juce::jmin((chunk + 1) << chunkShift, capacity);
+        const auto pieceLength = juce::jmin(samplesToCopy - copied, chunkEnd - ringIndex);
+        auto& stamp = chunkStamps[static_cast<size_t>(chunk)];
+
+        auto pieceOk = false;
+        for (int attempt = 0; attempt < 16 && ! pieceOk; ++attempt)
+        {
+            const auto stampBegin = stamp.load(std::memory_order_acquire);
+            if ((stampBegin & 1u) == 0u)
+            {
+                for (int channel = 0; channel < channels; ++channel)
+                    readStored(channel, ringIndex, destination.getWritePointer(channel, copied), pieceLength);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                pieceOk = stamp.load(std::memory_order_relaxed) == stampBegin;
+            }
+
+            if (! pieceOk)
+                chunkRetries.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (! pieceOk)
+        {
+            failedReads.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // A consistent chunk can still hold newer audio if the writer lapped it before we read it.
+        validStart = juce::jmax(validStart, writeHorizon.load(std::memory_order_relaxed) - capacity);
+        copied += pieceLength;
+    }
+
+    if (generation.load(std::memory_order_relaxed) != readGeneration || validStart >= requestedEnd)
+    {
+        failedReads.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (validStart > absoluteStart)
+    {
+        const auto dropped = static_cast<int>(validStart - absoluteStart);
+        const auto kept = samplesToCopy - dropped;
+
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            auto* data = destination.getWritePointer(channel);
+            std::memmove(data, data + dropped, sizeof(float) * static_cast<size_t>(kept));
+        }
+
+        destination.setSize(channels, kept, true, false, true);
+        absoluteStart = validStart;
+        partialReads.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (firstSampleOut != nullptr)
+        *firstSampleOut = absoluteStart;
+
+    return true;
+}
+
+bool AnalysisRingBuffer::readWindowEndingAt(ReadSpans& spans,
+                                            int numSamples,
+                                            int64_t endSampleExclusive) const noexcept
 {
     for (int attempt = 0; attempt < 16; ++attempt)
     {
@@ -66,8 +307,8 @@ bool AnalysisRingBuffer::copyWindowEndingAt(juce::AudioBuffer<float>& destinatio
         if ((seqBegin & 1u) != 0u)
             continue;
 
-        const auto channels = safeChannelCount();
-        const auto capacity = storage.getNumSamples();
+        const auto channels = storedChannels;
+        const auto capacity = storedCapacity;
         const auto latestEnd = totalWrittenSamples.load(std::memory_order_relaxed);
 
         if (channels <= 0 || capacity <= 0)
@@ -79,27 +320,78 @@ bool AnalysisRingBuffer::copyWindowEndingAt(juce::AudioBuffer<float>& destinatio
         if (requestedEnd <= earliestAvailable)
             return false;
 
-        auto samplesToCopy = juce::jlimit(1, capacity, numSamples);
-        auto absoluteStart = requestedEnd - samplesToCopy;
+        const auto absoluteStart = juce::jmax(earliestAvailable, requestedEnd - juce::jlimit(1, capacity, numSamples));
+        const auto samplesToRead = static_cast<int>(requestedEnd - absoluteStart);
 
-        if (absoluteStart < earliestAvailable)
-        {
-            absoluteStart = earliestAvailable;
-            samplesToCopy = static_cast<int>(requestedEnd - absoluteStart);
-        }
+        spans.channels = format == SampleFormat::float32 ? storage.getArrayOfReadPointers() : nullptr;
+        spans.numChannels = channels;
+        spans.ringStart = static_cast<int>(absoluteStart % static_cast<int64_t>(capacity));
+        spans.firstSize = juce::jmin(samplesToRead, capacity - spans.ringStart);
+        spans.numSamples = samplesToRead;
+        spans.startSample = absoluteStart;
+        spans.generation = generation.load(std::memory_order_relaxed);
+
+        const auto seqEnd = sequence.load(std::memory_order_acquire);
+        if (seqBegin == seqEnd)
+            return true;
+    }
+
+    return false;
+}
+
+bool AnalysisRingBuffer::isReadStillValid(const ReadSpans& spans) const noexcept
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    const auto horizon = writeHorizon.load(std::memory_order_relaxed);
+    if (spans.generation != generation.load(std::memory_order_relaxed))
+        return false;
+
+    return spans.startSample >= horizon - static_cast<int64_t>(storedCapacity);
+}
+
+bool AnalysisRingBuffer::getPeakRange(int channel,
+                                      int64_t startSample,
+                                      int64_t endSampleExclusive,
+                                      float& minimum,
+                                      float& maximum) const noexcept
+{
+    for (int attempt = 0; attempt < 16; ++attempt)
+    {
+        const auto seqBegin = sequence.load(std::memory_order_acquire);
+        if ((seqBegin & 1u) != 0u)
+            continue;
 
-        if (samplesToCopy <= 0)
+        const auto capacity = storedCapacity;
+        const auto latestEnd = totalWrittenSamples.load(std::memory_order_relaxed);
+
+        if (capacity <= 0 || ! juce::isPositiveAndBelow(channel, storedChannels))
             return false;
 
-        destination.setSize(channels, samplesToCopy, false, true, true);
+        const auto start = juce::jmax(startSample, juce::jmax<int64_t>(0, latestEnd - capacity));
+        const auto end = juce::jmin(endSampleExclusive, latestEnd);
+
+        if (end <= start)
+            return false;
 
-        for (int sample = 0; sample < samplesToCopy; ++sample)
+        minimum = std::numeric_limits<float>::max();
+        maximum = -std::numeric_limits<float>::max();
+
+        constexpr auto baseBlock = static_cast<int64_t>(1) << PeakPyramid::baseLevelShift;
+
+        if (peaks.getNumLevels() == 0 || end - start < 2 * baseBlock)
         {
-            const auto absoluteIndex = absoluteStart + sample;
-            const auto ringIndex = static_cast<int>(absoluteIndex % static_cast<int64_t>(capacity));
+            scanStored(channel, start, end, minimum, maximum);
+        }
+        else
+        {
+            // Ragged edges come from storage; whole blocks in between from the pyramid.
+            const auto firstBlock = (start + baseBlock - 1) >> PeakPyramid::baseLevelShift;
+            const auto endBlock = end >> PeakPyramid::baseLevelShift;
 
-            for (int channel = 0; channel < channels; ++channel)
-                destination.setSample(channel, sample, storage.getSample(channel, ringIndex));
+            scanStored(channel, start, firstBlock << PeakPyramid::baseLevelShift, minimum, maximum);
+            scanStored(channel, endBlock << PeakPyramid::baseLevelShift, end, minimum, maximum);
+            peaks.queryBlocks(channel, firstBlock, endBlock, minimum, maximum);
         }
 
         const auto seqEnd = sequence.load(std::memory_order_acquire);
@@ -110,6 +402,45 @@ bool AnalysisRingBuffer::copyWindowEndingAt(juce::AudioBuffer<float>& destinatio
     return false;
 }
 
+bool AnalysisRingBuffer::getBandEnergies(BandEnergyRing::Lane lane,
+                                         int channel,
+                                         int64_t startSample,
+                                         int64_t endSampleExclusive,
+                                         BandEnergies& energies) const noexcept
+{
+    for (int attempt = 0; attempt < 16; ++attempt)
+    {
+        const auto seqBegin = sequence.load(std::memory_order_acquire);
+        if ((seqBegin & 1u) != 0u)
+            continue;
+
+        if (! bandEnergies.isPrepared())
+            return false;
+
+        const auto latestEnd = totalWrittenSamples.load(std::memory_order_relaxed);
+        const auto firstRecord = startSample >> BandEnergyRing::recordShift;
+        const auto endRecord = juce::jmin((endSampleExclusive + BandEnergyRing::samplesPerRecord - 1) >> BandEnergyRing::recordShift,
+                                          latestEnd >> BandEnergyRing::recordShift);
+
+        if (endRecord <= firstRecord)
+            return false;
+
+        BandEnergies result;
+        const auto ok = bandEnergies.read(lane, channel, firstRecord, endRecord, result);
+
+        const auto seqEnd = sequence.load(std::memory_order_acquire);
+        if (seqBegin == seqEnd)
+        {
+            if (ok)
+                energies = result;
+
+            return ok;
+        }
+    }
+
+    return false;
+}
+
 int AnalysisRingBuffer::getNumChannels() const noexcept
 {
     for (int attempt = 0; attempt < 8; ++attempt)
@@ -118,14 +449,14 @@ int AnalysisRingBuffer::getNumChannels() const noexcept
         if ((seqBegin & 1u) != 0u)
             continue;
 
-        const auto channels = storage.getNumChannels();
+        const auto channels = storedChannels;
         const auto seqEnd = sequence.load(std::memory_order_acquire);
 
         if (seqBegin == seqEnd)
             return channels;
     }
 
-    return storage.getNumChannels();
+    return storedChannels;
 }
 
 int AnalysisRingBuffer::getCapacity() const noexcept
@@ -136,14 +467,25 @@ int AnalysisRingBuffer::getCapacity() const noexcept
         if ((seqBegin & 1u) != 0u)
             continue;
 
-        const auto capacity = storage.getNumSamples();
+        const auto capacity = storedCapacity;
         const auto seqEnd = sequence.load(std::memory_order_acquire);
 
         if (seqBegin == seqEnd)
             return capacity;
     }
 
-    return storage.getNumSamples();
+    return storedCapacity;
+}
+
+SampleFormat AnalysisRingBuffer::getFormat() const noexcept
+{
+    return format;
+}
+
+size_t AnalysisRingBuffer::getStorageBytes() const noexcept
+{
+    return static_cast<size_t>(storedChannels) * static_cast<size_t>(storedCapacity)
+         * static_cast<size_t>(SampleCodec::bytesPerSample(format));
 }
 
 int64_t AnalysisRingBuffer::getTotalWrittenSamples() const noexcept
@@ -151,9 +493,101 @@ int64_t AnalysisRingBuffer::getTotalWrittenSamples() const noexcept
     return totalWrittenSamples.load(std::memory_order_acquire);
 }
 
+AnalysisRingBuffer::ReadStats AnalysisRingBuffer::getReadStats() const noexcept
+{
+    ReadStats stats;
+    stats.failedReads = failedReads.load(std::memory_order_relaxed);
+    stats.partialReads = partialReads.load(std::memory_order_relaxed);
+    stats.chunkRetries = chunkRetries.load(std::memory_order_relaxed);
+    return stats;
+}
+
 int AnalysisRingBuffer::safeChannelCount() const noexcept
 {
-    return juce::jmax(storage.getNumChannels(), 1);
+    return juce::jmax(storedChannels, 1);
+}
+
+void AnalysisRingBuffer::writeStored(int channel, int ringIndex, const float* source, int numSamples) noexcept
+{
+    if (format == SampleFormat::float32)
+        juce::FloatVectorOperations::copy(storage.getWritePointer(channel, ringIndex), source, numSamples);
+    else
+        SampleCodec::encode(format, source, packedStorage.data() + static_cast<size_t>(channel) * static_cast<size_t>(storedCapacity) + ringIndex, numSamples);
+}
+
+void AnalysisRingBuffer::readStored(int channel, int ringIndex, float* destination, int numSamples) const noexcept
+{
+    if (format == SampleFormat::float32)
+        juce::FloatVectorOperations::copy(destination, storage.getReadPointer(channel, ringIndex), numSamples);
+    else
+        SampleCodec::decode(format, packedStorage.data() + static_cast<size_t>(channel) * static_cast<size_t>(storedCapacity) + ringIndex, destination, numSamples);
+}
+
+void AnalysisRingBuffer::skipTo(int64_t position) noexcept
+{
+    // The peak pyramid and band energies notice the jump on the next push and restart there.
+    sequence.fetch_add(1, std::memory_order_acq_rel); // begin write (odd)
+    writeIndex.store(static_cast<int>(position % storedCapacity), std::memory_order_relaxed);
+    writeHorizon.store(position, std::memory_order_relaxed);
+    totalWrittenSamples.store(position, std::memory_order_relaxed);
+    sequence.fetch_add(1, std::memory_order_release); // end write (even)
+}
+
+void AnalysisRingBuffer::scanStored(int channel,
+                                    int64_t startSample,
+                                    int64_t endSample,
+                                    float& minimum,
+                                    float& maximum) const noexcept
+{
+    constexpr auto decodeBlock = 64;
+    float decoded[decodeBlock];
+
+    auto position = startSample;
+
+    while (position < endSample)
+    {
+        // Never cross the wrap (nor, for compact storage, more than one decode block) in one step.
+        const auto ringIndex = static_cast<int>(position % storedCapacity);
+        auto count = static_cast<int>(juce::jmin<int64_t>(endSample - position, storedCapacity - ringIndex));
+        const float* data = nullptr;
+
+        if (format == SampleFormat::float32)
+        {
+            data = storage.getReadPointer(channel, ringIndex);
+        }
+        else
+        {
+            count = juce::jmin(count, decodeBlock);
+            readStored(channel, ringIndex, decoded, count);
+            data = decoded;
+        }
+
+        const auto range = juce::FloatVectorOperations::findMinAndMax(data, count);
+        minimum = juce::jmin(minimum, range.getStart());
+        maximum = juce::jmax(maximum, range.getEnd());
+        position += count;
+    }
+}
+
+void AnalysisRingBuffer::bumpChunkStamps(int ringStart, int firstPart, int secondPart, std::memory_order order) noexcept
+{
+    if (firstPart <= 0)
+        return;
+
+    const auto firstChunk = ringStart >> chunkShift;
+    const auto lastChunk = (ringStart + firstPart - 1) >> chunkShift;
+
+    for (auto chunk = firstChunk; chunk <= lastChunk; ++chunk)
+        chunkStamps[static_cast<size_t>(chunk)].fetch_add(1, order);
+
+    // The wrapped part starts at chunk 0; a chunk stamped twice would read as even mid-write.
+    if (secondPart > 0)
+    {
+        const auto wrappedLast = juce::jmin((secondPart - 1) >> chunkShift, firstChunk - 1);
+
+        for (auto chunk = 0; chunk <= wrappedLast; ++chunk)
+            chunkStamps[static_cast<size_t>(chunk)].fetch_add(1, order);
+    }
 }
 
 } // namespace wvfrm
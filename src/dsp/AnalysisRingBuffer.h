@@ -3,6 +3,12 @@
 #include "../JuceIncludes.h"
 
 #include <atomic>
+#include <memory>
+#include <vector>
+
+#include "BandEnergyRing.h"
+#include "PeakPyramid.h"
+#include "SampleCodec.h"
 
 namespace wvfrm
 {
@@ -10,24 +16,139 @@ namespace wvfrm
 class AnalysisRingBuffer
 {
 public:
-    void prepare(int channels, int samplesPerChannel);
+    // A window viewed in place: per channel, [ringStart, ringStart + firstSize) of the storage
+    // followed by [0, numSamples - firstSize) after the wrap. Pinned by generation/startSample;
+    // confirm with isReadStillValid() after consuming, since the writer keeps running.
+    // Spans made by fromBuffer() describe a caller-owned copy and carry generation 0.
+    // Compact storage cannot be viewed in place: the spans then only describe the window
+    // (channels is null) and the caller decodes it with copyWindowEndingAt().
+    struct ReadSpans
+    {
+        const float* const* channels = nullptr;
+        int numChannels = 0;
+        int ringStart = 0;
+        int firstSize = 0;
+        int numSamples = 0;
+        int64_t startSample = 0;
+        uint64_t generation = 0;
+
+        static ReadSpans fromBuffer(const juce::AudioBuffer<float>& buffer, int64_t firstSample) noexcept
+        {
+            ReadSpans spans;
+            spans.channels = buffer.getArrayOfReadPointers();
+            spans.numChannels = buffer.getNumChannels();
+            spans.firstSize = buffer.getNumSamples();
+            spans.numSamples = buffer.getNumSamples();
+            spans.startSample = firstSample;
+            return spans;
+        }
+
+        const float* firstSpan(int channel) const noexcept { return channels[channel] + ringStart; }
+        const float* secondSpan(int channel) const noexcept { return channels[channel]; }
+        int secondSize() const noexcept { return numSamples - firstSize; }
+        bool isOwnedCopy() const noexcept { return generation == 0; }
+        bool needsDecode() const noexcept { return channels == nullptr && numSamples > 0; }
+
+        float getSample(int channel, int index) const noexcept
+        {
+            return index < firstSize ? channels[channel][ringStart + index]
+                                     : channels[channel][index - firstSize];
+        }
+    };
+
+    struct ReadStats
+    {
+        uint64_t failedReads = 0;
+        uint64_t partialReads = 0;
+        uint64_t chunkRetries = 0;
+    };
+
+    static constexpr int maxChannels = 16;
+
+    // Storage is stamped in chunks of 2^chunkShift samples so a copy only retries the chunks
+    // the writer actually touched while they were being read.
+    static constexpr int chunkShift = 12;
+
+    // Sample positions continue from startPosition, so a replacement ring keeps the old clock.
+    void prepare(int channels,
+                 int samplesPerChannel,
+                 SampleFormat formatToUse = SampleFormat::float32,
+                 int64_t startPosition = 0);
     void clear();
 
+    // Optional: also keep streaming band energies for the stored stream, which runs at
+    // sampleRate. Call after prepare() and before the first push.
+    void enableBandEnergies(double sampleRate);
+
     void pushBuffer(const juce::AudioBuffer<float>& buffer) noexcept;
+    void pushSamples(const float* const* channelData, int numChannels, int numSamples) noexcept;
+
+    // For a decimated stream: the peak pyramid is built from the envelope rather than the samples.
+    void pushSamples(const float* const* channelData,
+                     const float* const* envelopeMinimum,
+                     const float* const* envelopeMaximum,
+                     int numChannels,
+                     int numSamples) noexcept;
+
+    // Writer thread only: pushes at most the newest maxSamples of what source holds beyond this
+    // ring's newest sample. Used to catch a freshly seeded replacement up with the ring it takes
+    // over from. Should more be missing, the clock jumps ahead over the rest, and that stretch
+    // keeps whatever this ring held there.
+    void appendFrom(const AnalysisRingBuffer& source, int maxSamples) noexcept;
     bool copyMostRecent(juce::AudioBuffer<float>& destination, int numSamples) const;
-    bool copyWindowEndingAt(juce::AudioBuffer<float>& destination, int numSamples, int64_t endSampleExclusive) const;
+    bool copyWindowEndingAt(juce::AudioBuffer<float>& destination,
+                            int numSamples,
+                            int64_t endSampleExclusive,
+                            int64_t* firstSampleOut = nullptr) const;
+    bool readWindowEndingAt(ReadSpans& spans, int numSamples, int64_t endSampleExclusive) const noexcept;
+    bool isReadStillValid(const ReadSpans& spans) const noexcept;
+    bool getPeakRange(int channel,
+                      int64_t startSample,
+                      int64_t endSampleExclusive,
+                      float& minimum,
+                      float& maximum) const noexcept;
+
+    // RMS band levels over the band-energy records covering [startSample, endSampleExclusive),
+    // trimmed to the ones already complete; false when band energies are off or not all held.
+    bool getBandEnergies(BandEnergyRing::Lane lane,
+                         int channel,
+                         int64_t startSample,
+                         int64_t endSampleExclusive,
+                         BandEnergies& energies) const noexcept;
 
     int getNumChannels() const noexcept;
     int getCapacity() const noexcept;
+    SampleFormat getFormat() const noexcept;
+    size_t getStorageBytes() const noexcept;
     int64_t getTotalWrittenSamples() const noexcept;
+    ReadStats getReadStats() const noexcept;
 
 private:
     int safeChannelCount() const noexcept;
+    void writeStored(int channel, int ringIndex, const float* source, int numSamples) noexcept;
+    void readStored(int channel, int ringIndex, float* destination, int numSamples) const noexcept;
+    void skipTo(int64_t position) noexcept;
+    void scanStored(int channel, int64_t startSample, int64_t endSample, float& minimum, float& maximum) const noexcept;
+    void bumpChunkStamps(int ringStart, int firstPart, int secondPart, std::memory_order order) noexcept;
 
     std::atomic<uint64_t> sequence { 0 };
-    juce::AudioBuffer<float> storage;
+    std::atomic<uint64_t> generation { 0 };
+    SampleFormat format = SampleFormat::float32;
+    int storedChannels = 0;
+    int storedCapacity = 0;
+    juce::AudioBuffer<float> storage;      // float32
+    std::vector<uint16_t> packedStorage;   // float16/int16, channel-major
+    PeakPyramid peaks;
+    BandEnergyRing bandEnergies;
     std::atomic<int> writeIndex { 0 };
     std::atomic<int64_t> totalWrittenSamples { 0 };
+    std::atomic<int64_t> writeHorizon { 0 };
+    std::unique_ptr<std::atomic<uint64_t>[]> chunkStamps;
+    int numChunks = 0;
+
+    mutable std::atomic<uint64_t> failedReads { 0 };
+    mutable std::atomic<uint64_t> partialReads { 0 };
+    mutable std::atomic<uint64_t> chunkRetries { 0 };
 };
 
 } // namespace wvfrm
@@ -0,0 +1,277 @@
+#include "AnalysisRingHost.h"
+
+#include <array>
+#include <cmath>
+
+namespace wvfrm
+{
+
+namespace
+{
+// Linear interpolation is plenty for a display history and keeps the rebuild cheap. Both runs
+// end at the same instant, so output sample i sits (numOutput - i) new periods before that end.
+void resampleLinear(const float* input, int numInput, float* output, int numOutput, double inputPerOutput) noexcept
+{
+    if (numInput <= 0)
+    {
+        juce::FloatVectorOperations::clear(output, numOutput);
+        return;
+    }
+
+    for (int i = 0; i < numOutput; ++i)
+    {
+        const auto position = juce::jmax(0.0, static_cast<double>(numInput) - static_cast<double>(numOutput - i) * inputPerOutput);
+        const auto index = juce::jmin(numInput - 1, static_cast<int>(position));
+        const auto next = juce::jmin(numInput - 1, index + 1);
+        const auto fraction = static_cast<float>(position - static_cast<double>(index));
+        output[i] = input[index] + fraction * (input[next] - input[index]);
+    }
+}
+} // namespace
+
+int AnalysisRingHost::capacityForWindow(double windowSamples) noexcept
+{
+    const auto wanted = std::ceil(juce::jmax(0.0, windowSamples) * 1.25 + 8192.0);
+    const auto clamped = static_cast<int>(juce::jlimit(static_cast<double>(minimumCapacity),
+                                                       static_cast<double>(maximumCapacity),
+                                                       wanted));
+    return juce::jmin(maximumCapacity, juce::nextPowerOfTwo(clamped));
+}
+
+AnalysisRingHost::ReadScope::ReadScope(const AnalysisRingHost& hostToPin) noexcept
+    : host(hostToPin)
+{
+    // Pairs with the fence in promoteOrReclaim(): either the message thread sees this scope, or
+    // every reader() after it sees the replacement.
+    host.openReadScopes.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+AnalysisRingHost::ReadScope::~ReadScope()
+{
+    host.openReadScopes.fetch_sub(1, std::memory_order_release);
+}
+
+AnalysisRingHost::AnalysisRingHost()
+{
+    published.store(&fallback, std::memory_order_release);
+}
+
+AnalysisRingHost::~AnalysisRingHost() = default;
+
+void AnalysisRingHost::noteSampleRateChange(double sampleRate, int64_t position) noexcept
+{
+    if (sampleRate <= 0.0 || juce::approximatelyEqual(sampleRate, incomingRate))
+        return;
+
+    incomingRate = sampleRate;
+    rateChangePosition = position;
+}
+
+bool AnalysisRingHost::rebuild(const Layout& layout)
+{
+    if (! promoteOrReclaim())
+        return false;
+
+    auto ring = std::make_unique<AnalysisRingBuffer>();
+    seed(*ring, layout);
+    catchUp(*ring);
+
+    nextLayout = layout;
+    targetCapacity.store(layout.capacity, std::memory_order_relaxed);
+
+    if (live == nullptr)
+    {
+        // Nothing has been adopted yet, so there is no history to protect; publish directly.
+        live = std::move(ring);
+        liveLayout = layout;
+        activeDecimationStages.store(layout.decimationStages, std::memory_order_relaxed);
+        activeSampleRate.store(layout.sampleRate, std::memory_order_relaxed);
+        published.store(live.get(), std::memory_order_release);
+    }
+    else
+    {
+        next = std::move(ring);
+        pending.store(next.get(), std::memory_order_release);
+    }
+
+    if (juce::approximatelyEqual(layout.sampleRate, incomingRate))
+        rateChangePosition = -1;
+
+    return true;
+}
+
+bool AnalysisRingHost::releaseRetired() noexcept
+{
+    if (next != nullptr && published.load(std::memory_order_acquire) == next.get())
+        return promoteOrReclaim();
+
+    return true;
+}
+
+AnalysisRingBuffer& AnalysisRingHost::beginBlock(bool& adopted) noexcept
+{
+    adopted = false;
+
+    if (pending.load(std::memory_order_relaxed) != nullptr)
+    {
+        // exchange() is the handshake: the message thread reclaims with a compare-exchange instead.
+        if (auto* incoming = pending.exchange(nullptr, std::memory_order_acq_rel))
+        {
+            incoming->appendFrom(*published.load(std::memory_order_relaxed), maxAdoptionCatchUp);
+            activeDecimationStages.store(nextLayout.decimationStages, std::memory_order_relaxed);
+            activeSampleRate.store(nextLayout.sampleRate, std::memory_order_relaxed);
+            published.store(incoming, std::memory_order_release);
+            adopted = true;
+        }
+    }
+
+    return *published.load(std::memory_order_relaxed);
+}
+
+const AnalysisRingBuffer& AnalysisRingHost::reader() const noexcept
+{
+    return *published.load(std::memory_order_acquire);
+}
+
+int AnalysisRingHost::getActiveDecimationStages() const noexcept
+{
+    return activeDecimationStages.load(std::memory_order_relaxed);
+}
+
+double AnalysisRingHost::getActiveSampleRate() const noexcept
+{
+    return activeSampleRate.load(std::memory_order_relaxed);
+}
+
+AnalysisRingHost::Layout AnalysisRingHost::getTargetLayout() const noexcept
+{
+    return next != nullptr ? nextLayout : liveLayout;
+}
+
+bool AnalysisRingHost::needsResize(int requiredCapacity) const noexcept
+{
+    const auto capacity = targetCapacity.load(std::memory_order_relaxed);
+    return requiredCapacity > capacity || requiredCapacity * 4 <= capacity;
+}
+
+int AnalysisRingHost::chooseCapacity(int requiredCapacity) const noexcept
+{
+    return needsResize(requiredCapacity) ? requiredCapacity : targetCapacity.load(std::memory_order_relaxed);
+}
+
+bool AnalysisRingHost::promoteOrReclaim() noexcept
+{
+    if (next == nullptr)
+        return true;
+
+    if (published.load(std::memory_order_acquire) == next.get())
+    {
+        // The audio thread has moved over; the previous ring is ours to free once no reader
+        // that might have picked it up is still open.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (openReadScopes.load(std::memory_order_acquire) > 0)
+            return false;
+
+        live = std::move(next);
+        liveLayout = nextLayout;
+        return true;
+    }
+
+    auto* expected = next.get();
+    if (pending.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel))
+    {
+        // Never adopted (audio stopped, most likely): drop it and build afresh from the live ring.
+        next.reset();
+        targetCapacity.store(liveLayout.capacity, std::memory_order_relaxed);
+        return true;
+    }
+
+    return false; // claimed by the audio thread but not yet published
+}
+
+void AnalysisRingHost::seed(AnalysisRingBuffer& target, const Layout& layout) const
+{
+    const auto& source = reader();
+    const auto sourceEnd = source.getTotalWrittenSamples();
+
+    juce::AudioBuffer<float> history;
+    int64_t firstSample = 0;
+    const auto copied = source.getCapacity() > 0
+        && source.copyWindowEndingAt(history, source.getCapacity(), sourceEnd, &firstSample);
+
+    if (! copied)
+    {
+        target.prepare(layout.channels, layout.capacity, layout.format, sourceEnd);
+        target.enableBandEnergies(layout.sampleRate);
+        return;
+    }
+
+    const auto historyEnd = firstSample + history.getNumSamples();
+    const auto resample = rateChangePosition >= 0 && liveLayout.sampleRate > 0.0 && layout.sampleRate > 0.0
+        && ! juce::approximatelyEqual(liveLayout.sampleRate, layout.sampleRate);
+
+    if (resample)
+    {
+        // Only audio older than the rate change was recorded at the old rate.
+        const auto oldCount = static_cast<int>(juce::jlimit<int64_t>(0, history.getNumSamples(), rateChangePosition - firstSample));
+        const auto newCount = history.getNumSamples() - oldCount;
+        const auto ratio = layout.sampleRate / liveLayout.sampleRate;
+        const auto resampledCount = static_cast<int>(std::floor(static_cast<double>(oldCount) * ratio));
+
+        juce::AudioBuffer<float> converted(history.getNumChannels(), resampledCount + newCount);
+
+        for (int channel = 0; channel < history.getNumChannels(); ++channel)
+        {
+            resampleLinear(history.getReadPointer(channel), oldCount, converted.getWritePointer(channel), resampledCount, 1.0 / ratio);
+            juce::FloatVectorOperations::copy(converted.getWritePointer(channel, resampledCount),
+                                              history.getReadPointer(channel, oldCount),
+                                              newCount);
+        }
+
+        history = std::move(converted);
+    }
+
+    // Keep the newest samples that fit, ending exactly where the source ends so the clock runs on.
+    const auto keep = static_cast<int>(juce::jmin<int64_t>(history.getNumSamples(), layout.capacity, historyEnd));
+    const auto offset = history.getNumSamples() - keep;
+
+    target.prepare(layout.channels, layout.capacity, layout.format, historyEnd - keep);
+    target.enableBandEnergies(layout.sampleRate);
+
+    std::array<const float*, AnalysisRingBuffer::maxChannels> pointers {};
+    const auto channels = juce::jmin(AnalysisRingBuffer::maxChannels, history.getNumChannels());
+    for (int channel = 0; channel < channels; ++channel)
+        pointers[static_cast<size_t>(channel)] = history.getReadPointer(channel, offset);
+
+    target.pushSamples(pointers.data(), channels, keep);
+}
+
+void AnalysisRingHost::catchUp(AnalysisRingBuffer& target) const
+{
+    // Each pass copies what arrived during the one before, so the gap shrinks fast; a block or
+    // so is left for the audio thread to copy when it adopts the ring.
+    constexpr auto passes = 8;
+    constexpr auto slack = 1024;
+
+    juce::AudioBuffer<float> arrived;
+
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        const auto& source = reader();
+        const auto targetEnd = target.getTotalWrittenSamples();
+        const auto sourceEnd = source.getTotalWrittenSamples();
+        const auto missing = sourceEnd - targetEnd;
+
+        if (missing <= slack || missing > source.getCapacity())
+            return;
+
+        int64_t firstSample = 0;
+        if (! source.copyWindowEndingAt(arrived, static_cast<int>(missing), sourceEnd, &firstSample) || firstSample != targetEnd)
+            return;
+
+        target.pushBuffer(arrived);
+    }
+}
+
+} // namespace wvfrm
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+
+#include <atomic>
+#include <memory>
+
+#include "AnalysisRingBuffer.h"
+
+namespace wvfrm
+{
+
+// Owns the analysis ring and replaces it without ever allocating on, or blocking, the audio
+// thread. The message thread builds a replacement seeded with the current history, tops it up
+// until it trails the live ring by less than a block, and parks it; the audio thread adopts it
+// at the start of its next block, copying across at most maxAdoptionCatchUp samples that
+// arrived since. Rings are only freed on the message thread, so readers there may
+// hold a reference from reader() for the duration of a callback; readers on other threads open
+// a ReadScope first, and a retired ring outlives every scope that was open when it was retired.
+class AnalysisRingHost
+{
+public:
+    class ReadScope
+    {
+    public:
+        explicit ReadScope(const AnalysisRingHost& hostToPin) noexcept;
+        ~ReadScope();
+
+    private:
+        const AnalysisRingHost& host;
+
+        JUCE_DECLARE_NON_COPYABLE(ReadScope)
+    };
+
+    struct Layout
+    {
+        int channels = 2;
+        int capacity = minimumCapacity;
+        SampleFormat format = SampleFormat::float32;
+        double sampleRate = 44100.0; // rate of the stored stream, after any decimation
+        int decimationStages = 0;
+
+        bool operator==(const Layout& other) const noexcept
+        {
+            return channels == other.channels && capacity == other.capacity && format == other.format
+                && juce::approximatelyEqual(sampleRate, other.sampleRate) && decimationStages == other.decimationStages;
+        }
+
+        bool operator!=(const Layout& other) const noexcept { return ! operator==(other); }
+    };
+
+    static constexpr int minimumCapacity = 1 << 14;
+    static constexpr int maximumCapacity = 1 << 21;
+
+    // Most samples the audio thread copies into a replacement when it adopts it; anything older
+    // still missing is skipped, leaving a gap in the history.
+    static constexpr int maxAdoptionCatchUp = 1 << 13;
+
+    // Power-of-two capacity with headroom for tempo drift, so small window moves don't reallocate.
+    static int capacityForWindow(double windowSamples) noexcept;
+
+    AnalysisRingHost();
+    ~AnalysisRingHost();
+
+    // Message thread. Samples at or after `position` arrive at `sampleRate`; older history is
+    // resampled to it by the next rebuild().
+    void noteSampleRateChange(double sampleRate, int64_t position) noexcept;
+
+    // Message thread. Builds a ring for `layout` carrying over the current history. Returns false
+    // while a previous replacement is mid-adoption or the ring it retired is still being read;
+    // try again a moment later.
+    bool rebuild(const Layout& layout);
+
+    // Message thread. Frees a ring the audio thread has stopped using. Returns false while a
+    // ReadScope may still be reading it; try again a moment later.
+    bool releaseRetired() noexcept;
+
+    // Audio thread, once per block before pushing. Sets adopted when a replacement was taken over,
+    // which is the cue to let the message thread call releaseRetired().
+    AnalysisRingBuffer& beginBlock(bool& adopted) noexcept;
+
+    const AnalysisRingBuffer& reader() const noexcept;
+
+    // Describe the ring the audio thread is currently writing, so the capture path and readers
+    // agree on the stream's rate across a swap.
+    int getActiveDecimationStages() const noexcept;
+    double getActiveSampleRate() const noexcept;
+
+    // The layout most recently asked for, whether or not the audio thread has adopted it yet.
+    Layout getTargetLayout() const noexcept;
+
+    // Any thread. Grow as soon as the window outgrows the ring; shrink only once it fits in a
+    // quarter of it, so dragging the window length around a boundary doesn't thrash.
+    bool needsResize(int requiredCapacity) const noexcept;
+    int chooseCapacity(int requiredCapacity) const noexcept;
+
+private:
+    bool promoteOrReclaim() noexcept;
+    void seed(AnalysisRingBuffer& target, const Layout& layout) const;
+    void catchUp(AnalysisRingBuffer& target) const;
+
+    AnalysisRingBuffer fallback;
+    std::atomic<AnalysisRingBuffer*> published { nullptr };
+    std::atomic<AnalysisRingBuffer*> pending { nullptr };
+    std::atomic<int> targetCapacity { 0 };
+    std::atomic<int> activeDecimationStages { 0 };
+    std::atomic<double> activeSampleRate { 44100.0 };
+    mutable std::atomic<int> openReadScopes { 0 };
+
+    // Message-thread state. nextLayout is also read by the audio thread while adopting `next`,
+    // which is safe: it is written before the ring is parked and not again until it is retired.
+    std::unique_ptr<AnalysisRingBuffer> live;
+    std::unique_ptr<AnalysisRingBuffer> next;
+    Layout liveLayout;
+    Layout nextLayout;
+    double incomingRate = 0.0;
+    int64_t rateChangePosition = -1;
+
+    JUCE_DECLARE_NON_COPYABLE(AnalysisRingHost)
+};
+
+} // namespace wvfrm
@@ -0,0 +1,391 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+
+#include <array>
+#include <cmath>
+
+namespace wvfrm
+{
+
+// NumBands-way split at NumBands - 1 crossover frequencies using 4th-order Linkwitz-Riley
+// filters. Every band is a band-pass: an LR4 high-pass at its lower edge followed by an LR4
+// low-pass at its upper one, where the outer edges are a floor and a ceiling rather than a
+// split, so DC and ultrasonics count towards no band. Each band is one SIMD lane, so all of
+// them advance together; a register holds four bands on SSE and NEON, and band counts up to
+// four cost one register. The analyzer only holds coefficients; stream state lives in a Stream
+// the caller owns, so one analyzer can serve many channels.
+template <int NumBands>
+class BandAnalyzer
+{
+    using Register = juce::dsp::SIMDRegister<float>;
+
+    static constexpr int lanesPerRegister = static_cast<int>(Register::SIMDNumElements);
+    static constexpr size_t numRegisters = (NumBands + lanesPerRegister - 1) / lanesPerRegister;
+    static constexpr int paddedBands = static_cast<int>(numRegisters) * lanesPerRegister;
+
+    // LR4 is two identical 2nd-order Butterworth sections in series: stages 0-1 are the
+    // high-pass, stages 2-3 the low-pass, so only two sets of coefficients exist.
+    static constexpr size_t numStages = 4;
+
+public:
+    static_assert(NumBands >= 2, "A crossover needs at least two bands.");
+
+    static constexpr int numBands = NumBands;
+
+    // Segments analyzeSegments runs side by side: two registers, so one fills the other's latency.
+    static constexpr int segmentsPerBatch = 2 * lanesPerRegister;
+    static constexpr int numSplits = NumBands - 1;
+    static constexpr double defaultFloorHz = 20.0;
+    static constexpr double defaultCeilingHz = 20000.0;
+
+    using Energies = std::array<float, static_cast<size_t>(NumBands)>;
+    using Splits = std::array<double, static_cast<size_t>(numSplits)>;
+
+    // Filter state of one continuous stream; a default-constructed one is at rest.
+    struct Stream
+    {
+        Stream() noexcept { reset(); }
+
+        void reset() noexcept
+        {
+            for (auto& chain : s1)
+                chain.fill(Register::expand(0.0f));
+
+            for (auto& chain : s2)
+                chain.fill(Register::expand(0.0f));
+        }
+
+        std::array<std::array<Register, numStages>, numRegisters> s1, s2;
+    };
+
+    // Log-spaced over 20 Hz - 20 kHz, so three bands split at 200 Hz and 2 kHz.
+    static Splits defaultSplits() noexcept
+    {
+        Splits splits {};
+        for (int i = 0; i < numSplits; ++i)
+            splits[static_cast<size_t>(i)] = 20.0 * std::pow(1000.0, static_cast<double>(i + 1) / NumBands);
+
+        return splits;
+    }
+
+    BandAnalyzer() noexcept
+    {
+        prepare(48000.0, defaultSplits());
+    }
+
+    // Split frequencies must be ascending; every edge is clamped below Nyquist.
+    void prepare(double sampleRate,
+                 const Splits& splitFrequencies,
+                 double floorHz = defaultFloorHz,
+                 double ceilingHz = defaultCeilingHz) noexcept
+    {
+        splits = splitFrequencies;
+        rate = juce::jmax(1.0, sampleRate);
+
+        for (int band = 0; band < paddedBands; ++band)
+        {
+            // Padding lanes repeat the top band; their output is never read.
+            const auto real = juce::jmin(band, NumBands - 1);
+            const auto lower = real > 0 ? splits[static_cast<size_t>(real - 1)] : floorHz;
+            const auto upper = real < numSplits ? splits[static_cast<size_t>(real)] : ceilingHz;
+
+            const auto high = butterworthSection(lower, true);
+            const auto low = butterworthSection(upper, false);
+            setLane(highPass, band, high);
+            setLane(lowPass, band, low);
+
+            // The sections run without their numerator gains; all four are put back here, squared.
+            const auto gain = high.gain * high.gain * low.gain * low.gain;
+            const auto scale = static_cast<float>(gain * gain);
+            energyScale[static_cast<size_t>(band / lanesPerRegister)].set(static_cast<size_t>(band % lanesPerRegister), scale);
+
+            if (band < NumBands)
+                bandCoefficients[static_cast<size_t>(band)] = { Register::expand(static_cast<float>(high.a1)),
+                                                                Register::expand(static_cast<float>(high.a2)),
+                                                                Register::expand(static_cast<float>(low.a1)),
+                                                                Register::expand(static_cast<float>(low.a2)),
+                                                                scale };
+        }
+    }
+
+    double getSampleRate() const noexcept { return rate; }
+    const Splits& getSplitFrequencies() const noexcept { return splits; }
+
+    // Adds each band's squared output over samples[0, numSamples) to sumOfSquares and carries the
+    // stream's state on, so a stream fed in pieces sums the same as one fed whole.
+    void accumulate(Stream& stream, const float* samples, int numSamples, Energies& sumOfSquares) const noexcept
+    {
+        if (samples == nullptr || numSamples <= 0)
+            return;
+
+        std::array<Register, numRegisters> sums;
+        sums.fill(Register::expand(0.0f));
+        run<false>(stream, samples, numSamples, Register::expand(0.0f), sums.data());
+        addLanes(sums.data(), sumOfSquares);
+    }
+
+    // Band levels of one segment, starting from rest: each band's squared output goes through a
+    // one-pole smoother with coefficient smoothingAmount, and the level is the root of where it
+    // ends. A smoothingAmount of 0 reports the last sample's squared band output.
+    Energies analyzeSegment(const float* samples, int numSamples, float smoothingAmount) const noexcept
+    {
+        Energies energies {};
+        if (samples == nullptr || numSamples <= 0)
+            return energies;
+
+        Stream stream;
+        std::array<Register, numRegisters> levels;
+        levels.fill(Register::expand(0.0f));
+        run<true>(stream, samples, numSamples, Register::expand(juce::jlimit(0.0f, 1.0f, smoothingAmount)), levels.data());
+        addLanes(levels.data(), energies);
+
+        for (auto& energy : energies)
+            energy = std::sqrt(energy);
+
+        return energies;
+    }
+
+    // analyzeSegment for each of numSegments segments, turned sideways: each SIMD lane carries
+    // one segment through every band, segmentsPerBatch at a time. Segments may differ in length;
+    // results match analyzeSegment to rounding.
+    void analyzeSegments(const float* const* segments,
+                         const int* numSamples,
+                         int numSegments,
+                         float smoothingAmount,
+                         Energies* results) const noexcept
+    {
+        constexpr auto registers = 2;
+        constexpr auto width = segmentsPerBatch;
+        constexpr auto gatherSamples = 64;
+
+        if (segments == nullptr || numSamples == nullptr || results == nullptr || numSegments <= 0)
+            return;
+
+        const auto smooth = juce::jlimit(0.0f, 1.0f, smoothingAmount);
+        const auto smoothing = Register::expand(smooth);
+        const auto keep = Register::expand(1.0f - smooth);
+
+        alignas(Register::SIMDRegisterSize) float interleaved[gatherSamples * width];
+        alignas(Register::SIMDRegisterSize) float lanesOut[width];
+
+        for (int first = 0; first < numSegments; first += width)
+        {
+            const auto count = juce::jmin(width, numSegments - first);
+
+            // Shorter segments are front-padded with silence so every lane ends on the same step.
+            // Silence through a resting filter leaves its state and level exactly zero, so the
+            // padding does not change the result.
+            int lengths[width] {};
+            auto longest = 0;
+
+            for (int lane = 0; lane < count; ++lane)
+            {
+                lengths[lane] = segments[first + lane] != nullptr ? juce::jmax(0, numSamples[first + lane]) : 0;
+                longest = juce::jmax(longest, lengths[lane]);
+            }
+
+            constexpr auto bands = static_cast<size_t>(NumBands);
+            Register s1[bands][static_cast<size_t>(registers)][numStages];
+            Register s2[bands][static_cast<size_t>(registers)][numStages];
+            Register level[bands][static_cast<size_t>(registers)];
+
+            for (int band = 0; band < NumBands; ++band)
+            {
+                for (int r = 0; r < registers; ++r)
+                {
+                    for (size_t stage = 0; stage < numStages; ++stage)
+                        s1[band][r][stage] = s2[band][r][stage] = Register::expand(0.0f);
+
+                    level[band][r] = Register::expand(0.0f);
+                }
+            }
+
+            for (int base = 0; base < longest; base += gatherSamples)
+            {
+                const auto chunk = juce::jmin(gatherSamples, longest - base);
+
+                for (int lane = 0; lane < width; ++lane)
+                {
+                    const auto padding = longest - lengths[lane];
+                    const auto silent = juce::jlimit(0, chunk, padding - base);
+                    auto* column = interleaved + lane;
+
+                    for (int i = 0; i < silent; ++i)
+                        column[i * width] = 0.0f;
+
+                    if (silent < chunk)
+                    {
+                        const auto* samples = segments[first + lane] + (base + silent - padding);
+
+                        for (int i = silent; i < chunk; ++i)
+                            column[i * width] = *samples++;
+                    }
+                }
+
+                for (int i = 0; i < chunk; ++i)
+                {
+                    for (int r = 0; r < registers; ++r)
+                    {
+                        const auto x = Register::fromRawArray(interleaved + i * width + r * lanesPerRegister);
+
+                        for (int band = 0; band < NumBands; ++band)
+                        {
+                            const auto& c = bandCoefficients[static_cast<size_t>(band)];
+                            auto* state1 = s1[band][r];
+                            auto* state2 = s2[band][r];
+
+                            auto y = section<true>(x, state1[0], state2[0], c.highA1, c.highA2);
+                            y = section<true>(y, state1[1], state2[1], c.highA1, c.highA2);
+                            y = section<false>(y, state1[2], state2[2], c.lowA1, c.lowA2);
+                            y = section<false>(y, state1[3], state2[3], c.lowA1, c.lowA2);
+
+                            level[band][r] = smoothing * level[band][r] + keep * (y * y);
+                        }
+                    }
+                }
+            }
+
+            for (int band = 0; band < NumBands; ++band)
+            {
+                for (int r = 0; r < registers; ++r)
+                    level[band][r].copyToRawArray(lanesOut + r * lanesPerRegister);
+
+                const auto scale = bandCoefficients[static_cast<size_t>(band)].energyScale;
+                for (int lane = 0; lane < count; ++lane)
+                    results[first + lane][static_cast<size_t>(band)] = std::sqrt(lanesOut[lane] * scale);
+            }
+        }
+    }
+
+private:
+    struct Section
+    {
+        double gain = 1.0;
+        double a1 = 0.0;
+        double a2 = 0.0;
+    };
+
+    // A Butterworth section's numerator is gain * (1, -2, 1) for a high-pass and
+    // gain * (1, 2, 1) for a low-pass. The filters are linear, so the gains are left out of the
+    // per-sample step and applied once to the squared output instead; what remains of the
+    // numerator is adds.
+    struct SectionCoefficients
+    {
+        std::array<Register, numRegisters> a1, a2;
+    };
+
+    // One band's coefficients in every lane, for analyzeSegments.
+    struct BandCoefficients
+    {
+        Register highA1, highA2, lowA1, lowA2;
+        float energyScale = 1.0f;
+    };
+
+    Section butterworthSection(double frequency, bool isHighPass) const noexcept
+    {
+        const auto cutoff = juce::jlimit(1.0, rate * 0.45, frequency);
+        const auto omega = juce::MathConstants<double>::twoPi * cutoff / rate;
+        const auto cosine = std::cos(omega);
+        const auto alpha = std::sin(omega) / juce::MathConstants<double>::sqrt2; // Q = 1 / sqrt(2)
+        const auto a0 = 1.0 + alpha;
+
+        Section section;
+        section.gain = (isHighPass ? (1.0 + cosine) : (1.0 - cosine)) * 0.5 / a0;
+        section.a1 = -2.0 * cosine / a0;
+        section.a2 = (1.0 - alpha) / a0;
+        return section;
+    }
+
+    static void setLane(SectionCoefficients& target, int band, const Section& section) noexcept
+    {
+        const auto index = static_cast<size_t>(band / lanesPerRegister);
+        const auto lane = static_cast<size_t>(band % lanesPerRegister);
+
+        target.a1[index].set(lane, static_cast<float>(section.a1));
+        target.a2[index].set(lane, static_cast<float>(section.a2));
+    }
+
+    void addLanes(const Register* registers, Energies& energies) const noexcept
+    {
+        alignas(Register::SIMDRegisterSize) float lanes[static_cast<size_t>(paddedBands)];
+        for (size_t r = 0; r < numRegisters; ++r)
+            (registers[r] * energyScale[r]).copyToRawArray(lanes + r * static_cast<size_t>(lanesPerRegister));
+
+        for (int band = 0; band < NumBands; ++band)
+            energies[static_cast<size_t>(band)] += lanes[band];
+    }
+
+    // One transposed direct form II section with numerator (1, -2, 1) or (1, 2, 1).
+    template <bool IsHighPass>
+    static Register section(Register input, Register& s1, Register& s2, Register a1, Register a2) noexcept
+    {
+        const auto twice = input + input;
+        const auto output = input + s1;
+        s1 = (IsHighPass ? s2 - twice : s2 + twice) - a1 * output;
+        s2 = input - a2 * output;
+        return output;
+    }
+
+    // Runs one stream through the crossover. Smoothed levels follow
+    // level = smoothing * level + (1 - smoothing) * y^2; otherwise y^2 is summed into levels.
+    // State is held in locals for the whole run so the compiler can keep it in registers.
+    template <bool Smoothed>
+    void run(Stream& stream, const float* samples, int numSamples, Register smoothing, Register* levels) const noexcept
+    {
+        const auto keep = Register::expand(1.0f) - smoothing;
+
+        Register s1[numRegisters][numStages];
+        Register s2[numRegisters][numStages];
+        Register level[numRegisters];
+
+        for (size_t r = 0; r < numRegisters; ++r)
+        {
+            for (size_t stage = 0; stage < numStages; ++stage)
+            {
+                s1[r][stage] = stream.s1[r][stage];
+                s2[r][stage] = stream.s2[r][stage];
+            }
+
+            level[r] = levels[r];
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto x = Register::expand(samples[i]);
+
+            for (size_t r = 0; r < numRegisters; ++r)
+            {
+                auto y = section<true>(x, s1[r][0], s2[r][0], highPass.a1[r], highPass.a2[r]);
+                y = section<true>(y, s1[r][1], s2[r][1], highPass.a1[r], highPass.a2[r]);
+                y = section<false>(y, s1[r][2], s2[r][2], lowPass.a1[r], lowPass.a2[r]);
+                y = section<false>(y, s1[r][3], s2[r][3], lowPass.a1[r], lowPass.a2[r]);
+
+                if constexpr (Smoothed)
+                    level[r] = smoothing * level[r] + keep * (y * y);
+                else
+                    level[r] += y * y;
+            }
+        }
+
+        for (size_t r = 0; r < numRegisters; ++r)
+        {
+            for (size_t stage = 0; stage < numStages; ++stage)
+            {
+                stream.s1[r][stage] = s1[r][stage];
+                stream.s2[r][stage] = s2[r][stage];
+            }
+
+            levels[r] = level[r];
+        }
+    }
+
+    SectionCoefficients highPass {};
+    SectionCoefficients lowPass {};
+    std::array<Register, numRegisters> energyScale {};
+    std::array<BandCoefficients, static_cast<size_t>(NumBands)> bandCoefficients {};
+    Splits splits {};
+    double rate = 48000.0;
+};
+
+} // namespace wvfrm
@@ -1,6 +1,6 @@
 ﻿#include "BandAnalyzer3.h"
 
-#include <cmath>
+#include <algorithm>
 
 namespace wvfrm
 {
@@ -10,64 +10,85 @@ BandEnergies BandAnalyzer3::analyzeSegment(const float* samples,
                                            double sampleRate,
                                            float smoothingAmount) const noexcept
 {
-    BandEnergies output;
-
     if (samples == nullptr || numSamples <= 0 || sampleRate <= 0.0)
-        return output;
-
-    constexpr auto subCut = 20.0;
-    constexpr auto lowCut = 200.0;
-    constexpr auto highCut = 2000.0;
+        return {};
 
-    const auto subAlpha = alphaForCutoff(subCut, sampleRate);
-    const auto lowAlpha = alphaForCutoff(lowCut, sampleRate);
-    const auto highAlpha = alphaForCutoff(highCut, sampleRate);
+    return toBandEnergies(crossoverFor(sampleRate).analyzeSegment(samples, numSamples, smoothingAmount));
+}
 
-    float subLpState = 0.0f;
-    float lowState = 0.0f;
-    float hiLpState = 0.0f;
+void BandAnalyzer3::analyzeSegments(const float* const* segments,
+                                    const int* numSamples,
+                                    int numSegments,
+                                    double sampleRate,
+                                    float smoothingAmount,
+                                    BandEnergies* results) const noexcept
+{
+    if (segments == nullptr || numSamples == nullptr || results == nullptr || numSegments <= 0)
+        return;
 
-    float lowEnergy = 0.0f;
-    float midEnergy = 0.0f;
-    float highEnergy = 0.0f;
+    if (sampleRate <= 0.0)
+    {
+        std::fill(results, results + numSegments, BandEnergies {});
+        return;
+    }
 
-    const auto smooth = juce::jlimit(0.0f, 1.0f, smoothingAmount);
-    const auto oneMinusSmooth = 1.0f - smooth;
+    const auto& crossover = crossoverFor(sampleRate);
+    Crossover::Energies energies[batchSize];
 
-    for (int i = 0; i < numSamples; ++i)
+    for (int first = 0; first < numSegments; first += batchSize)
     {
-        const auto x = samples[i];
+        const auto count = juce::jmin(batchSize, numSegments - first);
+        crossover.analyzeSegments(segments + first, numSamples + first, count, smoothingAmount, energies);
 
-        subLpState += subAlpha * (x - subLpState);
-        lowState += lowAlpha * (x - lowState);
-        hiLpState += highAlpha * (x - hiLpState);
+        for (int i = 0; i < count; ++i)
+            results[first + i] = toBandEnergies(energies[i]);
+    }
+}
 
-        const auto low = lowState - subLpState;
-        const auto high = x - hiLpState;
-        const auto mid = x - low - high;
+void BandAnalyzer3::prepareCrossover(Crossover& crossover, double sampleRate) noexcept
+{
+    crossover.prepare(sampleRate, { lowCrossoverHz, highCrossoverHz });
+}
 
-        const auto lowSq = low * low;
-        const auto midSq = mid * mid;
-        const auto highSq = high * high;
+BandEnergies BandAnalyzer3::toBandEnergies(const Crossover::Energies& energies) noexcept
+{
+    return { energies[0], energies[1], energies[2] };
+}
 
-        lowEnergy = smooth * lowEnergy + oneMinusSmooth * lowSq;
-        midEnergy = smooth * midEnergy + oneMinusSmooth * midSq;
-        highEnergy = smooth * highEnergy + oneMinusSmooth * highSq;
+const BandAnalyzer3::Crossover& BandAnalyzer3::crossoverFor(double sampleRate) const noexcept
+{
+    if (! juce::exactlyEqual(sampleRate, cachedSampleRate))
+    {
+        prepareCrossover(cachedCrossover, sampleRate);
+        cachedSampleRate = sampleRate;
     }
 
-    output.low = std::sqrt(lowEnergy);
-    output.mid = std::sqrt(midEnergy);
-    output.high = std::sqrt(highEnergy);
-    return output;
+    return cachedCrossover;
 }
 
-float BandAnalyzer3::alphaForCutoff(double cutoffHz, double sampleRate) noexcept
+void StreamingBandAnalyzer3::prepare(int lanes, double sampleRate)
 {
-    const auto clampedRate = juce::jmax(1.0, sampleRate);
-    const auto omega = juce::MathConstants<double>::twoPi * cutoffHz / clampedRate;
-    const auto alpha = 1.0 - std::exp(-omega);
-    return static_cast<float>(juce::jlimit(0.0, 1.0, alpha));
+    BandAnalyzer3::prepareCrossover(crossover, sampleRate);
+    streams.assign(static_cast<size_t>(juce::jmax(1, lanes)), {});
 }
 
-} // namespace wvfrm
+void StreamingBandAnalyzer3::reset() noexcept
+{
+    for (auto& stream : streams)
+        stream.reset();
+}
 
+void StreamingBandAnalyzer3::accumulate(int lane, const float* samples, int numSamples, BandEnergies& sumOfSquares) noexcept
+{
+    if (! juce::isPositiveAndBelow(lane, static_cast<int>(streams.size())))
+        return;
+
+    BandAnalyzer3::Crossover::Energies sums {};
+    crossover.accumulate(streams[static_cast<size_t>(lane)], samples, numSamples, sums);
+
+    sumOfSquares.low += sums[0];
+    sumOfSquares.mid += sums[1];
+    sumOfSquares.high += sums[2];
+}
+
+} // namespace wvfrm
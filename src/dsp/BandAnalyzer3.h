@@ -1,6 +1,9 @@
 ﻿#pragma once
 
 #include "../JuceIncludes.h"
+#include "BandAnalyzer.h"
+
+#include <vector>
 
 namespace wvfrm
 {
@@ -12,16 +15,58 @@ struct BandEnergies
     float high = 0.0f;
 };
 
+// The colour split: BandAnalyzer<3> with crossovers at 200 Hz and 2 kHz. Coefficients are cached
+// for the last sample rate, so one analyzer serves one thread.
 class BandAnalyzer3
 {
 public:
+    using Crossover = BandAnalyzer<3>;
+
+    static constexpr double lowCrossoverHz = 200.0;
+    static constexpr double highCrossoverHz = 2000.0;
+
+    // Segments worth collecting before calling analyzeSegments: the crossover runs this many
+    // side by side.
+    static constexpr int batchSize = Crossover::segmentsPerBatch;
+
     BandEnergies analyzeSegment(const float* samples,
                                 int numSamples,
                                 double sampleRate,
                                 float smoothingAmount) const noexcept;
 
+    // analyzeSegment for each of numSegments segments, run side by side with one segment per
+    // SIMD lane. Segments may differ in length; results match analyzeSegment to rounding.
+    void analyzeSegments(const float* const* segments,
+                         const int* numSamples,
+                         int numSegments,
+                         double sampleRate,
+                         float smoothingAmount,
+                         BandEnergies* results) const noexcept;
+
+    static void prepareCrossover(Crossover& crossover, double sampleRate) noexcept;
+    static BandEnergies toBandEnergies(const Crossover::Energies& energies) noexcept;
+
+private:
+    const Crossover& crossoverFor(double sampleRate) const noexcept;
+
+    mutable double cachedSampleRate = 0.0;
+    mutable Crossover cachedCrossover;
+};
+
+// The same three-band split with filter state that carries on across calls, one stream per lane,
+// so a continuous stream is analysed once instead of re-warming the filters for every segment.
+class StreamingBandAnalyzer3
+{
+public:
+    void prepare(int lanes, double sampleRate);
+    void reset() noexcept;
+
+    // Adds each band's squared output over samples[0, numSamples) to sumOfSquares.
+    void accumulate(int lane, const float* samples, int numSamples, BandEnergies& sumOfSquares) noexcept;
+
 private:
-    static float alphaForCutoff(double cutoffHz, double sampleRate) noexcept;
+    BandAnalyzer3::Crossover crossover;
+    std::vector<BandAnalyzer3::Crossover::Stream> streams;
 };
 
 } // namespace wvfrm
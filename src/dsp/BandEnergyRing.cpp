@@ -0,0 +1,198 @@
+#include "BandEnergyRing.h"
+
+#include "ChannelViews.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace wvfrm
+{
+
+void BandEnergyRing::prepare(int channels, int ringCapacity, double sampleRate)
+{
+    numChannels = juce::jmax(1, channels);
+    numLanes = numChannels + 2;
+    slots = (juce::jmax(1, ringCapacity) >> recordShift) + 2;
+
+    analyzer.prepare(numLanes, sampleRate);
+    prefixSums.assign(static_cast<size_t>(slots) * static_cast<size_t>(numLanes) * 3, 0.0);
+    slotRecord.assign(static_cast<size_t>(slots), -1);
+    pendingSums.assign(static_cast<size_t>(numLanes), BandEnergies {});
+    runningSums.assign(static_cast<size_t>(numLanes) * 3, 0.0);
+    clear();
+}
+
+void BandEnergyRing::clear() noexcept
+{
+    analyzer.reset();
+    std::fill(slotRecord.begin(), slotRecord.end(), -1);
+    std::fill(pendingSums.begin(), pendingSums.end(), BandEnergies {});
+    std::fill(runningSums.begin(), runningSums.end(), 0.0);
+    chainStart = -1;
+    pendingRecord = -1;
+    pendingCount = 0;
+}
+
+bool BandEnergyRing::isPrepared() const noexcept
+{
+    return slots > 0;
+}
+
+void BandEnergyRing::update(const float* const* channelData, int channels, int64_t startSample, int numSamples) noexcept
+{
+    if (slots <= 0 || numSamples <= 0)
+        return;
+
+    channels = juce::jmin(channels, numChannels);
+    if (channels <= 0)
+        return;
+
+    const auto* left = channelData[0];
+    const auto* right = channelData[channels > 1 ? 1 : 0];
+    float mid[samplesPerRecord];
+    float side[samplesPerRecord];
+
+    auto position = startSample;
+    auto offset = 0;
+
+    while (offset < numSamples)
+    {
+        const auto record = position >> recordShift;
+        const auto recordEnd = (record + 1) << recordShift;
+        const auto count = static_cast<int>(juce::jmin<int64_t>(recordEnd - position, numSamples - offset));
+
+        if (record != pendingRecord)
+        {
+            // A gap or a fresh start: whatever was pending can never complete, and a record joined
+            // part-way through ends short of samplesPerRecord, so it is never published. Sums
+            // from before the gap cannot be differenced against those after it.
+            std::fill(pendingSums.begin(), pendingSums.end(), BandEnergies {});
+            pendingRecord = record;
+            pendingCount = 0;
+            chainStart = -1;
+        }
+
+        for (int channel = 0; channel < channels; ++channel)
+            analyzer.accumulate(channel, channelData[channel] + offset, count, pendingSums[static_cast<size_t>(channel)]);
+
+        for (int i = 0; i < count; ++i)
+        {
+            mid[i] = mixForChannelView(ChannelView::mid, left[offset + i], right[offset + i]);
+            side[i] = mixForChannelView(ChannelView::side, left[offset + i], right[offset + i]);
+        }
+
+        analyzer.accumulate(numChannels, mid, count, pendingSums[static_cast<size_t>(numChannels)]);
+        analyzer.accumulate(numChannels + 1, side, count, pendingSums[static_cast<size_t>(numChannels + 1)]);
+
+        pendingCount += count;
+        position += count;
+        offset += count;
+
+        if (position == recordEnd)
+        {
+            const auto slot = static_cast<size_t>(record % slots);
+
+            if (pendingCount == samplesPerRecord)
+            {
+                // Rebase at the start of every lap and of every unbroken run.
+                if (chainStart < 0 || slot == 0)
+                    std::fill(runningSums.begin(), runningSums.end(), 0.0);
+
+                if (chainStart < 0)
+                    chainStart = record;
+
+                auto* out = prefixSums.data() + slot * static_cast<size_t>(numLanes) * 3;
+
+                for (int lane = 0; lane < numLanes; ++lane)
+                {
+                    const auto& sums = pendingSums[static_cast<size_t>(lane)];
+                    auto* running = runningSums.data() + lane * 3;
+                    running[0] += static_cast<double>(sums.low);
+                    running[1] += static_cast<double>(sums.mid);
+                    running[2] += static_cast<double>(sums.high);
+                    std::copy(running, running + 3, out + lane * 3);
+                }
+
+                slotRecord[slot] = record;
+            }
+            else
+            {
+                slotRecord[slot] = -1;
+                chainStart = -1;
+            }
+
+            std::fill(pendingSums.begin(), pendingSums.end(), BandEnergies {});
+            pendingRecord = record + 1;
+            pendingCount = 0;
+        }
+    }
+}
+
+bool BandEnergyRing::read(Lane lane, int channel, int64_t firstRecord, int64_t endRecord, BandEnergies& result) const noexcept
+{
+    // The record before firstRecord has to be held too, so a span can reach slots - 1 records.
+    if (slots <= 0 || chainStart < 0 || firstRecord < chainStart || endRecord <= firstRecord
+        || endRecord - firstRecord >= slots)
+        return false;
+
+    const auto index = laneIndex(lane, channel);
+    const auto lastRecord = endRecord - 1;
+    const auto firstLap = firstRecord / slots;
+    const auto lastLap = lastRecord / slots;
+
+    const auto* last = entry(lastRecord, index);
+    if (last == nullptr || lastLap - firstLap > 1)
+        return false;
+
+    double sums[3] { last[0], last[1], last[2] };
+
+    if (lastLap != firstLap)
+    {
+        // The span crosses a rebase: add everything the previous lap summed up to its end.
+        const auto* lapEnd = entry(lastLap * slots - 1, index);
+        if (lapEnd == nullptr)
+            return false;
+
+        for (int band = 0; band < 3; ++band)
+            sums[band] += lapEnd[band];
+    }
+
+    // Sums restart at zero at a lap start and at the start of the run, so nothing to subtract.
+    if (firstRecord != chainStart && firstRecord % slots != 0)
+    {
+        const auto* before = entry(firstRecord - 1, index);
+        if (before == nullptr)
+            return false;
+
+        for (int band = 0; band < 3; ++band)
+            sums[band] -= before[band];
+    }
+
+    const auto numSamples = static_cast<double>((endRecord - firstRecord) * samplesPerRecord);
+    result.low = static_cast<float>(std::sqrt(juce::jmax(0.0, sums[0]) / numSamples));
+    result.mid = static_cast<float>(std::sqrt(juce::jmax(0.0, sums[1]) / numSamples));
+    result.high = static_cast<float>(std::sqrt(juce::jmax(0.0, sums[2]) / numSamples));
+    return true;
+}
+
+const double* BandEnergyRing::entry(int64_t record, int lane) const noexcept
+{
+    const auto slot = static_cast<size_t>(record % slots);
+    if (record < 0 || slotRecord[slot] != record)
+        return nullptr;
+
+    return prefixSums.data() + (slot * static_cast<size_t>(numLanes) + static_cast<size_t>(lane)) * 3;
+}
+
+int BandEnergyRing::laneIndex(Lane lane, int channel) const noexcept
+{
+    switch (lane)
+    {
+        case Lane::mid: return numChannels;
+        case Lane::side: return numChannels + 1;
+        case Lane::channel:
+        default: return juce::jlimit(0, numChannels - 1, channel);
+    }
+}
+
+} // namespace wvfrm
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+
+#include <vector>
+
+#include "BandAnalyzer3.h"
+
+namespace wvfrm
+{
+
+// Low/mid/high band energies, computed while the samples are written and indexed by the same
+// absolute positions as the ring that owns it. Each record of samplesPerRecord samples stores
+// the running sum of squared band output up to its end, so the energy of any span of records
+// is the difference of two entries whatever its length. Sums restart at every lap of the
+// slots, which keeps them small enough for double precision to resolve quiet passages after
+// hours of audio; a span crossing one restart adds the previous lap's last entry, which is
+// still held. Lanes are the stored channels plus mid and side of the first two. Not
+// synchronised itself: the owning ring writes it inside its seqlock and readers validate the
+// same way.
+class BandEnergyRing
+{
+public:
+    enum class Lane
+    {
+        channel,
+        mid,
+        side
+    };
+
+    static constexpr int recordShift = 6;
+    static constexpr int samplesPerRecord = 1 << recordShift;
+
+    void prepare(int channels, int ringCapacity, double sampleRate);
+    void clear() noexcept;
+    bool isPrepared() const noexcept;
+
+    void update(const float* const* channelData, int channels, int64_t startSample, int numSamples) noexcept;
+
+    // RMS band levels over records [firstRecord, endRecord) in constant time; false unless the
+    // span and the record before it are held and were written without a break.
+    bool read(Lane lane, int channel, int64_t firstRecord, int64_t endRecord, BandEnergies& energies) const noexcept;
+
+private:
+    int laneIndex(Lane lane, int channel) const noexcept;
+    const double* entry(int64_t record, int lane) const noexcept;
+
+    StreamingBandAnalyzer3 analyzer;
+    int numChannels = 0;
+    int numLanes = 0;
+    int slots = 0;
+
+    // [slot][lane] triples of low/mid/high running sums; slotRecord says which record a slot
+    // holds (-1: none). Records from chainStart on were written without a break.
+    std::vector<double> prefixSums;
+    std::vector<int64_t> slotRecord;
+    int64_t chainStart = -1;
+
+    std::vector<BandEnergies> pendingSums;
+    std::vector<double> runningSums;
+    int64_t pendingRecord = -1;
+    int pendingCount = 0;
+};
+
+} // namespace wvfrm
@@ -0,0 +1,287 @@
+#include "BlockSummary.h"
+
+#include "ChannelViews.h"
+
+#include <cmath>
+#include <limits>
+
+namespace wvfrm
+{
+
+void BlockSummarizer::prepare(int samplesPerSummaryToUse) noexcept
+{
+    samplesPerSummary = juce::jmax(1, samplesPerSummaryToUse);
+    reset();
+}
+
+void BlockSummarizer::reset() noexcept
+{
+    pending = {};
+    expectedNextSample = -1;
+
+    for (auto& sum : sumSquares)
+        sum = 0.0;
+}
+
+int BlockSummarizer::process(const juce::AudioBuffer<float>& buffer,
+                             int64_t blockStartSample,
+                             double phaseAtBlockStart,
+                             double phasePerSample,
+                             BlockSummaryQueue& queue) noexcept
+{
+    return process(buffer.getArrayOfReadPointers(),
+                   buffer.getNumChannels(),
+                   buffer.getNumSamples(),
+                   blockStartSample,
+                   phaseAtBlockStart,
+                   phasePerSample,
+                   queue);
+}
+
+int BlockSummarizer::process(const float* const* channelData,
+                             int numChannels,
+                             int numSamples,
+                             int64_t blockStartSample,
+                             double phaseAtBlockStart,
+                             double phasePerSample,
+                             BlockSummaryQueue& queue,
+                             const float* const* envelopeMinimum,
+                             const float* const* envelopeMaximum,
+                             const float* const* derivedMinimum,
+                             const float* const* derivedMaximum) noexcept
+{
+    const auto channels = juce::jmin(numChannels, BlockSummary::maxChannels);
+    const auto hasEnvelope = envelopeMinimum != nullptr && envelopeMaximum != nullptr;
+    const auto hasDerivedEnvelope = hasEnvelope && derivedMinimum != nullptr && derivedMaximum != nullptr;
+
+    if (numSamples <= 0 || channels <= 0)
+        return 0;
+
+    // A jump in the sample counter (transport reset, re-prepare) strands the pending record.
+    if (blockStartSample != expectedNextSample || pending.numChannels != channels)
+        pending.numSamples = 0;
+
+    const auto* left = channelData[0];
+    const auto* right = channelData[channels > 1 ? 1 : 0];
+
+    auto dropped = 0;
+    auto offset = 0;
+
+    while (offset < numSamples)
+    {
+        const auto position = blockStartSample + offset;
+
+        if (pending.numSamples == 0)
+            beginRecord(position, phaseAtBlockStart + phasePerSample * static_cast<double>(offset), channels);
+
+        // Records end on multiples of samplesPerSummary so consumers can index them by position.
+        const auto recordEnd = (pending.startSample / samplesPerSummary + 1) * samplesPerSummary;
+        const auto count = static_cast<int>(juce::jmin<int64_t>(recordEnd - position, numSamples - offset));
+
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            const auto* data = channelData[channel] + offset;
+
+            if (hasEnvelope)
+            {
+                pending.minimum[channel] = juce::jmin(pending.minimum[channel],
+                                                      juce::FloatVectorOperations::findMinimum(envelopeMinimum[channel] + offset, count));
+                pending.maximum[channel] = juce::jmax(pending.maximum[channel],
+                                                      juce::FloatVectorOperations::findMaximum(envelopeMaximum[channel] + offset, count));
+            }
+            else
+            {
+                const auto range = juce::FloatVectorOperations::findMinAndMax(data, count);
+                pending.minimum[channel] = juce::jmin(pending.minimum[channel], range.getStart());
+                pending.maximum[channel] = juce::jmax(pending.maximum[channel], range.getEnd());
+            }
+
+            auto sum = 0.0;
+            for (int s = 0; s < count; ++s)
+                sum += static_cast<double>(data[s]) * static_cast<double>(data[s]);
+
+            sumSquares[channel] += sum;
+        }
+
+        if (hasDerivedEnvelope)
+        {
+            pending.midMinimum = juce::jmin(pending.midMinimum,
+                                            juce::FloatVectorOperations::findMinimum(derivedMinimum[0] + offset, count));
+            pending.midMaximum = juce::jmax(pending.midMaximum,
+                                            juce::FloatVectorOperations::findMaximum(derivedMaximum[0] + offset, count));
+            pending.sideMinimum = juce::jmin(pending.sideMinimum,
+                                             juce::FloatVectorOperations::findMinimum(derivedMinimum[1] + offset, count));
+            pending.sideMaximum = juce::jmax(pending.sideMaximum,
+                                             juce::FloatVectorOperations::findMaximum(derivedMaximum[1] + offset, count));
+        }
+        else
+        {
+            for (int s = offset; s < offset + count; ++s)
+            {
+                const auto mid = mixForChannelView(ChannelView::mid, left[s], right[s]);
+                const auto side = mixForChannelView(ChannelView::side, left[s], right[s]);
+                pending.midMinimum = juce::jmin(pending.midMinimum, mid);
+                pending.midMaximum = juce::jmax(pending.midMaximum, mid);
+                pending.sideMinimum = juce::jmin(pending.sideMinimum, side);
+                pending.sideMaximum = juce::jmax(pending.sideMaximum, side);
+            }
+        }
+
+        pending.numSamples += count;
+        offset += count;
+
+        if (pending.startSample + pending.numSamples == recordEnd)
+        {
+            for (int channel = 0; channel < channels; ++channel)
+                pending.rms[channel] = static_cast<float>(std::sqrt(sumSquares[channel] / pending.numSamples));
+
+            if (! queue.push(pending))
+                ++dropped;
+
+            pending.numSamples = 0;
+        }
+    }
+
+    expectedNextSample = blockStartSample + numSamples;
+    return dropped;
+}
+
+int BlockSummarizer::getSamplesPerSummary() const noexcept
+{
+    return samplesPerSummary;
+}
+
+void BlockSummarizer::beginRecord(int64_t startSample, double phase, int numChannels) noexcept
+{
+    constexpr auto lowest = -std::numeric_limits<float>::max();
+    constexpr auto highest = std::numeric_limits<float>::max();
+
+    pending.startSample = startSample;
+    pending.numSamples = 0;
+    pending.numChannels = numChannels;
+    pending.phase = static_cast<float>(phase - std::floor(phase));
+
+    for (int channel = 0; channel < BlockSummary::maxChannels; ++channel)
+    {
+        pending.minimum[channel] = highest;
+        pending.maximum[channel] = lowest;
+        pending.rms[channel] = 0.0f;
+        sumSquares[channel] = 0.0;
+    }
+
+    pending.midMinimum = highest;
+    pending.midMaximum = lowest;
+    pending.sideMinimum = highest;
+    pending.sideMaximum = lowest;
+}
+
+void BlockSummaryHistory::prepare(int capacityRecords, int samplesPerSummaryToUse)
+{
+    records.assign(static_cast<size_t>(juce::jmax(1, capacityRecords)), BlockSummary {});
+    samplesPerSummary = juce::jmax(1, samplesPerSummaryToUse);
+    clear();
+}
+
+void BlockSummaryHistory::clear() noexcept
+{
+    firstRecord = 0;
+    endRecord = 0;
+}
+
+void BlockSummaryHistory::append(const BlockSummary& summary) noexcept
+{
+    if (records.empty())
+        return;
+
+    const auto index = summary.startSample / samplesPerSummary;
+    const auto capacity = static_cast<int64_t>(records.size());
+
+    // Anything but the next record means the producer restarted or dropped records; start over.
+    if (index != endRecord || firstRecord == endRecord)
+        firstRecord = index;
+
+    records[static_cast<size_t>(index % capacity)] = summary;
+    endRecord = index + 1;
+    firstRecord = juce::jmax(firstRecord, endRecord - capacity);
+}
+
+int BlockSummaryHistory::drain(BlockSummaryQueue& queue) noexcept
+{
+    auto drained = 0;
+    BlockSummary summary;
+
+    while (queue.pop(summary))
+    {
+        append(summary);
+        ++drained;
+    }
+
+    return drained;
+}
+
+bool BlockSummaryHistory::getRange(Lane lane,
+                                   int channel,
+                                   int64_t startSample,
+                                   int64_t endSample,
+                                   float& minimum,
+                                   float& maximum) const noexcept
+{
+    if (endSample <= startSample || firstRecord == endRecord)
+        return false;
+
+    const auto first = startSample / samplesPerSummary;
+    const auto last = (endSample - 1) / samplesPerSummary;
+    const auto capacity = static_cast<int64_t>(records.size());
+
+    if (startSample < 0 || first < firstRecord || last >= endRecord)
+        return false;
+
+    // The oldest record may be a partial one started mid-slot after a restart.
+    if (records[static_cast<size_t>(firstRecord % capacity)].startSample > startSample)
+        return false;
+
+    auto lo = std::numeric_limits<float>::max();
+    auto hi = -std::numeric_limits<float>::max();
+
+    for (auto index = first; index <= last; ++index)
+    {
+        const auto& record = records[static_cast<size_t>(index % capacity)];
+
+        switch (lane)
+        {
+            case Lane::channel:
+                if (channel < 0 || channel >= record.numChannels)
+                    return false;
+
+                lo = juce::jmin(lo, record.minimum[channel]);
+                hi = juce::jmax(hi, record.maximum[channel]);
+                break;
+
+            case Lane::mid:
+                lo = juce::jmin(lo, record.midMinimum);
+                hi = juce::jmax(hi, record.midMaximum);
+                break;
+
+            case Lane::side:
+                lo = juce::jmin(lo, record.sideMinimum);
+                hi = juce::jmax(hi, record.sideMaximum);
+                break;
+        }
+    }
+
+    minimum = lo;
+    maximum = hi;
+    return true;
+}
+
+int BlockSummaryHistory::getSamplesPerSummary() const noexcept
+{
+    return samplesPerSummary;
+}
+
+int BlockSummaryHistory::getCapacityRecords() const noexcept
+{
+    return static_cast<int>(records.size());
+}
+
+} // namespace wvfrm
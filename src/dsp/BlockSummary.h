@@ -0,0 +1,112 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+
+#include <vector>
+
+#include "SpscQueue.h"
+
+namespace wvfrm
+{
+
+// Fixed-size digest of samplesPerSummary consecutive input samples, produced on the audio thread.
+struct BlockSummary
+{
+    // Enough for 9.1.6; the capture path accepts no wider bus.
+    static constexpr int maxChannels = 16;
+
+    int64_t startSample = 0;
+    int numSamples = 0;
+    int numChannels = 0;
+    float phase = 0.0f;
+
+    float minimum[maxChannels] {};
+    float maximum[maxChannels] {};
+    float rms[maxChannels] {};
+
+    // Mid (also mono) and side of the first two channels, so derived views need no raw audio.
+    float midMinimum = 0.0f;
+    float midMaximum = 0.0f;
+    float sideMinimum = 0.0f;
+    float sideMaximum = 0.0f;
+};
+
+using BlockSummaryQueue = SpscQueue<BlockSummary>;
+
+class BlockSummarizer
+{
+public:
+    static constexpr int defaultSamplesPerSummary = 64;
+
+    void prepare(int samplesPerSummaryToUse) noexcept;
+    void reset() noexcept;
+
+    // Returns the number of finished records that did not fit into the queue.
+    int process(const juce::AudioBuffer<float>& buffer,
+                int64_t blockStartSample,
+                double phaseAtBlockStart,
+                double phasePerSample,
+                BlockSummaryQueue& queue) noexcept;
+
+    // Raw-pointer form. When envelope pointers are given (a decimated stream), channel min/max
+    // come from them, and mid/side min/max from the derived envelopes (mid, then side) when
+    // those are given too; rms still comes from channelData.
+    int process(const float* const* channelData,
+                int numChannels,
+                int numSamples,
+                int64_t blockStartSample,
+                double phaseAtBlockStart,
+                double phasePerSample,
+                BlockSummaryQueue& queue,
+                const float* const* envelopeMinimum = nullptr,
+                const float* const* envelopeMaximum = nullptr,
+                const float* const* derivedMinimum = nullptr,
+                const float* const* derivedMaximum = nullptr) noexcept;
+
+    int getSamplesPerSummary() const noexcept;
+
+private:
+    void beginRecord(int64_t startSample, double phase, int numChannels) noexcept;
+
+    BlockSummary pending;
+    double sumSquares[BlockSummary::maxChannels] {};
+    int samplesPerSummary = defaultSamplesPerSummary;
+    int64_t expectedNextSample = -1;
+};
+
+// Consumer-side history of summaries, indexed by absolute sample position.
+class BlockSummaryHistory
+{
+public:
+    enum class Lane
+    {
+        channel,
+        mid,
+        side
+    };
+
+    void prepare(int capacityRecords, int samplesPerSummaryToUse);
+    void clear() noexcept;
+
+    void append(const BlockSummary& summary) noexcept;
+    int drain(BlockSummaryQueue& queue) noexcept;
+
+    // Min/max over the records overlapping [startSample, endSample); false unless all are held.
+    bool getRange(Lane lane,
+                  int channel,
+                  int64_t startSample,
+                  int64_t endSample,
+                  float& minimum,
+                  float& maximum) const noexcept;
+
+    int getSamplesPerSummary() const noexcept;
+    int getCapacityRecords() const noexcept;
+
+private:
+    std::vector<BlockSummary> records;
+    int samplesPerSummary = BlockSummarizer::defaultSamplesPerSummary;
+    int64_t firstRecord = 0;
+    int64_t endRecord = 0;
+};
+
+} // namespace wvfrm
@@ -0,0 +1,378 @@
+#include "HalfBandDecimator.h"
+
+#include "ChannelViews.h"
+
+#include <cmath>
+#include <limits>
+
+namespace wvfrm
+{
+
+namespace
+{
+constexpr int centreTap = HalfBandDecimator::tapsPerStage / 2;
+constexpr int historySamples = HalfBandDecimator::tapsPerStage - 1;
+constexpr int maximumEnvelopeDelay = 16;
+
+int envelopeDelayFor(int stages) noexcept
+{
+    // Output k of the cascade is centred latency input samples before its group ends.
+    const auto factor = 1 << stages;
+    const auto latency = centreTap * (factor - 1);
+    return juce::jlimit(0, maximumEnvelopeDelay, static_cast<int>(std::lround(static_cast<double>(latency) / factor)));
+}
+} // namespace
+
+int HalfBandDecimator::stagesForRate(double sampleRate, double maximumAnalysisRate) noexcept
+{
+    auto stageCount = 0;
+
+    while (sampleRate > maximumAnalysisRate && stageCount < maximumStages)
+    {
+        sampleRate *= 0.5;
+        ++stageCount;
+    }
+
+    return stageCount;
+}
+
+void HalfBandDecimator::prepare(int channels, int maximumBlockSize)
+{
+    numChannels = juce::jmax(1, channels);
+    maximumBlock = juce::jmax(2, maximumBlockSize);
+
+    // Blackman-windowed half-band: every even offset from the centre is zero, so only the centre
+    // tap and the odd offsets are stored, and each is applied to a symmetric pair.
+    auto sum = 0.0;
+    for (size_t i = 0; i < oddTaps.size(); ++i)
+    {
+        const auto offset = static_cast<double>(2 * i + 1);
+        const auto n = static_cast<double>(centreTap) + offset;
+        const auto phase = juce::MathConstants<double>::twoPi * n / static_cast<double>(tapsPerStage - 1);
+        const auto window = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+        const auto ideal = std::sin(juce::MathConstants<double>::halfPi * offset) / (juce::MathConstants<double>::pi * offset);
+        oddTaps[i] = static_cast<float>(ideal * window);
+        sum += ideal * window;
+    }
+
+    // Unity gain at DC: centre 0.5 plus both sides of the odd taps.
+    for (auto& tap : oddTaps)
+        tap = static_cast<float>(tap * 0.25 / sum);
+
+    const auto lineLength = static_cast<size_t>(historySamples + maximumBlock);
+    const auto outputLength = static_cast<size_t>(maximumBlock / 2 + 1);
+
+    for (auto& stage : stages)
+        stage.lines.assign(static_cast<size_t>(numChannels), std::vector<float>(lineLength, 0.0f));
+
+    for (int buffer = 0; buffer < 2; ++buffer)
+    {
+        stageOutput[buffer].assign(static_cast<size_t>(numChannels), std::vector<float>(outputLength, 0.0f));
+        stageOutputPointers[buffer].clear();
+        stageWritePointers[buffer].clear();
+
+        for (auto& channel : stageOutput[buffer])
+        {
+            stageOutputPointers[buffer].push_back(channel.data());
+            stageWritePointers[buffer].push_back(channel.data());
+        }
+    }
+
+    outputPointers.assign(static_cast<size_t>(numChannels), nullptr);
+
+    const auto lanes = static_cast<size_t>(numChannels + numDerived);
+    groupMinimum.assign(lanes, 0.0f);
+    groupMaximum.assign(lanes, 0.0f);
+    envelopeDelayMinimum.assign(lanes, std::vector<float>(maximumEnvelopeDelay, 0.0f));
+    envelopeDelayMaximum.assign(lanes, std::vector<float>(maximumEnvelopeDelay, 0.0f));
+    envelopeMinimum.assign(lanes, std::vector<float>(outputLength, 0.0f));
+    envelopeMaximum.assign(lanes, std::vector<float>(outputLength, 0.0f));
+
+    for (int derived = 0; derived < numDerived; ++derived)
+    {
+        const auto index = static_cast<size_t>(derived);
+        derivedInput[index].assign(static_cast<size_t>(maximumBlock), 0.0f);
+        derivedFiltered[index].assign(outputLength, 0.0f);
+        derivedMinimumPointers[index] = derivedInput[index].data();
+        derivedMaximumPointers[index] = derivedInput[index].data();
+    }
+
+    envelopeMinimumPointers.clear();
+    envelopeMaximumPointers.clear();
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        envelopeMinimumPointers.push_back(envelopeMinimum[static_cast<size_t>(channel)].data());
+        envelopeMaximumPointers.push_back(envelopeMaximum[static_cast<size_t>(channel)].data());
+    }
+
+    reset();
+}
+
+void HalfBandDecimator::reset() noexcept
+{
+    for (auto& stage : stages)
+    {
+        for (auto& line : stage.lines)
+            std::fill(line.begin(), line.end(), 0.0f);
+
+        stage.inputParity = 0;
+    }
+
+    std::fill(groupMinimum.begin(), groupMinimum.end(), std::numeric_limits<float>::max());
+    std::fill(groupMaximum.begin(), groupMaximum.end(), -std::numeric_limits<float>::max());
+    groupFill = 0;
+    delayIndex = 0;
+
+    for (auto& line : envelopeDelayMinimum)
+        std::fill(line.begin(), line.end(), 0.0f);
+
+    for (auto& line : envelopeDelayMaximum)
+        std::fill(line.begin(), line.end(), 0.0f);
+}
+
+void HalfBandDecimator::setNumStages(int stagesToUse) noexcept
+{
+    stagesToUse = juce::jlimit(0, maximumStages, stagesToUse);
+    if (stagesToUse == numStages)
+        return;
+
+    numStages = stagesToUse;
+    envelopeDelay = envelopeDelayFor(numStages);
+    reset();
+}
+
+int HalfBandDecimator::getNumStages() const noexcept
+{
+    return numStages;
+}
+
+int HalfBandDecimator::getFactor() const noexcept
+{
+    return 1 << numStages;
+}
+
+int HalfBandDecimator::getMaximumBlockSize() const noexcept
+{
+    return maximumBlock;
+}
+
+int HalfBandDecimator::getLatencySamples() const noexcept
+{
+    return centreTap * (getFactor() - 1);
+}
+
+int HalfBandDecimator::process(const float* const* input, int channels, int numSamples) noexcept
+{
+    channels = juce::jmin(channels, numChannels);
+    numSamples = juce::jlimit(0, maximumBlock, numSamples);
+
+    auto* mid = derivedInput[derivedMid].data();
+    auto* side = derivedInput[derivedSide].data();
+
+    if (channels > 0)
+    {
+        const auto* left = input[0];
+        const auto* right = input[channels > 1 ? 1 : 0];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            mid[i] = mixForChannelView(ChannelView::mid, left[i], right[i]);
+            side[i] = mixForChannelView(ChannelView::side, left[i], right[i]);
+        }
+    }
+
+    if (numStages == 0)
+    {
+        // Nothing to reduce: the input is its own output and envelope.
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            outputPointers[static_cast<size_t>(channel)] = input[channel];
+            envelopeMinimumPointers[static_cast<size_t>(channel)] = input[channel];
+            envelopeMaximumPointers[static_cast<size_t>(channel)] = input[channel];
+        }
+
+        for (int derived = 0; derived < numDerived; ++derived)
+        {
+            const auto index = static_cast<size_t>(derived);
+            derivedMinimumPointers[index] = derivedInput[index].data();
+            derivedMaximumPointers[index] = derivedInput[index].data();
+        }
+
+        return numSamples;
+    }
+
+    const float* const* stageInput = input;
+    auto produced = numSamples;
+
+    for (int s = 0; s < numStages; ++s)
+    {
+        const auto target = s & 1;
+        produced = runStage(stages[static_cast<size_t>(s)], stageInput, stageWritePointers[target].data(), channels, produced);
+        stageInput = stageOutputPointers[target].data();
+    }
+
+    // The filters are linear, so the derived signals of the filtered channels are the filtered
+    // derived signals.
+    if (channels > 0)
+    {
+        const auto* left = stageInput[0];
+        const auto* right = stageInput[channels > 1 ? 1 : 0];
+
+        for (int i = 0; i < produced; ++i)
+        {
+            derivedFiltered[derivedMid][static_cast<size_t>(i)] = mixForChannelView(ChannelView::mid, left[i], right[i]);
+            derivedFiltered[derivedSide][static_cast<size_t>(i)] = mixForChannelView(ChannelView::side, left[i], right[i]);
+        }
+    }
+
+    auto fill = groupFill;
+    auto position = delayIndex;
+
+    for (int channel = 0; channel < channels; ++channel)
+        runEnvelope(channel, input[channel], stageInput[channel], numSamples, fill, position);
+
+    for (int derived = 0; derived < numDerived; ++derived)
+    {
+        const auto index = static_cast<size_t>(derived);
+        runEnvelope(numChannels + derived, derivedInput[index].data(), derivedFiltered[index].data(), numSamples, fill, position);
+    }
+
+    groupFill = fill;
+    delayIndex = position;
+
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        const auto index = static_cast<size_t>(channel);
+        outputPointers[index] = stageInput[channel];
+        envelopeMinimumPointers[index] = envelopeMinimum[index].data();
+        envelopeMaximumPointers[index] = envelopeMaximum[index].data();
+    }
+
+    for (int derived = 0; derived < numDerived; ++derived)
+    {
+        const auto lane = static_cast<size_t>(numChannels + derived);
+        derivedMinimumPointers[static_cast<size_t>(derived)] = envelopeMinimum[lane].data();
+        derivedMaximumPointers[static_cast<size_t>(derived)] = envelopeMaximum[lane].data();
+    }
+
+    return produced;
+}
+
+void HalfBandDecimator::runEnvelope(int lane,
+                                    const float* samples,
+                                    const float* filtered,
+                                    int numSamples,
+                                    int& fill,
+                                    int& position) noexcept
+{
+    // Every lane starts from the shared group position and ends on the same one.
+    const auto index = static_cast<size_t>(lane);
+    const auto factor = getFactor();
+    auto* delayMinimum = envelopeDelayMinimum[index].data();
+    auto* delayMaximum = envelopeDelayMaximum[index].data();
+    auto* outMinimum = envelopeMinimum[index].data();
+    auto* outMaximum = envelopeMaximum[index].data();
+
+    auto minimum = groupMinimum[index];
+    auto maximum = groupMaximum[index];
+    fill = groupFill;
+    position = delayIndex;
+    auto written = 0;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        minimum = juce::jmin(minimum, samples[i]);
+        maximum = juce::jmax(maximum, samples[i]);
+
+        if (++fill < factor)
+            continue;
+
+        auto delayedMinimum = minimum;
+        auto delayedMaximum = maximum;
+
+        if (envelopeDelay > 0)
+        {
+            delayedMinimum = delayMinimum[position];
+            delayedMaximum = delayMaximum[position];
+            delayMinimum[position] = minimum;
+            delayMaximum[position] = maximum;
+            position = position + 1 == envelopeDelay ? 0 : position + 1;
+        }
+
+        // Filter ringing can overshoot the raw peaks; the envelope must still contain it.
+        outMinimum[written] = juce::jmin(delayedMinimum, filtered[written]);
+        outMaximum[written] = juce::jmax(delayedMaximum, filtered[written]);
+        ++written;
+
+        minimum = std::numeric_limits<float>::max();
+        maximum = -std::numeric_limits<float>::max();
+        fill = 0;
+    }
+
+    groupMinimum[index] = minimum;
+    groupMaximum[index] = maximum;
+}
+
+const float* const* HalfBandDecimator::getOutput() const noexcept
+{
+    return outputPointers.data();
+}
+
+const float* const* HalfBandDecimator::getEnvelopeMinimum() const noexcept
+{
+    return envelopeMinimumPointers.data();
+}
+
+const float* const* HalfBandDecimator::getEnvelopeMaximum() const noexcept
+{
+    return envelopeMaximumPointers.data();
+}
+
+const float* const* HalfBandDecimator::getDerivedEnvelopeMinimum() const noexcept
+{
+    return derivedMinimumPointers.data();
+}
+
+const float* const* HalfBandDecimator::getDerivedEnvelopeMaximum() const noexcept
+{
+    return derivedMaximumPointers.data();
+}
+
+int HalfBandDecimator::runStage(Stage& stage, const float* const* input, float* const* output, int channels, int numSamples) noexcept
+{
+    // An output completes on every second input, counting across calls.
+    const auto first = stage.inputParity == 1 ? 0 : 1;
+    auto produced = 0;
+
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        auto* line = stage.lines[static_cast<size_t>(channel)].data();
+        std::copy(input[channel], input[channel] + numSamples, line + historySamples);
+
+        auto* out = output[channel];
+        auto written = 0;
+
+        for (int i = first; i < numSamples; i += 2)
+        {
+            // line[i + historySamples] is the newest input; the centre tap is centreTap before it.
+            const auto* centre = line + i + historySamples - centreTap;
+            auto sum = 0.5f * centre[0];
+
+            for (size_t t = 0; t < oddTaps.size(); ++t)
+            {
+                const auto offset = static_cast<int>(2 * t + 1);
+                sum += oddTaps[t] * (centre[-offset] + centre[offset]);
+            }
+
+            out[written++] = sum;
+        }
+
+        std::copy(line + numSamples, line + numSamples + historySamples, line);
+        produced = written;
+    }
+
+    stage.inputParity = (stage.inputParity + numSamples) & 1;
+    return produced;
+}
+
+} // namespace wvfrm
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+
+#include <array>
+#include <vector>
+
+namespace wvfrm
+{
+
+// Cascade of 2:1 polyphase half-band FIR stages that brings the capture stream down to a
+// display rate, plus a min/max envelope of the original samples so decimation never hides a
+// peak. Every output sample i covers input samples [i * factor, (i + 1) * factor); the
+// envelope is delayed to line up with the filtered output and always contains it. Mid (also
+// mono) and side of the first two channels get envelopes of their own, taken from the original
+// samples as well, since one from the channel envelopes would pair peaks that never coincided.
+class HalfBandDecimator
+{
+public:
+    static constexpr int maximumStages = 4;
+    static constexpr int tapsPerStage = 31;
+
+    // Lanes of the derived envelopes.
+    static constexpr int derivedMid = 0;
+    static constexpr int derivedSide = 1;
+    static constexpr int numDerived = 2;
+
+    // Fewest stages that bring sampleRate down to maximumAnalysisRate or below.
+    static int stagesForRate(double sampleRate, double maximumAnalysisRate = 32000.0) noexcept;
+
+    // Allocates for up to maximumStages so the stage count can change later without allocating.
+    void prepare(int channels, int maximumBlockSize);
+    void reset() noexcept;
+
+    // Audio thread. Changing the count restarts the filters.
+    void setNumStages(int stages) noexcept;
+    int getNumStages() const noexcept;
+    int getFactor() const noexcept;
+    int getMaximumBlockSize() const noexcept;
+
+    // Group delay of the cascade, in input samples.
+    int getLatencySamples() const noexcept;
+
+    // numSamples must not exceed getMaximumBlockSize(). Returns how many output samples the
+    // block completed; they stay readable until the next call.
+    int process(const float* const* input, int channels, int numSamples) noexcept;
+
+    const float* const* getOutput() const noexcept;
+    const float* const* getEnvelopeMinimum() const noexcept;
+    const float* const* getEnvelopeMaximum() const noexcept;
+    const float* const* getDerivedEnvelopeMinimum() const noexcept;
+    const float* const* getDerivedEnvelopeMaximum() const noexcept;
+
+private:
+    struct Stage
+    {
+        // Per channel: tapsPerStage - 1 samples of history followed by the incoming block.
+        std::vector<std::vector<float>> lines;
+        int inputParity = 0;
+    };
+
+    int runStage(Stage& stage, const float* const* input, float* const* output, int channels, int numSamples) noexcept;
+    void runEnvelope(int lane, const float* samples, const float* filtered, int numSamples, int& fill, int& position) noexcept;
+
+    std::array<float, tapsPerStage / 4 + 1> oddTaps {};
+    std::array<Stage, maximumStages> stages;
+    int numStages = 0;
+    int numChannels = 0;
+    int maximumBlock = 0;
+
+    std::vector<std::vector<float>> stageOutput[2];
+    std::vector<const float*> stageOutputPointers[2];
+    std::vector<float*> stageWritePointers[2];
+    std::vector<const float*> outputPointers;
+
+    // Envelope: running min/max of the current input group, then a delay line in output samples.
+    // Lanes are the channels followed by the derived signals.
+    std::vector<float> groupMinimum;
+    std::vector<float> groupMaximum;
+    int groupFill = 0;
+    std::vector<std::vector<float>> envelopeDelayMinimum;
+    std::vector<std::vector<float>> envelopeDelayMaximum;
+    int envelopeDelay = 0;
+    int delayIndex = 0;
+    std::vector<std::vector<float>> envelopeMinimum;
+    std::vector<std::vector<float>> envelopeMaximum;
+    std::vector<const float*> envelopeMinimumPointers;
+    std::vector<const float*> envelopeMaximumPointers;
+
+    // Derived signals at the input rate and after filtering, then their envelopes.
+    std::array<std::vector<float>, numDerived> derivedInput;
+    std::array<std::vector<float>, numDerived> derivedFiltered;
+    std::array<const float*, numDerived> derivedMinimumPointers {};
+    std::array<const float*, numDerived> derivedMaximumPointers {};
+};
+
+} // namespace wvfrm
@@ -0,0 +1,189 @@
+#include "PeakPyramid.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace wvfrm
+{
+
+void PeakPyramid::prepare(int channels, int ringCapacity)
+{
+    numChannels = juce::jmax(1, channels);
+    levels.clear();
+
+    for (int shift = baseLevelShift; shift < 31 && (1 << shift) <= ringCapacity; ++shift)
+    {
+        Level level;
+        level.shift = shift;
+        level.slots = (ringCapacity >> shift) + 2;
+        level.minimum.assign(static_cast<size_t>(numChannels * level.slots), 0.0f);
+        level.maximum.assign(static_cast<size_t>(numChannels * level.slots), 0.0f);
+        levels.push_back(std::move(level));
+    }
+
+    carryMinimum.assign(static_cast<size_t>(numChannels), 0.0f);
+    carryMaximum.assign(static_cast<size_t>(numChannels), 0.0f);
+    resetCarry();
+}
+
+void PeakPyramid::clear() noexcept
+{
+    for (auto& level : levels)
+    {
+        std::fill(level.minimum.begin(), level.minimum.end(), 0.0f);
+        std::fill(level.maximum.begin(), level.maximum.end(), 0.0f);
+    }
+
+    resetCarry();
+}
+
+void PeakPyramid::update(const float* const* channelData, int channels, int64_t startSample, int numSamples) noexcept
+{
+    update(channelData, channelData, channels, startSample, numSamples);
+}
+
+void PeakPyramid::update(const float* const* minimumData,
+                         const float* const* maximumData,
+                         int channels,
+                         int64_t startSample,
+                         int numSamples) noexcept
+{
+    if (numSamples <= 0 || levels.empty())
+        return;
+
+    channels = juce::jmin(numChannels, channels);
+    const auto endSample = startSample + numSamples;
+
+    {
+        // Base level straight from the incoming samples; only the newest `slots` blocks survive.
+        auto& base = levels.front();
+        const auto earliest = juce::jmax(startSample, ((endSample >> base.shift) - base.slots) << base.shift);
+        const auto blockMask = (static_cast<int64_t>(1) << base.shift) - 1;
+        const auto continuing = earliest == carryEnd && (earliest & blockMask) != 0;
+
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            auto position = earliest;
+            auto merging = continuing;
+
+            while (position < endSample)
+            {
+                const auto block = position >> base.shift;
+                const auto blockEnd = (block + 1) << base.shift;
+                const auto count = static_cast<int>(juce::jmin(blockEnd, endSample) - position);
+                const auto offset = position - startSample;
+                auto blockMin = 0.0f;
+                auto blockMax = 0.0f;
+
+                if (minimumData == maximumData)
+                {
+                    const auto range = juce::FloatVectorOperations::findMinAndMax(minimumData[channel] + offset, count);
+                    blockMin = range.getStart();
+                    blockMax = range.getEnd();
+                }
+                else
+                {
+                    blockMin = juce::FloatVectorOperations::findMinimum(minimumData[channel] + offset, count);
+                    blockMax = juce::FloatVectorOperations::findMaximum(maximumData[channel] + offset, count);
+                }
+
+                auto& carriedMin = carryMinimum[static_cast<size_t>(channel)];
+                auto& carriedMax = carryMaximum[static_cast<size_t>(channel)];
+                carriedMin = merging ? juce::jmin(carriedMin, blockMin) : blockMin;
+                carriedMax = merging ? juce::jmax(carriedMax, blockMax) : blockMax;
+                merging = true;
+
+                if (position + count == blockEnd)
+                {
+                    const auto index = static_cast<size_t>(channel * base.slots + static_cast<int>(block % base.slots));
+                    base.minimum[index] = carriedMin;
+                    base.maximum[index] = carriedMax;
+                    merging = false;
+                }
+
+                position += count;
+            }
+        }
+
+        carryEnd = endSample;
+    }
+
+    for (size_t l = 1; l < levels.size(); ++l)
+    {
+        auto& level = levels[l];
+        const auto& finer = levels[l - 1];
+        const auto endBlock = endSample >> level.shift;
+        const auto firstBlock = juce::jmax(startSample >> level.shift, endBlock - static_cast<int64_t>(level.slots));
+
+        // A coarser block can only complete where a finer one does.
+        if (firstBlock >= endBlock)
+            break;
+
+        for (auto block = firstBlock; block < endBlock; ++block)
+        {
+            const auto slot = static_cast<int>(block % level.slots);
+
+            for (int channel = 0; channel < channels; ++channel)
+            {
+                const auto base = channel * finer.slots;
+                const auto first = static_cast<size_t>(base + static_cast<int>((2 * block) % finer.slots));
+                const auto second = static_cast<size_t>(base + static_cast<int>((2 * block + 1) % finer.slots));
+                const auto index = static_cast<size_t>(channel * level.slots + slot);
+
+                level.minimum[index] = juce::jmin(finer.minimum[first], finer.minimum[second]);
+                level.maximum[index] = juce::jmax(finer.maximum[first], finer.maximum[second]);
+            }
+        }
+    }
+}
+
+void PeakPyramid::queryBlocks(int channel, int64_t firstBlock, int64_t endBlock, float& minimum, float& maximum) const noexcept
+{
+    auto lo = firstBlock;
+    auto hi = endBlock;
+
+    for (size_t l = 0; l < levels.size() && lo < hi; ++l)
+    {
+        const auto& level = levels[l];
+        const auto* mins = level.minimum.data() + channel * level.slots;
+        const auto* maxs = level.maximum.data() + channel * level.slots;
+
+        const auto take = [&](int64_t block)
+        {
+            const auto slot = static_cast<size_t>(block % level.slots);
+            minimum = juce::jmin(minimum, mins[slot]);
+            maximum = juce::jmax(maximum, maxs[slot]);
+        };
+
+        if (l + 1 == levels.size())
+        {
+            for (auto block = lo; block < hi; ++block)
+                take(block);
+
+            break;
+        }
+
+        if ((lo & 1) != 0)
+            take(lo++);
+
+        if ((hi & 1) != 0)
+            take(--hi);
+
+        lo >>= 1;
+        hi >>= 1;
+    }
+}
+
+int PeakPyramid::getNumLevels() const noexcept
+{
+    return static_cast<int>(levels.size());
+}
+
+void PeakPyramid::resetCarry() noexcept
+{
+    std::fill(carryMinimum.begin(), carryMinimum.end(), std::numeric_limits<float>::max());
+    std::fill(carryMaximum.begin(), carryMaximum.end(), -std::numeric_limits<float>::max());
+    carryEnd = -1;
+}
+
+} // namespace wvfrm
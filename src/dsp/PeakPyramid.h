@@ -0,0 +1,57 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+
+#include <vector>
+
+namespace wvfrm
+{
+
+// Per-channel min/max summaries at 2^k decimation levels, indexed by absolute sample
+// position so they stay aligned with the ring storage they summarize. The finest level
+// covers 2^baseLevelShift samples; anything below that is left to the caller's raw scan.
+class PeakPyramid
+{
+public:
+    static constexpr int baseLevelShift = 4;
+
+    void prepare(int channels, int ringCapacity);
+    void clear() noexcept;
+
+    // Folds freshly written samples into the pyramid: channelData[c][i] is absolute sample
+    // startSample + i. A base block split across calls is carried until it completes.
+    void update(const float* const* channelData, int channels, int64_t startSample, int numSamples) noexcept;
+
+    // Same, but folds a per-sample envelope instead of the samples themselves, for streams whose
+    // stored samples are smoother than the peaks they stand for.
+    void update(const float* const* minimumData,
+                const float* const* maximumData,
+                int channels,
+                int64_t startSample,
+                int numSamples) noexcept;
+
+    // Merges the min/max of whole base blocks [firstBlock, endBlock) into minimum/maximum;
+    // the caller guarantees those blocks are still retained.
+    void queryBlocks(int channel, int64_t firstBlock, int64_t endBlock, float& minimum, float& maximum) const noexcept;
+
+    int getNumLevels() const noexcept;
+
+private:
+    struct Level
+    {
+        int shift = 0;
+        int slots = 0;
+        std::vector<float> minimum;
+        std::vector<float> maximum;
+    };
+
+    void resetCarry() noexcept;
+
+    std::vector<Level> levels;
+    std::vector<float> carryMinimum;
+    std::vector<float> carryMaximum;
+    int64_t carryEnd = -1;
+    int numChannels = 0;
+};
+
+} // namespace wvfrm
@@ -0,0 +1,154 @@
+#include "SampleCodec.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace wvfrm::SampleCodec
+{
+
+namespace
+{
+constexpr float int16MaxCode = 32767.0f;
+
+// IEEE 754 binary16 with round-to-nearest-even; overflow saturates to infinity. Every case is
+// computed and the right one selected, so loops over this compile to vector blends.
+inline uint16_t floatToHalf(float value) noexcept
+{
+    constexpr uint32_t infinityBits = 255u << 23;
+    constexpr uint32_t halfOverflowBits = (127u + 16u) << 23;
+    constexpr uint32_t denormalMagicBits = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+    constexpr uint32_t smallestNormalBits = 113u << 23;
+
+    auto bits = std::bit_cast<uint32_t>(value);
+    const auto sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    const auto overflow = bits > infinityBits ? 0x7e00u : 0x7c00u;
+
+    // Denormals: let the FPU do the rounding by adding a magic bias.
+    const auto biased = std::bit_cast<float>(bits) + std::bit_cast<float>(denormalMagicBits);
+    const auto denormal = std::bit_cast<uint32_t>(biased) - denormalMagicBits;
+
+    const auto mantissaOdd = (bits >> 13) & 1u;
+    const auto normal = (bits + ((15u - 127u) << 23) + 0xfffu + mantissaOdd) >> 13;
+
+    const auto isDenormal = 0u - static_cast<uint32_t>(bits < smallestNormalBits);
+    const auto isOverflow = 0u - static_cast<uint32_t>(bits >= halfOverflowBits);
+    auto result = (denormal & isDenormal) | (normal & ~isDenormal);
+    result = (overflow & isOverflow) | (result & ~isOverflow);
+    return static_cast<uint16_t>(result | (sign >> 16));
+}
+
+inline float halfToFloat(uint16_t half) noexcept
+{
+    constexpr uint32_t shiftedExponent = 0x7c00u << 13;
+    constexpr auto magic = std::bit_cast<float>(113u << 23);
+
+    auto bits = static_cast<uint32_t>(half & 0x7fffu) << 13;
+    const auto exponent = shiftedExponent & bits;
+    bits += (127u - 15u) << 23;
+
+    const auto infinityOrNaN = bits + ((128u - 16u) << 23);
+    const auto renormalised = std::bit_cast<uint32_t>(std::bit_cast<float>(bits + (1u << 23)) - magic); // zero/denormal
+
+    const auto isDenormal = 0u - static_cast<uint32_t>(exponent == 0);
+    const auto isSpecial = 0u - static_cast<uint32_t>(exponent == shiftedExponent);
+    bits = (renormalised & isDenormal) | (bits & ~isDenormal);
+    bits = (infinityOrNaN & isSpecial) | (bits & ~isSpecial);
+    return std::bit_cast<float>(bits | (static_cast<uint32_t>(half & 0x8000u) << 16));
+}
+} // namespace
+
+int bytesPerSample(SampleFormat format) noexcept
+{
+    return format == SampleFormat::float32 ? 4 : 2;
+}
+
+void encode(SampleFormat format, const float* source, void* destination, int numSamples) noexcept
+{
+    switch (format)
+    {
+        case SampleFormat::float16:
+        {
+            auto* out = static_cast<uint16_t*>(destination);
+            for (int i = 0; i < numSamples; ++i)
+                out[i] = floatToHalf(source[i]);
+
+            return;
+        }
+
+        case SampleFormat::int16:
+        {
+            constexpr auto scale = int16MaxCode / int16FullScale;
+            auto* out = static_cast<int16_t*>(destination);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                // Half a step away from zero, then the truncating cast rounds to nearest. NaN fails
+                // its own comparison and maps to silence, and the clamp keeps the cast in range.
+                auto rounded = source[i] * scale + std::copysign(0.5f, source[i]);
+                rounded = juce::exactlyEqual(rounded, rounded) ? rounded : 0.0f;
+                rounded = std::min(int16MaxCode, std::max(-int16MaxCode, rounded));
+                out[i] = static_cast<int16_t>(rounded);
+            }
+
+            return;
+        }
+
+        case SampleFormat::float32:
+        default:
+            std::memcpy(destination, source, sizeof(float) * static_cast<size_t>(juce::jmax(0, numSamples)));
+            return;
+    }
+}
+
+void decode(SampleFormat format, const void* source, float* destination, int numSamples) noexcept
+{
+    switch (format)
+    {
+        case SampleFormat::float16:
+        {
+            const auto* in = static_cast<const uint16_t*>(source);
+            for (int i = 0; i < numSamples; ++i)
+                destination[i] = halfToFloat(in[i]);
+
+            return;
+        }
+
+        case SampleFormat::int16:
+        {
+            constexpr auto scale = int16FullScale / int16MaxCode;
+            const auto* in = static_cast<const int16_t*>(source);
+
+            for (int i = 0; i < numSamples; ++i)
+                destination[i] = static_cast<float>(in[i]) * scale;
+
+            return;
+        }
+
+        case SampleFormat::float32:
+        default:
+            std::memcpy(destination, source, sizeof(float) * static_cast<size_t>(juce::jmax(0, numSamples)));
+            return;
+    }
+}
+
+float maxError(SampleFormat format, float magnitude) noexcept
+{
+    const auto absolute = std::abs(magnitude);
+
+    switch (format)
+    {
+        // Half a unit in the last place: 10 mantissa bits, denormal step 2^-24.
+        case SampleFormat::float16: return absolute * std::ldexp(1.0f, -11) + std::ldexp(1.0f, -25);
+        case SampleFormat::int16:
+            return absolute > int16FullScale ? absolute - int16FullScale + 0.5f * int16FullScale / int16MaxCode
+                                             : 0.5f * int16FullScale / int16MaxCode;
+        case SampleFormat::float32:
+        default: return 0.0f;
+    }
+}
+
+} // namespace wvfrm::SampleCodec
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+
+#include <cstdint>
+
+namespace wvfrm
+{
+
+// How the analysis ring stores samples. The compact formats halve the footprint and are
+// decoded on read; int16 is scaled so int16FullScale maps to the largest code.
+enum class SampleFormat
+{
+    float32 = 0,
+    float16,
+    int16
+};
+
+namespace SampleCodec
+{
+static constexpr float int16FullScale = 2.0f;
+
+int bytesPerSample(SampleFormat format) noexcept;
+
+// Every case of a conversion is computed and the right one picked with a mask or min/max, so
+// the compiler vectorises these loops without F16C or NEON conversion instructions.
+void encode(SampleFormat format, const float* source, void* destination, int numSamples) noexcept;
+void decode(SampleFormat format, const void* source, float* destination, int numSamples) noexcept;
+
+// Worst-case absolute decode error for a sample of the given magnitude.
+float maxError(SampleFormat format, float magnitude) noexcept;
+} // namespace SampleCodec
+
+} // namespace wvfrm
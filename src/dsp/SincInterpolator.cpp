@@ -0,0 +1,54 @@
+#include "SincInterpolator.h"
+
+#include <cmath>
+
+namespace wvfrm
+{
+
+SincInterpolator::SincInterpolator()
+{
+    for (int phase = 0; phase <= phaseSteps; ++phase)
+    {
+        const auto fraction = static_cast<double>(phase) / phaseSteps;
+        auto* kernel = kernels.data() + static_cast<size_t>(phase * taps);
+        auto sum = 0.0;
+
+        for (int k = 0; k < taps; ++k)
+        {
+            // Distance from the point being read to the sample this tap weighs.
+            const auto t = static_cast<double>(k - (halfTaps - 1)) - fraction;
+            const auto x = juce::MathConstants<double>::pi * t;
+            const auto ideal = std::abs(t) < 1.0e-9 ? 1.0 : std::sin(x) / x;
+            const auto phaseOfWindow = juce::MathConstants<double>::pi * t / halfTaps;
+            const auto window = std::abs(t) >= halfTaps ? 0.0 : 0.42 + 0.5 * std::cos(phaseOfWindow) + 0.08 * std::cos(2.0 * phaseOfWindow);
+
+            kernel[k] = static_cast<float>(ideal * window);
+            sum += ideal * window;
+        }
+
+        // Unity gain at DC for every phase, so a flat signal stays flat between samples.
+        for (int k = 0; k < taps; ++k)
+            kernel[k] = static_cast<float>(kernel[k] / sum);
+    }
+}
+
+float SincInterpolator::interpolate(const float* window, float fraction) const noexcept
+{
+    const auto position = juce::jlimit(0.0f, 1.0f, fraction) * static_cast<float>(phaseSteps);
+    const auto phase = juce::jmin(phaseSteps - 1, static_cast<int>(position));
+    const auto blend = position - static_cast<float>(phase);
+    const auto* before = kernels.data() + static_cast<size_t>(phase * taps);
+    const auto* after = before + taps;
+
+    auto first = 0.0f;
+    auto second = 0.0f;
+    for (int k = 0; k < taps; ++k)
+    {
+        first += before[k] * window[k];
+        second += after[k] * window[k];
+    }
+
+    return first + (second - first) * blend;
+}
+
+} // namespace wvfrm
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+
+#include <array>
+
+namespace wvfrm
+{
+
+// Band-limited reconstruction between samples: a Blackman-windowed sinc of `taps` taps,
+// tabulated at phaseSteps + 1 fractional offsets when constructed. A value between two samples
+// blends the results of the two nearest tabulated phases, so reading one costs two short dot
+// products and no trigonometry.
+class SincInterpolator
+{
+public:
+    static constexpr int halfTaps = 8;
+    static constexpr int taps = 2 * halfTaps;
+    static constexpr int phaseSteps = 64;
+
+    SincInterpolator();
+
+    // The signal at fraction in [0, 1) past sample window[halfTaps - 1]; window holds `taps`
+    // consecutive samples.
+    float interpolate(const float* window, float fraction) const noexcept;
+
+private:
+    // Phase p, tap k weighs sample window[k] for a fraction of p / phaseSteps.
+    std::array<float, static_cast<size_t>((phaseSteps + 1) * taps)> kernels {};
+};
+
+} // namespace wvfrm
@@ -0,0 +1,308 @@
+#include "SpectralBandEngine.h"
+
+#include "ChannelViews.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace wvfrm
+{
+
+namespace
+{
+constexpr auto subCut = 20.0;
+constexpr auto lowCut = 200.0;
+constexpr auto highCut = 2000.0;
+
+int64_t floorDiv(int64_t value, int64_t divisor) noexcept
+{
+    const auto quotient = value / divisor;
+    return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+int64_t ceilDiv(int64_t value, int64_t divisor) noexcept
+{
+    return -floorDiv(-value, divisor);
+}
+} // namespace
+
+SpectralBandEngine::SpectralBandEngine(int historyFrames)
+    : juce::Thread("wvfrm spectral bands"),
+      slotCount(juce::nextPowerOfTwo(juce::jmax(2, historyFrames)))
+{
+    window.resize(static_cast<size_t>(fftSize));
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(),
+                                                            static_cast<size_t>(fftSize),
+                                                            juce::dsp::WindowingFunction<float>::hann,
+                                                            false);
+
+    fftBuffer.assign(static_cast<size_t>(fftSize * 2), 0.0f);
+    binBand.assign(static_cast<size_t>(fftSize / 2 + 1), -1);
+
+    for (auto& lane : history)
+        lane.assign(static_cast<size_t>(fftSize), 0.0f);
+
+    energies.assign(static_cast<size_t>(slotCount) * numLanes * 3, 0.0f);
+    slotFrame.assign(static_cast<size_t>(slotCount), -1);
+}
+
+SpectralBandEngine::~SpectralBandEngine()
+{
+    stopThread(1000);
+}
+
+void SpectralBandEngine::setEnabled(bool shouldRun)
+{
+    if (shouldRun == enabled.load())
+        return;
+
+    if (shouldRun)
+    {
+        enabled.store(true);
+        startThread();
+    }
+    else
+    {
+        enabled.store(false);
+        stopThread(1000);
+    }
+}
+
+bool SpectralBandEngine::isEnabled() const noexcept
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void SpectralBandEngine::push(const float* const* channelData,
+                              int numChannels,
+                              int numSamples,
+                              int64_t startSample,
+                              double sampleRate) noexcept
+{
+    if (numSamples <= 0 || numChannels <= 0)
+        return;
+
+    Chunk chunk;
+    chunk.sampleRate = sampleRate;
+    chunk.numChannels = juce::jmin(numChannels, maxChannels);
+
+    for (int offset = 0; offset < numSamples; offset += chunkSamples)
+    {
+        chunk.startSample = startSample + offset;
+        chunk.numSamples = juce::jmin(chunkSamples, numSamples - offset);
+
+        for (int channel = 0; channel < chunk.numChannels; ++channel)
+            std::copy(channelData[channel] + offset, channelData[channel] + offset + chunk.numSamples, chunk.samples[channel]);
+
+        if (! chunks.push(chunk))
+            return;
+    }
+}
+
+int SpectralBandEngine::processPending()
+{
+    auto produced = 0;
+
+    while (chunks.pop(incoming))
+        produced += consume(incoming);
+
+    return produced;
+}
+
+bool SpectralBandEngine::getBandEnergies(BandEnergyRing::Lane lane,
+                                         int channel,
+                                         int64_t startSample,
+                                         int64_t endSample,
+                                         BandEnergies& result) const noexcept
+{
+    const auto index = laneIndex(lane, channel);
+    if (index < 0 || endSample <= startSample)
+        return false;
+
+    // Frame f covers [f * hop - fftSize, f * hop); its centre is half a frame before its end.
+    constexpr auto half = fftSize / 2;
+    auto firstFrame = ceilDiv(startSample + half, hopSize);
+    auto endFrame = ceilDiv(endSample + half, hopSize);
+
+    if (endFrame <= firstFrame)
+    {
+        firstFrame = floorDiv((startSample + endSample) / 2 + half + hopSize / 2, hopSize);
+        endFrame = firstFrame + 1;
+    }
+
+    if (endFrame - firstFrame > slotCount)
+        return false;
+
+    for (int attempt = 0; attempt < 16; ++attempt)
+    {
+        const auto seqBegin = sequence.load(std::memory_order_acquire);
+        if ((seqBegin & 1u) != 0u)
+            continue;
+
+        BandEnergies sums;
+        auto complete = true;
+
+        for (auto frame = firstFrame; frame < endFrame && complete; ++frame)
+        {
+            const auto slot = static_cast<size_t>(frame & (slotCount - 1));
+            complete = slotFrame[slot] == frame;
+
+            const auto* values = energies.data() + (slot * numLanes + static_cast<size_t>(index)) * 3;
+            sums.low += values[0];
+            sums.mid += values[1];
+            sums.high += values[2];
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) != seqBegin)
+            continue;
+
+        if (! complete)
+            return false;
+
+        const auto count = static_cast<float>(endFrame - firstFrame);
+        result.low = std::sqrt(sums.low / count);
+        result.mid = std::sqrt(sums.mid / count);
+        result.high = std::sqrt(sums.high / count);
+        return true;
+    }
+
+    return false;
+}
+
+void SpectralBandEngine::run()
+{
+    while (! threadShouldExit())
+    {
+        // Polled on purpose: the only producer is the audio thread, and notify() would have it
+        // take the event's lock. A 5 ms nap is about one hop at 48 kHz, and until a frame lands
+        // readers fall back to the ring's filter records, so the lag never shows.
+        if (processPending() == 0)
+            wait(5);
+    }
+}
+
+void SpectralBandEngine::configure(double sampleRate)
+{
+    configuredRate = sampleRate;
+
+    for (int bin = 0; bin <= fftSize / 2; ++bin)
+    {
+        const auto frequency = static_cast<double>(bin) * sampleRate / fftSize;
+        auto band = -1;
+
+        if (frequency >= highCut)
+            band = 2;
+        else if (frequency >= lowCut)
+            band = 1;
+        else if (frequency >= subCut)
+            band = 0;
+
+        binBand[static_cast<size_t>(bin)] = band;
+    }
+
+    // One-sided power, scaled by Parseval and the window's energy so a band's value is the mean
+    // square of the signal in it, the same unit the time-domain analyzers report.
+    auto windowEnergy = 0.0;
+    for (const auto w : window)
+        windowEnergy += static_cast<double>(w) * w;
+
+    powerScale = static_cast<float>(2.0 / (static_cast<double>(fftSize) * windowEnergy));
+
+    // History filed under positions from another rate no longer lines up with the ring.
+    sequence.fetch_add(1, std::memory_order_acq_rel); // begin write (odd)
+    std::fill(slotFrame.begin(), slotFrame.end(), -1);
+    sequence.fetch_add(1, std::memory_order_release); // end write (even)
+
+    historyValid = 0;
+}
+
+int SpectralBandEngine::consume(const Chunk& chunk)
+{
+    if (! juce::exactlyEqual(chunk.sampleRate, configuredRate))
+        configure(chunk.sampleRate);
+
+    if (chunk.startSample != nextSample)
+        historyValid = 0; // a dropped chunk or a fresh start: frames must not straddle the gap
+
+    const auto* left = chunk.samples[0];
+    const auto* right = chunk.samples[chunk.numChannels > 1 ? 1 : 0];
+    auto position = chunk.startSample;
+    auto produced = 0;
+
+    for (int i = 0; i < chunk.numSamples; ++i)
+    {
+        const auto write = static_cast<size_t>(historyWrite);
+        history[0][write] = left[i];
+        history[1][write] = right[i];
+        history[2][write] = mixForChannelView(ChannelView::mid, left[i], right[i]);
+        history[3][write] = mixForChannelView(ChannelView::side, left[i], right[i]);
+
+        historyWrite = (historyWrite + 1) & (fftSize - 1);
+        historyValid = juce::jmin(fftSize, historyValid + 1);
+        ++position;
+
+        if ((position & (hopSize - 1)) == 0 && historyValid == fftSize)
+        {
+            writeFrame(position / hopSize);
+            ++produced;
+        }
+    }
+
+    nextSample = position;
+    return produced;
+}
+
+void SpectralBandEngine::writeFrame(int64_t frame)
+{
+    float bands[numLanes][3] {};
+
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        // historyWrite is the oldest sample once the history is full.
+        const auto& samples = history[static_cast<size_t>(lane)];
+        for (int i = 0; i < fftSize; ++i)
+        {
+            const auto source = static_cast<size_t>((historyWrite + i) & (fftSize - 1));
+            fftBuffer[static_cast<size_t>(i)] = samples[source] * window[static_cast<size_t>(i)];
+        }
+
+        std::fill(fftBuffer.begin() + fftSize, fftBuffer.end(), 0.0f);
+        fft.performFrequencyOnlyForwardTransform(fftBuffer.data(), true);
+
+        for (int bin = 1; bin <= fftSize / 2; ++bin)
+        {
+            const auto band = binBand[static_cast<size_t>(bin)];
+            if (band < 0)
+                continue;
+
+            const auto magnitude = fftBuffer[static_cast<size_t>(bin)];
+            const auto weight = bin == fftSize / 2 ? 0.5f : 1.0f;
+            bands[lane][band] += weight * magnitude * magnitude;
+        }
+    }
+
+    const auto slot = static_cast<size_t>(frame & (slotCount - 1));
+    auto* out = energies.data() + slot * numLanes * 3;
+
+    sequence.fetch_add(1, std::memory_order_acq_rel); // begin write (odd)
+    for (int lane = 0; lane < numLanes; ++lane)
+        for (int band = 0; band < 3; ++band)
+            out[lane * 3 + band] = bands[lane][band] * powerScale;
+
+    slotFrame[slot] = frame;
+    sequence.fetch_add(1, std::memory_order_release); // end write (even)
+}
+
+int SpectralBandEngine::laneIndex(BandEnergyRing::Lane lane, int channel) const noexcept
+{
+    switch (lane)
+    {
+        case BandEnergyRing::Lane::mid: return maxChannels;
+        case BandEnergyRing::Lane::side: return maxChannels + 1;
+        case BandEnergyRing::Lane::channel:
+        default: return juce::isPositiveAndBelow(channel, maxChannels) ? channel : -1;
+    }
+}
+
+} // namespace wvfrm
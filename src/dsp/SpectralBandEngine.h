@@ -0,0 +1,96 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+#include "BandAnalyzer3.h"
+#include "BandEnergyRing.h"
+#include "SpscQueue.h"
+
+namespace wvfrm
+{
+
+// Low/mid/high energies from Hann-windowed FFT frames, computed off the audio thread. The audio
+// thread hands the analysis stream over in fixed chunks; a worker thread runs one frame per hop,
+// folds its power spectrum into the three bands through a bin-to-band table, and files the
+// result under the absolute position of the frame, so readers look frames up the way they look
+// up ring samples. Lanes are the first two channels plus their mid and side.
+class SpectralBandEngine : private juce::Thread
+{
+public:
+    static constexpr int fftOrder = 10;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 4;
+    static constexpr int chunkSamples = 128;
+    static constexpr int maxChannels = 2;
+    static constexpr int numLanes = maxChannels + 2;
+
+    struct Chunk
+    {
+        int64_t startSample = 0;
+        double sampleRate = 0.0;
+        int numChannels = 0;
+        int numSamples = 0;
+        float samples[maxChannels][chunkSamples] {};
+    };
+
+    // historyFrames is rounded up to a power of two; the default covers the largest ring at the
+    // default hop.
+    explicit SpectralBandEngine(int historyFrames = 1 << 13);
+    ~SpectralBandEngine() override;
+
+    // Message thread: starts or stops the worker.
+    void setEnabled(bool shouldRun);
+    bool isEnabled() const noexcept;
+
+    // Audio thread, skipped while disabled. Never blocks: if the worker falls behind, chunks are
+    // dropped and the frames spanning the gap are simply never produced.
+    void push(const float* const* channelData, int numChannels, int numSamples, int64_t startSample, double sampleRate) noexcept;
+
+    // Worker thread; public so tests can drive the engine without one. Returns frames produced.
+    int processPending();
+
+    // Any thread. RMS band levels over the frames centred in [startSample, endSample), or the
+    // frame nearest its middle when the range is shorter than a hop.
+    bool getBandEnergies(BandEnergyRing::Lane lane,
+                         int channel,
+                         int64_t startSample,
+                         int64_t endSample,
+                         BandEnergies& energies) const noexcept;
+
+private:
+    void run() override;
+
+    void configure(double sampleRate);
+    int consume(const Chunk& chunk);
+    void writeFrame(int64_t frame);
+    int laneIndex(BandEnergyRing::Lane lane, int channel) const noexcept;
+
+    std::atomic<bool> enabled { false };
+    SpscQueue<Chunk> chunks { 256 };
+
+    // Worker state.
+    juce::dsp::FFT fft { fftOrder };
+    std::vector<float> window;
+    std::vector<int> binBand;
+    std::vector<float> fftBuffer;
+    float powerScale = 0.0f;
+    double configuredRate = 0.0;
+    std::array<std::vector<float>, numLanes> history;
+    int historyWrite = 0;
+    int historyValid = 0;
+    int64_t nextSample = -1;
+    Chunk incoming;
+
+    // Published frames, [slot][lane] triples of low/mid/high mean-square; slotFrame says which
+    // frame a slot holds (-1: none). Written by the worker inside the seqlock.
+    const int slotCount;
+    std::vector<float> energies;
+    std::vector<int64_t> slotFrame;
+    std::atomic<uint64_t> sequence { 0 };
+};
+
+} // namespace wvfrm
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+
+#include <atomic>
+#include <vector>
+
+namespace wvfrm
+{
+
+// Bounded wait-free queue for exactly one producer thread and one consumer thread.
+// Capacity is rounded up to a power of two and fixed at construction.
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(int minimumCapacity)
+        : slots(static_cast<size_t>(juce::nextPowerOfTwo(juce::jmax(2, minimumCapacity)))),
+          mask(slots.size() - 1)
+    {
+    }
+
+    bool push(const T& item) noexcept
+    {
+        const auto write = writePosition.load(std::memory_order_relaxed);
+        const auto read = readPosition.load(std::memory_order_acquire);
+
+        if (write - read >= slots.size())
+            return false;
+
+        slots[write & mask] = item;
+        writePosition.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) noexcept
+    {
+        const auto read = readPosition.load(std::memory_order_relaxed);
+        const auto write = writePosition.load(std::memory_order_acquire);
+
+        if (read == write)
+            return false;
+
+        item = slots[read & mask];
+        readPosition.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    int getNumReady() const noexcept
+    {
+        const auto write = writePosition.load(std::memory_order_acquire);
+        const auto read = readPosition.load(std::memory_order_acquire);
+        return static_cast<int>(write - read);
+    }
+
+    int getCapacity() const noexcept
+    {
+        return static_cast<int>(slots.size());
+    }
+
+private:
+    std::vector<T> slots;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> writePosition { 0 };
+    alignas(64) std::atomic<size_t> readPosition { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(SpscQueue)
+};
+
+} // namespace wvfrm
@@ -0,0 +1,33 @@
+#include "ViewActivity.h"
+
+#include <cmath>
+
+namespace wvfrm
+{
+
+namespace
+{
+// Far below anything a column can show, so denormal-level noise still counts as flat.
+constexpr float flatTolerance = 1.0e-6f;
+}
+
+int64_t updateViewActivity(const ViewActivityInput& input, ViewActivityState& state) noexcept
+{
+    const auto flat = input.maximum - input.minimum <= flatTolerance;
+    const auto level = 0.5f * (input.minimum + input.maximum);
+    const auto unchanged = state.hasLevel && std::abs(level - state.level) <= flatTolerance;
+
+    state.hasLevel = flat;
+    state.level = level;
+
+    if (input.isPlaying || ! flat || ! unchanged)
+    {
+        state.lastActiveEnd = input.blockEndSample;
+        return -1;
+    }
+
+    const auto idleSamples = static_cast<double>(input.blockEndSample - state.lastActiveEnd);
+    return idleSamples >= input.windowSamples ? state.lastActiveEnd : -1;
+}
+
+} // namespace wvfrm
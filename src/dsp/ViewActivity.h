@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+
+namespace wvfrm
+{
+
+// One audio block as the view sees it. The range covers every captured channel; positions are in
+// analysis-rate samples, the same clock as the analysis ring.
+struct ViewActivityInput
+{
+    bool isPlaying = true;
+    float minimum = 0.0f;
+    float maximum = 0.0f;
+    int64_t blockEndSample = 0;
+    double windowSamples = 0.0;
+};
+
+struct ViewActivityState
+{
+    bool hasLevel = false;
+    float level = 0.0f;
+    int64_t lastActiveEnd = 0;
+};
+
+// Audio thread, once per block. A block is idle when the transport is stopped and the input sits
+// flat at the level it held last block, silence included. Once idle blocks have filled the whole
+// window, further ones cannot change what the view shows; from then on this returns the sample
+// the last active block ended at, the same value every block until something moves again.
+// Returns -1 while the view still has something new to show.
+int64_t updateViewActivity(const ViewActivityInput& input, ViewActivityState& state) noexcept;
+
+} // namespace wvfrm
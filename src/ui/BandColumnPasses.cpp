@@ -0,0 +1,264 @@
+#include "BandColumnPasses.h"
+
+#include <cmath>
+
+namespace wvfrm
+{
+
+namespace
+{
+// Narrow kernel [1 2 1] for low colour match, wide [1 2 3 2 1] from 0.55 up; the narrow one is
+// padded to five taps with zero weights so both run through the same loop.
+constexpr int kernelRadius = 2;
+constexpr float narrowWeights[5] = { 0.0f, 1.0f, 2.0f, 1.0f, 0.0f };
+constexpr float wideWeights[5] = { 1.0f, 2.0f, 3.0f, 2.0f, 1.0f };
+
+constexpr float wrapGateAmplitudeThreshold = 0.08f;
+constexpr float wrapGateDeltaThreshold = 0.35f;
+
+float blurMixFor(float colorMatch) noexcept
+{
+    return juce::jmap(colorMatch, 0.0f, 1.0f, 0.2f, 1.0f);
+}
+
+const float* kernelFor(float colorMatch) noexcept
+{
+    return colorMatch >= 0.55f ? wideWeights : narrowWeights;
+}
+
+// The edge columns one at a time: neighbours wrap around the loop and are checked at the seam,
+// or stop at the edge.
+void blurColumnScalar(const BandPlanes& energies,
+                      const uint8_t* active,
+                      const float* amplitude,
+                      const float* weights,
+                      float blurMix,
+                      bool wrap,
+                      int width,
+                      int x,
+                      float& low,
+                      float& mid,
+                      float& high) noexcept
+{
+    const auto index = static_cast<size_t>(x);
+    low = energies.low[index];
+    mid = energies.mid[index];
+    high = energies.high[index];
+
+    auto weightSum = 0.0f;
+    auto lowSum = 0.0f;
+    auto midSum = 0.0f;
+    auto highSum = 0.0f;
+
+    for (int tap = 0; tap < 2 * kernelRadius + 1; ++tap)
+    {
+        const auto weight = weights[tap];
+        if (weight <= 0.0f)
+            continue;
+
+        auto nx = x + tap - kernelRadius;
+        if (! wrap && (nx < 0 || nx >= width))
+            continue;
+
+        if (nx < 0)
+            nx += width;
+        else if (nx >= width)
+            nx -= width;
+
+        const auto neighbour = static_cast<size_t>(nx);
+        if (active[neighbour] == 0)
+            continue;
+
+        const auto acrossSeam = (x == 0 && nx == width - 1) || (x == width - 1 && nx == 0);
+        if (acrossSeam)
+        {
+            const auto loudest = juce::jmax(amplitude[index], amplitude[neighbour]);
+            const auto delta = std::abs(low - energies.low[neighbour])
+                + std::abs(mid - energies.mid[neighbour])
+                + std::abs(high - energies.high[neighbour]);
+
+            if (loudest >= wrapGateAmplitudeThreshold && delta > wrapGateDeltaThreshold)
+                continue;
+        }
+
+        weightSum += weight;
+        lowSum += energies.low[neighbour] * weight;
+        midSum += energies.mid[neighbour] * weight;
+        highSum += energies.high[neighbour] * weight;
+    }
+
+    if (weightSum > 0.0f)
+    {
+        low = juce::jmap(blurMix, low, lowSum / weightSum);
+        mid = juce::jmap(blurMix, mid, midSum / weightSum);
+        high = juce::jmap(blurMix, high, highSum / weightSum);
+    }
+}
+} // namespace
+
+void BandPlanes::assign(size_t size, float value)
+{
+    low.assign(size, value);
+    mid.assign(size, value);
+    high.assign(size, value);
+}
+
+size_t BandPlanes::size() const noexcept
+{
+    return low.size();
+}
+
+BandEnergies BandPlanes::at(size_t index) const noexcept
+{
+    return { low[index], mid[index], high[index] };
+}
+
+void BandPlanes::set(size_t index, const BandEnergies& energies) noexcept
+{
+    low[index] = energies.low;
+    mid[index] = energies.mid;
+    high[index] = energies.high;
+}
+
+void blurBandColumns(const BandPlanes& energies,
+                     const uint8_t* active,
+                     const float* amplitude,
+                     float colorMatch,
+                     bool wrap,
+                     int firstColumn,
+                     int endColumn,
+                     BandSpans out) noexcept
+{
+    const auto width = static_cast<int>(energies.size());
+    const auto* weights = kernelFor(colorMatch);
+    const auto blurMix = blurMixFor(colorMatch);
+
+    // Columns whose kernel stays inside the track; the rest wrap and go one at a time.
+    const auto innerStart = juce::jlimit(firstColumn, endColumn, kernelRadius);
+    const auto innerEnd = juce::jlimit(innerStart, endColumn, width - kernelRadius);
+
+    auto scalarColumns = [&](int start, int end)
+    {
+        for (int x = start; x < end; ++x)
+        {
+            const auto i = x - firstColumn;
+            blurColumnScalar(energies, active, amplitude, weights, blurMix, wrap, width, x, out.low[i], out.mid[i], out.high[i]);
+        }
+    };
+
+    scalarColumns(firstColumn, innerStart);
+
+    const auto* low = energies.low.data();
+    const auto* mid = energies.mid.data();
+    const auto* high = energies.high.data();
+    auto* outLow = out.low - firstColumn;
+    auto* outMid = out.mid - firstColumn;
+    auto* outHigh = out.high - firstColumn;
+
+    for (int x = innerStart; x < innerEnd; ++x)
+    {
+        auto weightSum = 0.0f;
+        auto lowSum = 0.0f;
+        auto midSum = 0.0f;
+        auto highSum = 0.0f;
+
+        for (int tap = 0; tap < 2 * kernelRadius + 1; ++tap)
+        {
+            const auto n = x + tap - kernelRadius;
+            const auto weight = weights[tap] * static_cast<float>(active[n]);
+            weightSum += weight;
+            lowSum += low[n] * weight;
+            midSum += mid[n] * weight;
+            highSum += high[n] * weight;
+        }
+
+        const auto mix = weightSum > 0.0f ? blurMix : 0.0f;
+        const auto inverse = 1.0f / juce::jmax(weightSum, 1.0e-20f);
+        outLow[x] = low[x] + mix * (lowSum * inverse - low[x]);
+        outMid[x] = mid[x] + mix * (midSum * inverse - mid[x]);
+        outHigh[x] = high[x] + mix * (highSum * inverse - high[x]);
+    }
+
+    scalarColumns(innerEnd, endColumn);
+}
+
+void smoothBandColumns(BandPlanes& state,
+                       uint8_t* initialised,
+                       const uint8_t* active,
+                       int firstColumn,
+                       int endColumn,
+                       float attackAlpha,
+                       float releaseAlpha,
+                       bool reset,
+                       BandSpans values) noexcept
+{
+    const auto keepPrevious = reset ? 0.0f : 1.0f;
+    float* planes[3] = { state.low.data(), state.mid.data(), state.high.data() };
+    float* targets[3] = { values.low - firstColumn, values.mid - firstColumn, values.high - firstColumn };
+
+    for (int band = 0; band < 3; ++band)
+    {
+        auto* previous = planes[band];
+        auto* value = targets[band];
+
+        for (int x = firstColumn; x < endColumn; ++x)
+        {
+            const auto isActive = active[x] != 0;
+            const auto alpha = (value[x] > previous[x] ? attackAlpha : releaseAlpha)
+                * keepPrevious * static_cast<float>(initialised[x] != 0 ? 1 : 0);
+            const auto eased = alpha * previous[x] + (1.0f - alpha) * value[x];
+
+            previous[x] = isActive ? eased : previous[x];
+            value[x] = eased;
+        }
+    }
+
+    for (int x = firstColumn; x < endColumn; ++x)
+        initialised[x] = static_cast<uint8_t>(initialised[x] | active[x]);
+}
+
+void normalizeBandColumns(BandSpans values, int count, const BandEnergies& peak) noexcept
+{
+    float* planes[3] = { values.low, values.mid, values.high };
+    const float scales[3] = { 1.0f / peak.low, 1.0f / peak.mid, 1.0f / peak.high };
+
+    for (int band = 0; band < 3; ++band)
+    {
+        auto* value = planes[band];
+        const auto scale = scales[band];
+
+        for (int i = 0; i < count; ++i)
+            value[i] = juce::jmin(1.0f, juce::jmax(0.0f, value[i]) * scale);
+    }
+}
+
+void clampBandColumns(BandSpans values, int count) noexcept
+{
+    for (auto* value : { values.low, values.mid, values.high })
+    {
+        for (int i = 0; i < count; ++i)
+            value[i] = juce::jmin(1.0f, juce::jmax(0.0f, value[i]));
+    }
+}
+
+BandEnergies peakBandColumns(const BandPlanes& energies, const uint8_t* active) noexcept
+{
+    const auto width = energies.size();
+    float peaks[3] = {};
+    const float* planes[3] = { energies.low.data(), energies.mid.data(), energies.high.data() };
+
+    for (int band = 0; band < 3; ++band)
+    {
+        const auto* value = planes[band];
+        auto peak = 0.0f;
+
+        for (size_t x = 0; x < width; ++x)
+            peak = juce::jmax(peak, active[x] != 0 ? value[x] : 0.0f);
+
+        peaks[band] = peak;
+    }
+
+    return { peaks[0], peaks[1], peaks[2] };
+}
+
+} // namespace wvfrm
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+#include "../dsp/BandAnalyzer3.h"
+
+#include <vector>
+
+namespace wvfrm
+{
+
+// A track's per-column band energies as three parallel arrays, so the colour passes below
+// stream each band through contiguous floats instead of striding over BandEnergies.
+struct BandPlanes
+{
+    std::vector<float> low;
+    std::vector<float> mid;
+    std::vector<float> high;
+
+    void assign(size_t size, float value = 0.0f);
+    size_t size() const noexcept;
+    BandEnergies at(size_t index) const noexcept;
+    void set(size_t index, const BandEnergies& energies) noexcept;
+};
+
+// Three arrays of a tile's columns, indexed from the tile's first column.
+struct BandSpans
+{
+    float* low = nullptr;
+    float* mid = nullptr;
+    float* high = nullptr;
+};
+
+// The colour passes a tile of columns [firstColumn, endColumn) goes through before its colours
+// are looked up. Each is a branch-free loop over contiguous floats that the compiler turns into
+// SIMD code; the few columns whose blur wraps around the loop seam take a scalar path.
+
+// Weighted blur of each column with its active neighbours, mixed with the unblurred value by
+// colour match. With wrap the neighbours wrap around the loop, and one across the seam is left
+// out when the seam is a loud, abrupt change of colour; without it the edges have none past them.
+void blurBandColumns(const BandPlanes& energies,
+                     const uint8_t* active,
+                     const float* amplitude,
+                     float colorMatch,
+                     bool wrap,
+                     int firstColumn,
+                     int endColumn,
+                     BandSpans out) noexcept;
+
+// Eases each active column's state towards values (in place: values becomes the new state),
+// by attackAlpha where the value rose and releaseAlpha where it fell; alpha is the share of
+// the previous state kept. Uninitialised columns, or every column on reset, take the value as
+// is. Inactive columns keep their state.
+void smoothBandColumns(BandPlanes& state,
+                       uint8_t* initialised,
+                       const uint8_t* active,
+                       int firstColumn,
+                       int endColumn,
+                       float attackAlpha,
+                       float releaseAlpha,
+                       bool reset,
+                       BandSpans values) noexcept;
+
+// values / peak, clamped to [0, 1]; peak must be positive.
+void normalizeBandColumns(BandSpans values, int count, const BandEnergies& peak) noexcept;
+
+// values clamped to [0, 1].
+void clampBandColumns(BandSpans values, int count) noexcept;
+
+// Each band's largest energy over the active columns; 0 when none are.
+BandEnergies peakBandColumns(const BandPlanes& energies, const uint8_t* active) noexcept;
+
+} // namespace wvfrm
@@ -0,0 +1,142 @@
+#include "ColourLut.h"
+
+#include <cmath>
+
+namespace wvfrm
+{
+
+namespace
+{
+constexpr int gridIndex(int low, int mid, int high) noexcept
+{
+    return (low * ColourLut::bandPoints + mid) * ColourLut::bandPoints + high;
+}
+
+// Grid cell and offset within it for a value in [0, 1].
+void locate(float value, int& cell, float& fraction) noexcept
+{
+    const auto position = juce::jlimit(0.0f, 1.0f, value) * static_cast<float>(ColourLut::bandPoints - 1);
+    cell = juce::jmin(ColourLut::bandPoints - 2, static_cast<int>(position));
+    fraction = position - static_cast<float>(cell);
+}
+
+juce::uint8 toByte(float value) noexcept
+{
+    return static_cast<juce::uint8>(juce::jlimit(0, 255, juce::roundToInt(value * 255.0f)));
+}
+} // namespace
+
+bool ColourLut::prepare(const ThemeEngine& engine, const Settings& newSettings)
+{
+    if (built && newSettings == settings)
+        return false;
+
+    settings = newSettings;
+    built = true;
+
+    if (settings.mode == ColorMode::threeBand)
+    {
+        base.resize(static_cast<size_t>(bandPoints * bandPoints * bandPoints));
+        const auto step = 1.0f / static_cast<float>(bandPoints - 1);
+
+        for (int low = 0; low < bandPoints; ++low)
+        {
+            for (int mid = 0; mid < bandPoints; ++mid)
+            {
+                for (int high = 0; high < bandPoints; ++high)
+                {
+                    const BandEnergies energies { static_cast<float>(low) * step,
+                                                  static_cast<float>(mid) * step,
+                                                  static_cast<float>(high) * step };
+                    const auto colour = engine.baseColourFor(energies,
+                                                             settings.theme,
+                                                             settings.mode,
+                                                             settings.intensityPercent,
+                                                             settings.colorMatchPercent);
+                    base[static_cast<size_t>(gridIndex(low, mid, high))] = { colour.getFloatRed(),
+                                                                             colour.getFloatGreen(),
+                                                                             colour.getFloatBlue() };
+                }
+            }
+        }
+    }
+    else
+    {
+        const auto colour = engine.baseColourFor({}, settings.theme, settings.mode, settings.intensityPercent, settings.colorMatchPercent);
+        base.assign(1, { colour.getFloatRed(), colour.getFloatGreen(), colour.getFloatBlue() });
+    }
+
+    curve.resize(static_cast<size_t>(curvePoints + 1));
+    for (int i = 0; i <= curvePoints; ++i)
+    {
+        curve[static_cast<size_t>(i)] = ThemeEngine::shapeBandIntensity(static_cast<float>(i) / static_cast<float>(curvePoints),
+                                                                        settings.intensityPercent);
+    }
+
+    return true;
+}
+
+const ColourLut::Settings& ColourLut::getSettings() const noexcept
+{
+    return settings;
+}
+
+ColourLut::Rgb ColourLut::baseAt(BandEnergies energies) const noexcept
+{
+    if (base.size() == 1)
+        return base.front();
+
+    int low = 0, mid = 0, high = 0;
+    float fl = 0.0f, fm = 0.0f, fh = 0.0f;
+    locate(energies.low, low, fl);
+    locate(energies.mid, mid, fm);
+    locate(energies.high, high, fh);
+
+    Rgb result {};
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        const auto dl = corner >> 2;
+        const auto dm = (corner >> 1) & 1;
+        const auto dh = corner & 1;
+        const auto weight = (dl != 0 ? fl : 1.0f - fl) * (dm != 0 ? fm : 1.0f - fm) * (dh != 0 ? fh : 1.0f - fh);
+        const auto& sample = base[static_cast<size_t>(gridIndex(low + dl, mid + dm, high + dh))];
+
+        result[0] += weight * sample[0];
+        result[1] += weight * sample[1];
+        result[2] += weight * sample[2];
+    }
+
+    return result;
+}
+
+juce::uint32 ColourLut::lookup(BandEnergies energies, float amplitudeNorm) const noexcept
+{
+    jassert(built);
+
+    // Multiplying brightness scales every channel alike until the brightest one saturates.
+    const auto rgb = baseAt(energies);
+    const auto value = juce::jmax(rgb[0], rgb[1], rgb[2]);
+    const auto brightness = ThemeEngine::brightnessFor(settings.mode, settings.intensityPercent, amplitudeNorm);
+    const auto gain = value > 0.0f ? juce::jmin(brightness, 1.0f / value) : 0.0f;
+
+    return (static_cast<juce::uint32>(toByte(ThemeEngine::alphaFor(settings.mode, amplitudeNorm))) << 24)
+         | (static_cast<juce::uint32>(toByte(rgb[0] * gain)) << 16)
+         | (static_cast<juce::uint32>(toByte(rgb[1] * gain)) << 8)
+         | static_cast<juce::uint32>(toByte(rgb[2] * gain));
+}
+
+float ColourLut::shapeBand(float normalizedEnergy) const noexcept
+{
+    const auto position = juce::jlimit(0.0f, 1.0f, normalizedEnergy) * static_cast<float>(curvePoints);
+    const auto index = juce::jmin(curvePoints - 1, static_cast<int>(position));
+    const auto fraction = position - static_cast<float>(index);
+    return curve[static_cast<size_t>(index)] + fraction * (curve[static_cast<size_t>(index) + 1] - curve[static_cast<size_t>(index)]);
+}
+
+void ColourLut::shapeBands(float* normalizedEnergies, int count) const noexcept
+{
+    for (int i = 0; i < count; ++i)
+        normalizedEnergies[i] = shapeBand(normalizedEnergies[i]);
+}
+
+} // namespace wvfrm
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+#include "../Parameters.h"
+#include "../dsp/BandAnalyzer3.h"
+#include "ThemeEngine.h"
+
+#include <array>
+#include <vector>
+
+namespace wvfrm
+{
+
+// ThemeEngine::colourFor() tabulated for one theme, colour mode, intensity and colour match, so
+// colouring a column is a table fetch instead of an HSB round trip. The saturated base colour
+// is sampled on a bandPoints³ grid over the low/mid/high energies and interpolated trilinearly;
+// the amplitude step only scales brightness, which keeps hue and saturation, so it is applied
+// to the interpolated colour directly. The band shaping curve is tabulated alongside, since it
+// depends on the intensity too. Tables are rebuilt only when the settings change.
+class ColourLut
+{
+public:
+    struct Settings
+    {
+        ThemePreset theme = ThemePreset::minimeters3Band;
+        ColorMode mode = ColorMode::threeBand;
+        float intensityPercent = 100.0f;
+        float colorMatchPercent = 100.0f;
+
+        bool operator==(const Settings&) const noexcept = default;
+    };
+
+    static constexpr int bandPoints = 17;
+    static constexpr int curvePoints = 1024;
+
+    // Retabulates for newSettings; false when the tables already match them.
+    bool prepare(const ThemeEngine& engine, const Settings& newSettings);
+    const Settings& getSettings() const noexcept;
+
+    // colourFor(energies, ..., amplitudeNorm, ...) as non-premultiplied ARGB.
+    juce::uint32 lookup(BandEnergies energies, float amplitudeNorm) const noexcept;
+
+    // ThemeEngine::shapeBandIntensity() at this intensity.
+    float shapeBand(float normalizedEnergy) const noexcept;
+    void shapeBands(float* normalizedEnergies, int count) const noexcept;
+
+private:
+    using Rgb = std::array<float, 3>;
+
+    Rgb baseAt(BandEnergies energies) const noexcept;
+
+    Settings settings;
+    bool built = false;
+    std::vector<Rgb> base; // one entry in flat mode, whose base ignores the energies
+    std::vector<float> curve;
+};
+
+} // namespace wvfrm
@@ -0,0 +1,328 @@
+#include "ColumnRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+#elif JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
+namespace wvfrm
+{
+
+namespace
+{
+using Pixel = juce::uint32;
+
+// Pixels per span handed to the blend loops; wider rectangles are covered in several spans.
+constexpr int maxSpanPixels = 64;
+
+// A colour in the image's native ARGB layout, premultiplied and scaled by coverage in [0, 1].
+Pixel premultiplied(juce::uint32 argb, float coverage) noexcept
+{
+    const auto alpha = static_cast<Pixel>(juce::roundToInt(static_cast<float>(argb >> 24) * juce::jlimit(0.0f, 1.0f, coverage)));
+    const auto channel = [&](int shift)
+    {
+        return ((((argb >> shift) & 0xffu) * alpha) + 127u) / 255u;
+    };
+
+    return (alpha << 24) | (channel(16) << 16) | (channel(8) << 8) | channel(0);
+}
+
+// Source over destination, both premultiplied. Scaling by 256 - alpha keeps every channel
+// within a byte without a divide.
+Pixel blendPixel(Pixel destination, Pixel source) noexcept
+{
+    const auto inverse = 256u - (source >> 24);
+    const auto redBlue = (((destination & 0x00ff00ffu) * inverse) >> 8) & 0x00ff00ffu;
+    const auto alphaGreen = (((destination >> 8) & 0x00ff00ffu) * inverse) & 0xff00ff00u;
+    return source + redBlue + alphaGreen;
+}
+
+void blendSpan(Pixel* destination, const Pixel* source, int count) noexcept
+{
+    auto i = 0;
+
+   #if JUCE_USE_SSE_INTRINSICS
+    // Channels widen to 16 bits, where SSE2 can multiply them by each pixel's 256 - alpha.
+    const auto zero = _mm_setzero_si128();
+    const auto full = _mm_set1_epi16(256);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        const auto src = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        const auto dst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination + i));
+
+        auto alpha = _mm_srli_epi32(src, 24);
+        alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+        const auto inverseLow = _mm_sub_epi16(full, _mm_unpacklo_epi32(alpha, alpha));
+        const auto inverseHigh = _mm_sub_epi16(full, _mm_unpackhi_epi32(alpha, alpha));
+
+        const auto low = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), inverseLow), 8);
+        const auto high = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), inverseHigh), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_add_epi8(_mm_packus_epi16(low, high), src));
+    }
+   #elif JUCE_USE_ARM_NEON
+    // NEON multiplies 32-bit lanes, so the scalar red/blue and alpha/green split works as is.
+    const auto lowMask = vdupq_n_u32(0x00ff00ffu);
+    const auto highMask = vdupq_n_u32(0xff00ff00u);
+    const auto full = vdupq_n_u32(256u);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        const auto src = vld1q_u32(source + i);
+        const auto dst = vld1q_u32(destination + i);
+        const auto inverse = vsubq_u32(full, vshrq_n_u32(src, 24));
+
+        const auto redBlue = vandq_u32(vshrq_n_u32(vmulq_u32(vandq_u32(dst, lowMask), inverse), 8), lowMask);
+        const auto alphaGreen = vandq_u32(vmulq_u32(vandq_u32(vshrq_n_u32(dst, 8), lowMask), inverse), highMask);
+        vst1q_u32(destination + i, vaddq_u32(src, vaddq_u32(redBlue, alphaGreen)));
+    }
+   #endif
+
+    for (; i < count; ++i)
+        destination[i] = blendPixel(destination[i], source[i]);
+}
+
+void fillSpan(Pixel* destination, Pixel value, int count) noexcept
+{
+    auto i = 0;
+
+   #if JUCE_USE_SSE_INTRINSICS
+    const auto values = _mm_set1_epi32(static_cast<int>(value));
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), values);
+   #elif JUCE_USE_ARM_NEON
+    const auto values = vdupq_n_u32(value);
+    for (; i + 4 <= count; i += 4)
+        vst1q_u32(destination + i, values);
+   #endif
+
+    for (; i < count; ++i)
+        destination[i] = value;
+}
+
+// Every channel of a premultiplied pixel times amount in [0, 1].
+Pixel scaledPixel(Pixel pixel, float amount) noexcept
+{
+    const auto factor = static_cast<Pixel>(juce::roundToInt(juce::jlimit(0.0f, 1.0f, amount) * 256.0f));
+    const auto redBlue = (((pixel & 0x00ff00ffu) * factor) >> 8) & 0x00ff00ffu;
+    const auto alphaGreen = (((pixel >> 8) & 0x00ff00ffu) * factor) & 0xff00ff00u;
+    return redBlue | alphaGreen;
+}
+
+// One rectangle of a column line; its rows come from the column.
+struct Layer
+{
+    float left = 0.0f;
+    float right = 0.0f;
+    juce::uint32 argb = 0;
+};
+
+// Blends layers, first at the bottom, over rows [top, bottom) in image pixels, touching only
+// pixel columns [clipStart, clipEnd). Each pixel is weighted by the area of it a layer covers.
+// The layers share their rows, so they are composed into one span first and every row costs
+// a single blend.
+void blendLayers(juce::Image::BitmapData& bitmap,
+                 int clipStart,
+                 int clipEnd,
+                 const Layer* layers,
+                 int numLayers,
+                 float top,
+                 float bottom) noexcept
+{
+    top = juce::jmax(0.0f, top);
+    bottom = juce::jmin(static_cast<float>(bitmap.height), bottom);
+
+    auto left = std::numeric_limits<float>::max();
+    auto right = -std::numeric_limits<float>::max();
+    for (int layer = 0; layer < numLayers; ++layer)
+    {
+        left = juce::jmin(left, layers[layer].left);
+        right = juce::jmax(right, layers[layer].right);
+    }
+
+    const auto firstX = juce::jmax(clipStart, static_cast<int>(std::floor(left)));
+    const auto endX = juce::jmin(clipEnd, static_cast<int>(std::ceil(right)));
+
+    if (endX <= firstX || bottom <= top)
+        return;
+
+    const auto firstY = static_cast<int>(std::floor(top));
+    const auto endY = static_cast<int>(std::ceil(bottom));
+    const auto firstInnerY = juce::jmin(endY, static_cast<int>(std::ceil(top)));
+    const auto endInnerY = juce::jmax(firstInnerY, static_cast<int>(std::floor(bottom)));
+
+    Pixel inner[maxSpanPixels];
+    Pixel edge[maxSpanPixels];
+
+    for (auto spanStart = firstX; spanStart < endX; spanStart += maxSpanPixels)
+    {
+        const auto count = juce::jmin(maxSpanPixels, endX - spanStart);
+
+        for (int i = 0; i < count; ++i)
+        {
+            const auto x = static_cast<float>(spanStart + i);
+            auto composed = Pixel {};
+
+            for (int layer = 0; layer < numLayers; ++layer)
+            {
+                const auto coverage = juce::jmin(layers[layer].right, x + 1.0f) - juce::jmax(layers[layer].left, x);
+                if (coverage > 0.0f)
+                    composed = blendPixel(composed, premultiplied(layers[layer].argb, coverage));
+            }
+
+            inner[i] = composed;
+        }
+
+        auto blendEdgeRow = [&](int y)
+        {
+            const auto vertical = juce::jmin(bottom, static_cast<float>(y + 1)) - juce::jmax(top, static_cast<float>(y));
+            for (int i = 0; i < count; ++i)
+                edge[i] = scaledPixel(inner[i], vertical);
+
+            blendSpan(reinterpret_cast<Pixel*>(bitmap.getLinePointer(y)) + spanStart, edge, count);
+        };
+
+        // Partly covered rows at either end; every row between them takes the same span.
+        for (auto y = firstY; y < firstInnerY; ++y)
+            blendEdgeRow(y);
+
+        for (auto y = firstInnerY; y < endInnerY; ++y)
+            blendSpan(reinterpret_cast<Pixel*>(bitmap.getLinePointer(y)) + spanStart, inner, count);
+
+        for (auto y = endInnerY; y < endY; ++y)
+            blendEdgeRow(y);
+    }
+}
+
+juce::uint32 withScaledAlpha(juce::uint32 argb, float alphaScale) noexcept
+{
+    const auto alpha = juce::roundToInt(static_cast<float>(argb >> 24) * juce::jlimit(0.0f, 1.0f, alphaScale));
+    return (static_cast<juce::uint32>(alpha) << 24) | (argb & 0x00ffffffu);
+}
+} // namespace
+
+void ColumnRasterizer::setBackend(RasterBackend newBackend) noexcept
+{
+    backend = newBackend;
+}
+
+RasterBackend ColumnRasterizer::getBackend() const noexcept
+{
+    return backend;
+}
+
+void ColumnRasterizer::paintStrip(juce::Image& image,
+                                  float scale,
+                                  const Strip& strip,
+                                  const Column* columns,
+                                  int firstColumn,
+                                  int endColumn,
+                                  const Style& style) const
+{
+    if (strip.pixelEnd <= strip.pixelStart || ! image.isValid())
+        return;
+
+    if (backend == RasterBackend::direct && image.getFormat() == juce::Image::ARGB)
+    {
+        juce::Image::BitmapData bitmap(image, juce::Image::BitmapData::readWrite);
+        if (bitmap.pixelFormat == juce::Image::ARGB && bitmap.pixelStride == static_cast<int>(sizeof(Pixel)))
+        {
+            paintDirect(bitmap, scale, strip, columns, firstColumn, endColumn, style);
+            return;
+        }
+    }
+
+    paintWithGraphics(image, scale, strip, columns, firstColumn, endColumn, style);
+}
+
+void ColumnRasterizer::paintWithGraphics(juce::Image& image,
+                                         float scale,
+                                         const Strip& strip,
+                                         const Column* columns,
+                                         int firstColumn,
+                                         int endColumn,
+                                         const Style& style)
+{
+    juce::Graphics g(image);
+    g.reduceClipRegion({ strip.pixelStart, 0, strip.pixelEnd - strip.pixelStart, image.getHeight() });
+    g.addTransform(juce::AffineTransform::scale(scale));
+    g.fillAll(strip.background);
+
+    g.setColour(strip.centreLine);
+    g.drawHorizontalLine(strip.centreY,
+                         static_cast<float>(strip.pixelStart) / scale,
+                         static_cast<float>(strip.pixelEnd) / scale);
+
+    for (auto x = firstColumn; x < endColumn; ++x)
+    {
+        const auto& column = columns[x];
+        if (column.argb == 0)
+            continue;
+
+        const auto colour = juce::Colour(column.argb);
+        const auto xPos = static_cast<float>(x) + 0.5f;
+
+        if (style.glowThickness > 0.0f)
+        {
+            g.setColour(colour.withAlpha(colour.getFloatAlpha() * style.glowAlpha));
+            g.drawLine(xPos, column.top, xPos, column.bottom, style.glowThickness);
+        }
+
+        g.setColour(colour);
+        g.drawLine(xPos, column.top, xPos, column.bottom, style.coreThickness);
+    }
+}
+
+void ColumnRasterizer::paintDirect(juce::Image::BitmapData& bitmap,
+                                   float scale,
+                                   const Strip& strip,
+                                   const Column* columns,
+                                   int firstColumn,
+                                   int endColumn,
+                                   const Style& style)
+{
+    const auto clipStart = juce::jmax(0, strip.pixelStart);
+    const auto clipEnd = juce::jmin(bitmap.width, strip.pixelEnd);
+    if (clipEnd <= clipStart)
+        return;
+
+    const auto background = premultiplied(strip.background.getARGB(), 1.0f);
+    for (int y = 0; y < bitmap.height; ++y)
+        fillSpan(reinterpret_cast<Pixel*>(bitmap.getLinePointer(y)) + clipStart, background, clipEnd - clipStart);
+
+    const auto centreTop = static_cast<float>(strip.centreY) * scale;
+    const Layer centreLine { static_cast<float>(clipStart), static_cast<float>(clipEnd), strip.centreLine.getARGB() };
+    blendLayers(bitmap, clipStart, clipEnd, &centreLine, 1, centreTop, centreTop + scale);
+
+    const auto halfCore = 0.5f * style.coreThickness * scale;
+    const auto halfGlow = 0.5f * style.glowThickness * scale;
+    const auto hasGlow = style.glowThickness > 0.0f;
+
+    for (auto x = firstColumn; x < endColumn; ++x)
+    {
+        const auto& column = columns[x];
+        if (column.argb == 0)
+            continue;
+
+        const auto centre = (static_cast<float>(x) + 0.5f) * scale;
+        const Layer layers[] {
+            { centre - halfGlow, centre + halfGlow, withScaledAlpha(column.argb, style.glowAlpha) },
+            { centre - halfCore, centre + halfCore, column.argb }
+        };
+
+        blendLayers(bitmap,
+                    clipStart,
+                    clipEnd,
+                    hasGlow ? layers : layers + 1,
+                    hasGlow ? 2 : 1,
+                    juce::jmin(column.top, column.bottom) * scale,
+                    juce::jmax(column.top, column.bottom) * scale);
+    }
+}
+
+} // namespace wvfrm
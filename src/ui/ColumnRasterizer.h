@@ -0,0 +1,87 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+#include "../Parameters.h"
+
+namespace wvfrm
+{
+
+// Draws the column lines of a track image: one vertical line per column from its top to its
+// bottom, a wider translucent glow under a core line. The graphics backend goes through
+// juce::Graphics like any other drawing; the direct backend writes premultiplied ARGB straight
+// into the image's pixels, treating every line as the rectangle Graphics::drawLine would fill,
+// antialiased by the area each pixel covers. A column's glow and core share their rows, so they
+// are composed into one span and each row is a single blend, four pixels at a time where SSE2
+// or NEON is available. The direct backend needs an ARGB image and falls back to Graphics
+// otherwise.
+class ColumnRasterizer
+{
+public:
+    struct Column
+    {
+        juce::uint32 argb = 0; // not premultiplied; 0 draws nothing
+        float top = 0.0f;
+        float bottom = 0.0f;
+
+        // Ends closer than 1/256 of a unit draw the same coverage, so they count as unchanged.
+        bool operator==(const Column& other) const noexcept
+        {
+            return argb == other.argb && quantize(top) == quantize(other.top)
+                && quantize(bottom) == quantize(other.bottom);
+        }
+
+        static int quantize(float position) noexcept { return juce::roundToInt(position * 256.0f); }
+    };
+
+    struct Style
+    {
+        float coreThickness = 1.0f;
+        float glowThickness = 0.0f; // 0: no glow
+        float glowAlpha = 0.0f;     // scales each column's alpha for its glow
+    };
+
+    // Image pixel columns [pixelStart, pixelEnd) to repaint on every row. centreY is in the same
+    // units as the columns.
+    struct Strip
+    {
+        int pixelStart = 0;
+        int pixelEnd = 0;
+        int centreY = 0;
+        juce::Colour background;
+        juce::Colour centreLine;
+    };
+
+    void setBackend(RasterBackend newBackend) noexcept;
+    RasterBackend getBackend() const noexcept;
+
+    // Repaints the strip: background, a one-unit centre line, then columns [firstColumn,
+    // endColumn). Column x is centred on x + 0.5; scale maps column units to image pixels.
+    void paintStrip(juce::Image& image,
+                    float scale,
+                    const Strip& strip,
+                    const Column* columns,
+                    int firstColumn,
+                    int endColumn,
+                    const Style& style) const;
+
+private:
+    static void paintWithGraphics(juce::Image& image,
+                                  float scale,
+                                  const Strip& strip,
+                                  const Column* columns,
+                                  int firstColumn,
+                                  int endColumn,
+                                  const Style& style);
+
+    static void paintDirect(juce::Image::BitmapData& bitmap,
+                            float scale,
+                            const Strip& strip,
+                            const Column* columns,
+                            int firstColumn,
+                            int endColumn,
+                            const Style& style);
+
+    RasterBackend backend = RasterBackend::direct;
+};
+
+} // namespace wvfrm
@@ -0,0 +1,79 @@
+#include "FrameArena.h"
+
+#include <cstdint>
+
+namespace wvfrm
+{
+
+namespace
+{
+size_t alignUp(size_t offset, size_t alignment) noexcept
+{
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+void* alignPointer(std::byte* base, size_t alignment) noexcept
+{
+    const auto address = reinterpret_cast<uintptr_t>(base);
+    return base + (alignUp(address, alignment) - address);
+}
+} // namespace
+
+void FrameArena::reserve(size_t bytes)
+{
+    jassert(used == 0 && overflow.empty());
+
+    if (bytes <= capacity)
+        return;
+
+    block = std::make_unique<std::byte[]>(bytes);
+    capacity = bytes;
+}
+
+void FrameArena::reset()
+{
+    used = 0;
+
+    if (overflow.empty())
+        return;
+
+    // Last frame outgrew the block; next time everything it needed fits in one.
+    const auto needed = capacity + overflowBytes;
+    overflow.clear();
+    overflowBytes = 0;
+    reserve(needed);
+}
+
+size_t FrameArena::getCapacity() const noexcept
+{
+    return capacity;
+}
+
+size_t FrameArena::getBytesUsed() const noexcept
+{
+    return used + overflowBytes;
+}
+
+void* FrameArena::allocateBytes(size_t bytes, size_t alignment)
+{
+    jassert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    if (block != nullptr)
+    {
+        const auto base = reinterpret_cast<uintptr_t>(block.get());
+        const auto offset = alignUp(base + used, alignment) - base;
+
+        if (offset + bytes <= capacity)
+        {
+            used = offset + bytes;
+            return block.get() + offset;
+        }
+    }
+
+    const auto padded = bytes + alignment;
+    overflow.push_back(std::make_unique<std::byte[]>(padded));
+    overflowBytes += padded;
+    return alignPointer(overflow.back().get(), alignment);
+}
+
+} // namespace wvfrm
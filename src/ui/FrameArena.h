@@ -0,0 +1,58 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace wvfrm
+{
+
+// Scratch for one frame at a time. allocate() hands out slices of a single block and reset()
+// takes them all back at the start of the next frame, so a steady frame costs no heap traffic.
+// reserve() sizes the block when the view is resized; a frame that still needs more is served
+// from overflow blocks, which the next reset() folds into one larger block. Only trivially
+// destructible types, and everything handed out is gone after reset().
+class FrameArena
+{
+public:
+    FrameArena() = default;
+
+    // Grows the block to at least bytes; only between frames.
+    void reserve(size_t bytes);
+
+    void reset();
+
+    // count value-initialised Ts.
+    template <typename T>
+    T* allocate(size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "FrameArena never runs destructors");
+
+        auto* items = static_cast<T*>(allocateBytes(sizeof(T) * count, alignof(T)));
+        for (size_t i = 0; i < count; ++i)
+            new (items + i) T();
+
+        return items;
+    }
+
+    size_t getCapacity() const noexcept;
+    size_t getBytesUsed() const noexcept;
+
+private:
+    void* allocateBytes(size_t bytes, size_t alignment);
+
+    std::unique_ptr<std::byte[]> block;
+    size_t capacity = 0;
+    size_t used = 0;
+
+    std::vector<std::unique_ptr<std::byte[]>> overflow;
+    size_t overflowBytes = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(FrameArena)
+};
+
+} // namespace wvfrm
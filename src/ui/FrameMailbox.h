@@ -0,0 +1,75 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace wvfrm
+{
+
+// Triple-buffered handoff of whole frames from exactly one producer thread to exactly one
+// consumer thread. The producer fills back() and publishes it, the consumer fetches and reads
+// front(); the third frame sits in between. Neither side ever waits for the other: publishing
+// over a frame the consumer never fetched drops it, so the consumer always gets the newest.
+template <typename Frame>
+class FrameMailbox
+{
+public:
+    FrameMailbox() = default;
+
+    // Producer. The frame to fill next; it keeps whatever it held the last time it came round,
+    // so buffers inside it can be reused.
+    Frame& back() noexcept
+    {
+        return frames[static_cast<size_t>(backIndex)];
+    }
+
+    // Producer. Hands back() over and takes the in-between frame as the next one to fill.
+    void publish() noexcept
+    {
+        const auto previous = middle.exchange(backIndex | freshBit, std::memory_order_acq_rel);
+        if ((previous & freshBit) != 0)
+            dropped.fetch_add(1, std::memory_order_relaxed);
+
+        backIndex = previous & indexMask;
+    }
+
+    // Consumer. Takes the newest published frame as front(); false when nothing was published
+    // since the last fetch, in which case front() is unchanged.
+    bool fetch() noexcept
+    {
+        if ((middle.load(std::memory_order_relaxed) & freshBit) == 0)
+            return false;
+
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    // Consumer.
+    const Frame& front() const noexcept
+    {
+        return frames[static_cast<size_t>(frontIndex)];
+    }
+
+    // Any thread. Frames published but replaced before the consumer fetched them.
+    uint64_t getDroppedFrames() const noexcept
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int freshBit = 4;
+
+    std::array<Frame, 3> frames {};
+    int backIndex = 0;
+    int frontIndex = 1;
+    alignas(64) std::atomic<int> middle { 2 };
+    std::atomic<uint64_t> dropped { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(FrameMailbox)
+};
+
+} // namespace wvfrm
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+
+#include <atomic>
+
+#include "../dsp/AnalysisRingBuffer.h"
+#include "../dsp/AnalysisRingHost.h"
+#include "../dsp/BandEnergyRing.h"
+#include "../dsp/BlockSummary.h"
+#include "../dsp/TimeWindowResolver.h"
+
+namespace wvfrm
+{
+
+// Everything the waveform renderer reads from outside: the loop window and clock, the analysis
+// ring's lookups, the block summaries and the view's parameters. The processor provides it in
+// the plugin; tests render frames against one of their own.
+class RenderSource
+{
+public:
+    struct LoopRenderFrame
+    {
+        AnalysisRingBuffer::ReadSpans spans;
+        float phaseNormalized = 0.0f;
+        bool phaseReliable = false;
+        int64_t phaseSample = 0;
+        bool isPlaying = false;
+        double bpmUsed = 120.0;
+        bool resetSuggested = false;
+    };
+
+    virtual ~RenderSource() = default;
+
+    // Raw value of a view parameter, looked up once; null when the source has none, in which
+    // case the renderer uses the parameter's default.
+    virtual const std::atomic<float>* getViewParameter(const char* parameterID) const noexcept = 0;
+    virtual juce::AudioChannelSet getCaptureLayout() const = 0;
+
+    virtual TimeWindowResolver::ResolvedWindow resolveCurrentWindow() const noexcept = 0;
+    virtual bool getLoopRenderFrame(LoopRenderFrame& out, int requestedSamples) const = 0;
+
+    // Readers off the message thread hold one of these across every analysis read, spans
+    // included, so a ring swap cannot free the storage under them.
+    virtual AnalysisRingHost::ReadScope pinAnalysis() const noexcept = 0;
+    virtual bool isAnalysisReadCurrent(const AnalysisRingBuffer::ReadSpans& spans) const noexcept = 0;
+    virtual bool copyAnalysisWindow(juce::AudioBuffer<float>& destination,
+                                    int numSamples,
+                                    int64_t endSample,
+                                    int64_t& firstSample) const = 0;
+    virtual bool getPeakRange(int channel,
+                              int64_t startSample,
+                              int64_t endSample,
+                              float& minimum,
+                              float& maximum) const noexcept = 0;
+    virtual bool getBandEnergies(BandEnergyRing::Lane lane,
+                                 int channel,
+                                 int64_t startSample,
+                                 int64_t endSample,
+                                 BandEnergies& energies) const noexcept = 0;
+
+    virtual double getCurrentSampleRateHz() const noexcept = 0;
+    // Rate of the stream held in the analysis ring; below the host rate when decimating.
+    virtual double getAnalysisSampleRateHz() const noexcept = 0;
+    virtual int getAnalysisCapacity() const noexcept = 0;
+
+    // Single consumer: only the renderer may drain the summary queue.
+    virtual int drainBlockSummaries(BlockSummaryHistory& history) noexcept = 0;
+
+    // The renderer is attached for as long as it exists. With nothing attached, summaries are not
+    // published at all, so an editor left closed doesn't pile them up as dropped; attaching
+    // discards whatever the previous renderer left unread.
+    virtual void setSummaryConsumerAttached(bool attached) noexcept = 0;
+};
+
+} // namespace wvfrm
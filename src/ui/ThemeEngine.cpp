@@ -27,11 +27,20 @@ juce::Colour ThemeEngine::colourFor(BandEnergies energies,
                                     float intensityPercent,
                                     float amplitudeNorm,
                                     float colorMatchPercent) const noexcept
+{
+    return baseColourFor(energies, theme, mode, intensityPercent, colorMatchPercent)
+        .withMultipliedBrightness(brightnessFor(mode, intensityPercent, amplitudeNorm))
+        .withAlpha(alphaFor(mode, amplitudeNorm));
+}
+
+juce::Colour ThemeEngine::baseColourFor(BandEnergies energies,
+                                        ThemePreset theme,
+                                        ColorMode mode,
+                                        float intensityPercent,
+                                        float colorMatchPercent) const noexcept
 {
     const auto intensity = juce::jlimit(0.0f, 1.0f, intensityPercent / 100.0f);
-    const auto amp = juce::jlimit(0.0f, 1.0f, amplitudeNorm);
     const auto colorMatch = juce::jlimit(0.0f, 1.0f, colorMatchPercent / 100.0f);
-    const auto ampShaped = std::sqrt(amp);
 
     if (mode == ColorMode::threeBand)
     {
@@ -39,25 +48,46 @@ juce::Colour ThemeEngine::colourFor(BandEnergies energies,
 
         const auto canonical = blendThreeBand(energies, ThemePreset::minimeters3Band);
         const auto styled = blendThreeBand(energies, theme);
-        auto base = styled.interpolatedWith(canonical, colorMatch);
+        const auto base = styled.interpolatedWith(canonical, colorMatch);
 
-        const auto saturation = juce::jlimit(0.7f, 1.4f, 0.9f + 0.45f * intensity);
-        const auto brightness = juce::jlimit(0.05f, 1.0f, (0.62f + 0.38f * intensity) * (0.45f + 0.60f * ampShaped));
-        const auto alpha = juce::jlimit(0.1f, 1.0f, 0.12f + 0.88f * ampShaped);
-
-        return base.withMultipliedSaturation(saturation)
-                   .withMultipliedBrightness(brightness)
-                   .withAlpha(alpha);
+        return base.withMultipliedSaturation(juce::jlimit(0.7f, 1.4f, 0.9f + 0.45f * intensity));
     }
 
-    auto base = colourFromPreset(theme);
-    const auto saturation = juce::jlimit(0.1f, 1.0f, 0.35f + 0.65f * intensity);
-    const auto brightness = juce::jlimit(0.05f, 1.0f, (0.45f + 0.55f * intensity) * (0.5f + 0.5f * ampShaped));
-    const auto alpha = juce::jlimit(0.12f, 1.0f, 0.2f + 0.8f * ampShaped);
+    return colourFromPreset(theme).withMultipliedSaturation(juce::jlimit(0.1f, 1.0f, 0.35f + 0.65f * intensity));
+}
+
+float ThemeEngine::brightnessFor(ColorMode mode, float intensityPercent, float amplitudeNorm) noexcept
+{
+    const auto intensity = juce::jlimit(0.0f, 1.0f, intensityPercent / 100.0f);
+    const auto ampShaped = std::sqrt(juce::jlimit(0.0f, 1.0f, amplitudeNorm));
+
+    if (mode == ColorMode::threeBand)
+        return juce::jlimit(0.05f, 1.0f, (0.62f + 0.38f * intensity) * (0.45f + 0.60f * ampShaped));
+
+    return juce::jlimit(0.05f, 1.0f, (0.45f + 0.55f * intensity) * (0.5f + 0.5f * ampShaped));
+}
+
+float ThemeEngine::alphaFor(ColorMode mode, float amplitudeNorm) noexcept
+{
+    const auto ampShaped = std::sqrt(juce::jlimit(0.0f, 1.0f, amplitudeNorm));
 
-    return base.withMultipliedSaturation(saturation)
-               .withMultipliedBrightness(brightness)
-               .withAlpha(alpha);
+    if (mode == ColorMode::threeBand)
+        return juce::jlimit(0.1f, 1.0f, 0.12f + 0.88f * ampShaped);
+
+    return juce::jlimit(0.12f, 1.0f, 0.2f + 0.8f * ampShaped);
+}
+
+float ThemeEngine::shapeBandIntensity(float normalizedEnergy, float intensityPercent) noexcept
+{
+    const auto clamped = juce::jlimit(0.0f, 1.0f, normalizedEnergy);
+
+    // Log compression keeps tails visible without clipping strong peaks.
+    constexpr auto compressionAmount = 8.0f;
+    const auto compressed = std::log1p(compressionAmount * clamped) / std::log1p(compressionAmount);
+
+    const auto intensity = juce::jlimit(0.0f, 1.0f, intensityPercent / 100.0f);
+    const auto gamma = juce::jmap(intensity, 0.0f, 1.0f, 1.05f, 0.78f);
+    return std::pow(juce::jlimit(0.0f, 1.0f, compressed), gamma);
 }
 
 juce::Colour ThemeEngine::colourFromPreset(ThemePreset theme) noexcept
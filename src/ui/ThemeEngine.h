@@ -17,6 +17,20 @@ public:
                            float amplitudeNorm,
                            float colorMatchPercent) const noexcept;
 
+    // colourFor() in two steps: the colour the energies map to, saturated for the intensity,
+    // then that colour's brightness scaled and alpha set for the column's amplitude. The first
+    // step is the costly one and what a ColourLut tabulates.
+    juce::Colour baseColourFor(BandEnergies energies,
+                               ThemePreset theme,
+                               ColorMode mode,
+                               float intensityPercent,
+                               float colorMatchPercent) const noexcept;
+    static float brightnessFor(ColorMode mode, float intensityPercent, float amplitudeNorm) noexcept;
+    static float alphaFor(ColorMode mode, float amplitudeNorm) noexcept;
+
+    // How a band's energy, as a fraction of its normalization peak, drives its colour channel.
+    static float shapeBandIntensity(float normalizedEnergy, float intensityPercent) noexcept;
+
 private:
     static juce::Colour colourFromPreset(ThemePreset theme) noexcept;
     static juce::Colour blendThreeBand(const BandEnergies& energies, ThemePreset theme) noexcept;
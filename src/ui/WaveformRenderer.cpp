@@ -0,0 +1,1406 @@
+#include "WaveformRenderer.h"
+
+#include "../dsp/ChannelViews.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace wvfrm
+{
+
+namespace
+{
+constexpr float minimetersLineThickness = 1.15f;
+constexpr float defaultLineThickness = 1.35f;
+constexpr float minGlowExtraThickness = 0.3f;
+constexpr float maxGlowExtraThickness = 2.6f;
+constexpr double colourAnalysisWindowSeconds = 0.012;
+constexpr int pyramidMinSegmentSamples = 64;
+constexpr int summaryMinRecordsPerColumn = 4;
+constexpr float peakFloor = 1.0e-4f;
+
+// Columns either side of a redrawn one that its glow and antialiasing can reach.
+constexpr int rasterReachColumns = 3;
+
+// Half a step of an 8-bit colour channel at the scale a band is shown at: an eased value this
+// close to where it is heading no longer changes what is drawn.
+constexpr float settleTolerance = 1.0f / 512.0f;
+
+bool stillEasing(float value, float target, float fullScale) noexcept
+{
+    return std::abs(value - target) > settleTolerance * fullScale;
+}
+
+juce::Colour backgroundColour()
+{
+    return juce::Colour::fromRGB(4, 4, 6);
+}
+
+int64_t floorDiv(int64_t value, int64_t divisor) noexcept
+{
+    const auto quotient = value / divisor;
+    return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+struct ColumnRange
+{
+    int64_t start = 0;
+    int64_t end = 0;
+};
+
+// The absolute range column x shows: this cycle's samples once the head has reached the column,
+// the previous cycle's until then. Every column shows at least one sample.
+// Scrolling, absolute column k shows samples [k * cycleLength / width, (k + 1) * cycleLength /
+// width), clipped to the window, so a column keeps its range from the frame it appears in to the
+// frame it scrolls off, and only the newest one grows as samples arrive.
+ColumnRange scrollColumnRange(int64_t column, int width, int64_t cycleLength, int64_t windowStart, int64_t head) noexcept
+{
+    ColumnRange range;
+    range.start = floorDiv(column * cycleLength, width);
+    range.end = juce::jmax(range.start + 1, floorDiv((column + 1) * cycleLength, width));
+    range.start = juce::jmax(range.start, windowStart);
+    range.end = juce::jmin(range.end, head);
+    return range;
+}
+
+ColumnRange loopColumnRange(int x, int width, int64_t cycleStart, int64_t cycleLength, int64_t head) noexcept
+{
+    ColumnRange range;
+    range.start = cycleStart + static_cast<int64_t>(x) * cycleLength / width;
+    range.end = juce::jmax(range.start + 1, cycleStart + static_cast<int64_t>(x + 1) * cycleLength / width);
+
+    if (range.start >= head)
+    {
+        range.start -= cycleLength;
+        range.end -= cycleLength;
+    }
+    else
+    {
+        range.end = juce::jmin(range.end, head);
+    }
+
+    return range;
+}
+
+// Zoomed in past a sample per column, column x traces the signal between the fractional
+// positions left and right. Its range is every sample the interpolation taps around those read,
+// clipped to the window, so the column is traced again until the last of them has arrived.
+struct TraceSpan
+{
+    double left = 0.0;
+    double right = 0.0;
+    ColumnRange range;
+};
+
+TraceSpan traceColumnSpan(double left, double columnLength, int64_t windowStart, int64_t head) noexcept
+{
+    TraceSpan span;
+    span.left = left;
+    span.right = span.left + columnLength;
+    span.range.start = juce::jmax(windowStart, static_cast<int64_t>(std::floor(span.left)) - (SincInterpolator::halfTaps - 1));
+    span.range.end = juce::jmin(head, static_cast<int64_t>(std::floor(span.right)) + SincInterpolator::halfTaps + 1);
+    return span;
+}
+
+float smoothToward(float previous, float target, double dtSeconds, double attackTauSeconds, double releaseTauSeconds)
+{
+    const auto tau = target > previous ? attackTauSeconds : releaseTauSeconds;
+    const auto alpha = std::exp(-dtSeconds / tau);
+    return static_cast<float>(alpha * static_cast<double>(previous)
+                              + (1.0 - alpha) * static_cast<double>(target));
+}
+
+juce::Range<float> spanMinMax(const AnalysisRingBuffer::ReadSpans& source, int channel, int start, int end) noexcept
+{
+    auto minimum = std::numeric_limits<float>::max();
+    auto maximum = -std::numeric_limits<float>::max();
+
+    const auto firstEnd = juce::jmin(end, source.firstSize);
+    if (start < firstEnd)
+    {
+        const auto range = juce::FloatVectorOperations::findMinAndMax(source.firstSpan(channel) + start, firstEnd - start);
+        minimum = range.getStart();
+        maximum = range.getEnd();
+    }
+
+    const auto secondStart = juce::jmax(start, source.firstSize);
+    if (secondStart < end)
+    {
+        const auto range = juce::FloatVectorOperations::findMinAndMax(source.secondSpan(channel) + (secondStart - source.firstSize),
+                                                                      end - secondStart);
+        minimum = juce::jmin(minimum, range.getStart());
+        maximum = juce::jmax(maximum, range.getEnd());
+    }
+
+    return { minimum, maximum };
+}
+
+// Points straight into ring storage unless [start, start + length) straddles the wrap.
+const float* contiguousSamples(const AnalysisRingBuffer::ReadSpans& source,
+                               int channel,
+                               int start,
+                               int length,
+                               float* scratchSamples) noexcept
+{
+    if (start + length <= source.firstSize)
+        return source.firstSpan(channel) + start;
+
+    if (start >= source.firstSize)
+        return source.secondSpan(channel) + (start - source.firstSize);
+
+    const auto head = source.firstSize - start;
+    juce::FloatVectorOperations::copy(scratchSamples, source.firstSpan(channel) + start, head);
+    juce::FloatVectorOperations::copy(scratchSamples + head, source.secondSpan(channel), length - head);
+    return scratchSamples;
+}
+
+// Copies pixel columns [pixelStart, pixelEnd) of every row of source into destination from row
+// destinationY down, clipped to destination.
+void copyPixels(const juce::Image& source, juce::Image& destination, int destinationY, int pixelStart, int pixelEnd)
+{
+    pixelEnd = juce::jmin(pixelEnd, source.getWidth(), destination.getWidth());
+    const auto rows = juce::jmin(source.getHeight(), destination.getHeight() - destinationY);
+    if (! source.isValid() || pixelStart >= pixelEnd || rows <= 0 || destinationY < 0)
+        return;
+
+    const juce::Image::BitmapData from(source, juce::Image::BitmapData::readOnly);
+    juce::Image::BitmapData to(destination, juce::Image::BitmapData::writeOnly);
+
+    for (int y = 0; y < rows; ++y)
+    {
+        std::memcpy(to.getPixelPointer(pixelStart, destinationY + y),
+                    from.getPixelPointer(pixelStart, y),
+                    static_cast<size_t>((pixelEnd - pixelStart) * from.pixelStride));
+    }
+}
+
+ColumnRasterizer::Style lineStyle(ColorMode colorMode, float colorMatch)
+{
+    const auto coreThickness = colorMode == ColorMode::threeBand
+        ? juce::jmap(colorMatch, defaultLineThickness, minimetersLineThickness)
+        : defaultLineThickness;
+
+    ColumnRasterizer::Style style;
+    style.coreThickness = coreThickness;
+
+    if (colorMode == ColorMode::threeBand && colorMatch > 0.0f)
+    {
+        style.glowThickness = coreThickness + juce::jmap(colorMatch, 0.0f, 1.0f, minGlowExtraThickness, maxGlowExtraThickness);
+        style.glowAlpha = juce::jmap(colorMatch, 0.0f, 1.0f, 0.10f, 0.42f);
+    }
+
+    return style;
+}
+}
+
+WaveformRenderer::WaveformRenderer(RenderSource& sourceToUse)
+    : juce::Thread("wvfrm render"),
+      processor(sourceToUse)
+{
+    channelViewValue = processor.getViewParameter(ParamIDs::channelView);
+    colorModeValue = processor.getViewParameter(ParamIDs::colorMode);
+    themePresetValue = processor.getViewParameter(ParamIDs::themePreset);
+    themeIntensityValue = processor.getViewParameter(ParamIDs::themeIntensity);
+    smoothingValue = processor.getViewParameter(ParamIDs::smoothing);
+    colorMatchValue = processor.getViewParameter(ParamIDs::colorMatch);
+    waveGainVisualValue = processor.getViewParameter(ParamIDs::waveGainVisual);
+    rasterBackendValue = processor.getViewParameter(ParamIDs::rasterBackend);
+    waveLoopValue = processor.getViewParameter(ParamIDs::waveLoop);
+
+    lanes.resize(static_cast<size_t>(tilePool.getNumLanes()));
+    publishColourLut();
+    processor.setSummaryConsumerAttached(true);
+    startThread();
+}
+
+WaveformRenderer::~WaveformRenderer()
+{
+    stopThread(1000);
+    processor.setSummaryConsumerAttached(false);
+}
+
+void WaveformRenderer::requestFrame(juce::Rectangle<int> viewBounds, float scale)
+{
+    publishColourLut();
+    requestedWidth.store(viewBounds.getWidth(), std::memory_order_relaxed);
+    requestedHeight.store(viewBounds.getHeight(), std::memory_order_relaxed);
+    requestedScale.store(juce::jmax(1.0f, scale), std::memory_order_relaxed);
+    notify();
+}
+
+void WaveformRenderer::publishColourLut()
+{
+    const ColourLut::Settings look { static_cast<ThemePreset>(getChoiceIndex(themePresetValue)),
+                                     static_cast<ColorMode>(getChoiceIndex(colorModeValue)),
+                                     getFloatValue(themeIntensityValue, 100.0f),
+                                     getFloatValue(colorMatchValue, 100.0f) };
+
+    if (lookPublished && look == publishedLook)
+        return;
+
+    // The slot we get back may still hold this look from an earlier round; prepare skips it then.
+    colourLuts.back().prepare(themeEngine, look);
+    colourLuts.publish();
+    publishedLook = look;
+    lookPublished = true;
+}
+
+void WaveformRenderer::noteHidden() noexcept
+{
+    restartSmoothing.store(true, std::memory_order_relaxed);
+}
+
+bool WaveformRenderer::fetchFrame() noexcept
+{
+    return frames.fetch();
+}
+
+const WaveformRenderer::Frame& WaveformRenderer::currentFrame() const noexcept
+{
+    return frames.front();
+}
+
+uint64_t WaveformRenderer::getDroppedFrames() const noexcept
+{
+    return frames.getDroppedFrames();
+}
+
+void WaveformRenderer::run()
+{
+    while (! threadShouldExit())
+    {
+        // Requests only ever wake us; a frame is built from whatever the latest one asked for.
+        if (! wait(100))
+            continue;
+
+        if (threadShouldExit())
+            break;
+
+        const auto width = requestedWidth.load(std::memory_order_relaxed);
+        const auto height = requestedHeight.load(std::memory_order_relaxed);
+        if (width <= 0 || height <= 0)
+            continue;
+
+        // A frame that stopped short keeps whatever image it held from three frames ago; the view
+        // goes on showing the last finished one instead.
+        if (renderFrame(frames.back(), width, height, requestedScale.load(std::memory_order_relaxed)))
+            frames.publish();
+    }
+}
+
+bool WaveformRenderer::renderFrame(Frame& frame, int viewWidth, int viewHeight, float scale)
+{
+    auto contentBounds = juce::Rectangle<int>(viewWidth, viewHeight).reduced(8);
+
+    frame.scale = scale;
+    frame.contentBounds = contentBounds;
+    frame.hasAudio = false;
+    frame.tracks.clear();
+    frame.columnsAnalysed = 0;
+    frame.columnsRasterized = 0;
+    frame.settling = false;
+    frame.sequence = ++frameSequence;
+    frame.wholeFrameDirty = true;
+    frame.dirty.clear();
+    frameArena.reset();
+
+    // A frame that stops short leaves its image as it was, so the next one starts from nothing.
+    const auto previousContentBounds = std::exchange(lastContentBounds, {});
+    const auto previousScale = std::exchange(lastFrameScale, 0.0f);
+    tiles = nullptr;
+    numTiles = 0;
+
+    if (restartSmoothing.exchange(false, std::memory_order_relaxed))
+    {
+        wasVisibleForTemporalState = false;
+        lastColourFrameTimeSec = 0.0;
+    }
+
+    // Every span and ring lookup below reads ring storage; keep it from being freed meanwhile.
+    const auto pin = processor.pinAnalysis();
+
+    const auto resolved = processor.resolveCurrentWindow();
+    const auto sampleRate = processor.getAnalysisSampleRateHz();
+
+    // Cover the same span as the analysis ring; records taken at another rate can't be mixed in.
+    const auto summaryRecords = juce::jmax(1, processor.getAnalysisCapacity() / BlockSummarizer::defaultSamplesPerSummary);
+    if (summaryRecords != summaryHistory.getCapacityRecords() || ! juce::exactlyEqual(sampleRate, summaryHistoryRate))
+    {
+        summaryHistory.prepare(summaryRecords, BlockSummarizer::defaultSamplesPerSummary);
+        summaryHistoryRate = sampleRate;
+    }
+
+    // Only the records published since the last frame are new work; the history keeps the rest.
+    processor.drainBlockSummaries(summaryHistory);
+
+    const auto requestedSamples = juce::jlimit(128,
+                                               juce::jmax(128, processor.getAnalysisCapacity()),
+                                               static_cast<int>(std::round(resolved.ms * sampleRate / 1000.0)));
+
+    RenderSource::LoopRenderFrame loopFrame;
+    if (! processor.getLoopRenderFrame(loopFrame, requestedSamples))
+        return true; // nothing to show yet, which the view says as it is
+
+    frame.hasAudio = true;
+
+    if (loopFrame.spans.needsDecode())
+    {
+        // Compact ring storage: decode this frame's window once and let every track share it.
+        int64_t firstSample = 0;
+        const auto& window = loopFrame.spans;
+
+        // Sized for the whole window up front: while the ring is still filling it the copy grows
+        // by a block a frame, and each of those would otherwise reallocate.
+        scratch.setSize(window.numChannels, requestedSamples, false, false, true);
+        if (! processor.copyAnalysisWindow(scratch, window.numSamples, window.startSample + window.numSamples, firstSample))
+            return false;
+
+        loopFrame.spans = AnalysisRingBuffer::ReadSpans::fromBuffer(scratch, firstSample);
+    }
+
+    // The look comes from whichever table the message thread finished last, so every column in
+    // this frame is coloured and styled for the same settings.
+    colourLuts.fetch();
+    const auto& look = colourLuts.front().getSettings();
+
+    const auto channelMode = static_cast<ChannelView>(getChoiceIndex(channelViewValue));
+    const auto colorMode = look.mode;
+    const auto smoothing = getFloatValue(smoothingValue, 35.0f) / 100.0f;
+    const auto colorMatch = look.colorMatchPercent / 100.0f;
+    const auto gainDb = getFloatValue(waveGainVisualValue, 0.0f);
+    const auto gainLinear = juce::Decibels::decibelsToGain(gainDb);
+    const auto loopPhase = juce::jlimit(0.0f, 1.0f, loopFrame.phaseNormalized);
+    const auto threeBandEnabled = colorMode == ColorMode::threeBand;
+    const auto scrolling = ! getBoolValue(waveLoopValue, true);
+    const auto temporalEnabled = threeBandEnabled && ! scrolling; // scrolled columns are coloured once
+    rasterizer.setBackend(static_cast<RasterBackend>(getChoiceIndex(rasterBackendValue)));
+
+    const auto nowSeconds = juce::Time::getMillisecondCounterHiRes() * 0.001;
+    auto dtSeconds = 1.0 / 60.0;
+    if (lastColourFrameTimeSec > 0.0)
+        dtSeconds = juce::jlimit(1.0 / 240.0, 1.0 / 15.0, nowSeconds - lastColourFrameTimeSec);
+
+    lastColourFrameTimeSec = nowSeconds;
+
+    updateTrackDescriptors(channelMode, loopFrame.spans.numChannels);
+    const auto& tracks = trackDescriptors;
+
+    if (tracks.empty())
+    {
+        frame.hasAudio = false; // no channels to draw, so it shows as waiting
+        return true;
+    }
+
+    auto resetAllTemporalState = loopFrame.resetSuggested
+        || ! wasVisibleForTemporalState
+        || (temporalEnabled != lastThreeBandTemporalEnabled);
+
+    if (temporalEnergiesByTrack.size() != tracks.size()
+        || temporalInitByTrack.size() != tracks.size()
+        || normalizationPeakByTrack.size() != tracks.size()
+        || normalizationPeakInitByTrack.size() != tracks.size()
+        || temporalTrackModes.size() != tracks.size()
+        || temporalTrackChannels.size() != tracks.size())
+    {
+        temporalEnergiesByTrack.assign(tracks.size(), {});
+        temporalInitByTrack.assign(tracks.size(), {});
+        normalizationPeakByTrack.assign(tracks.size(), {});
+        normalizationPeakInitByTrack.assign(tracks.size(), static_cast<uint8_t>(0));
+        temporalTrackModes.assign(tracks.size(), RenderMode::channel);
+        temporalTrackChannels.assign(tracks.size(), 0);
+        trackCaches.assign(tracks.size(), {});
+        resetAllTemporalState = true;
+    }
+
+    const auto trackRenderWidth = juce::jmax(1, contentBounds.getWidth());
+    reserveFrameArena(trackRenderWidth, static_cast<int>(tracks.size()));
+
+    auto* resetTemporalByTrack = frameArena.allocate<uint8_t>(tracks.size());
+    std::fill(resetTemporalByTrack, resetTemporalByTrack + tracks.size(), static_cast<uint8_t>(resetAllTemporalState ? 1 : 0));
+
+    for (size_t i = 0; i < tracks.size(); ++i)
+    {
+        if (temporalTrackModes[i] != tracks[i].mode || temporalTrackChannels[i] != tracks[i].channel)
+        {
+            temporalTrackModes[i] = tracks[i].mode;
+            temporalTrackChannels[i] = tracks[i].channel;
+            resetTemporalByTrack[i] = static_cast<uint8_t>(1);
+            trackCaches[i].invalidate();
+        }
+
+        if (temporalEnergiesByTrack[i].size() != static_cast<size_t>(trackRenderWidth)
+            || temporalInitByTrack[i].size() != static_cast<size_t>(trackRenderWidth))
+        {
+            temporalEnergiesByTrack[i].assign(static_cast<size_t>(trackRenderWidth));
+            temporalInitByTrack[i].assign(static_cast<size_t>(trackRenderWidth), static_cast<uint8_t>(0));
+            resetTemporalByTrack[i] = static_cast<uint8_t>(1);
+        }
+    }
+
+    // Columns are pinned to the loop rather than to the newest sample, so a column the write head
+    // has passed shows the same samples frame after frame and only what it passed is new work.
+    settings.source = loopFrame.spans;
+    settings.width = trackRenderWidth;
+    settings.scale = scale;
+    settings.cycleStart = anchorLoopCycle(loopFrame.spans, loopPhase, trackRenderWidth);
+    settings.scrolling = scrolling;
+
+    // Scrolling, the newest column is the one holding the window's last sample.
+    const auto windowEnd = loopFrame.spans.startSample + loopFrame.spans.numSamples;
+    settings.firstScrollColumn = floorDiv(windowEnd * trackRenderWidth - 1, juce::jmax(1, loopFrame.spans.numSamples)) - (trackRenderWidth - 1);
+    settings.colorMode = colorMode;
+    settings.colorMatch = colorMatch;
+    settings.gainLinear = gainLinear;
+    settings.smoothing = smoothing;
+    settings.dtSeconds = dtSeconds;
+
+    // Colour smoothing eases by one of two factors a frame, whichever way each band moved.
+    const auto attackMs = juce::jmap(smoothing, 0.0f, 1.0f, 18.0f, 60.0f) + juce::jmap(colorMatch, 0.0f, 1.0f, 0.0f, 42.0f);
+    const auto releaseMs = juce::jmap(smoothing, 0.0f, 1.0f, 120.0f, 360.0f) + juce::jmap(colorMatch, 0.0f, 1.0f, 0.0f, 220.0f);
+    settings.attackAlpha = static_cast<float>(std::exp(-dtSeconds / juce::jmax(1.0e-4, static_cast<double>(attackMs) * 0.001)));
+    settings.releaseAlpha = static_cast<float>(std::exp(-dtSeconds / juce::jmax(1.0e-4, static_cast<double>(releaseMs) * 0.001)));
+    settings.analysisRate = processor.getAnalysisSampleRateHz();
+    settings.decimated = settings.analysisRate < processor.getCurrentSampleRateHz();
+    settings.colourWindowSamples = juce::jlimit(64,
+                                                juce::jmin(2048, loopFrame.spans.numSamples),
+                                                static_cast<int>(std::round(settings.analysisRate * colourAnalysisWindowSeconds)));
+    settings.detail = detailFor(loopFrame.spans.numSamples, trackRenderWidth);
+    settings.blurColors = (loopFrame.phaseReliable || scrolling) && ! loopFrame.resetSuggested && threeBandEnabled && colorMatch > 0.0f;
+    settings.style = lineStyle(colorMode, colorMatch);
+    settings.backend = rasterizer.getBackend();
+
+    const auto imageWidth = juce::roundToInt(static_cast<float>(trackRenderWidth) * scale);
+    const auto imageHeight = juce::jmax(1, juce::roundToInt(static_cast<float>(contentBounds.getHeight()) * scale));
+    if (frame.image.getWidth() != imageWidth || frame.image.getHeight() != imageHeight)
+        frame.image = juce::Image(juce::Image::ARGB, imageWidth, imageHeight, true, juce::SoftwareImageType());
+
+    const auto trackHeight = contentBounds.getHeight() / static_cast<int>(tracks.size());
+    trackFrames.resize(tracks.size());
+    auto scrolled = false;
+
+    for (size_t i = 0; i < tracks.size(); ++i)
+    {
+        auto trackBounds = contentBounds.removeFromTop(trackHeight);
+
+        if (i == tracks.size() - 1 && ! contentBounds.isEmpty())
+            trackBounds = trackBounds.withHeight(trackBounds.getHeight() + contentBounds.getHeight());
+
+        auto& trackFrame = trackFrames[i];
+        trackFrame.descriptor = tracks[i];
+        trackFrame.bounds = trackBounds;
+        trackFrame.imageY = juce::roundToInt(static_cast<float>(trackBounds.getY() - frame.contentBounds.getY()) * scale);
+        trackFrame.resetTemporal = resetTemporalByTrack[i] != 0;
+        prepareAnalysis(trackCaches[i]);
+        scrolled = scrollCache(trackCaches[i]) || scrolled;
+    }
+
+    // Every track is cut into tiles of whole columns; each pass below runs its tiles on the pool,
+    // and a pass only starts once the previous one has finished every tile.
+    const auto tilesPerTrack = (trackRenderWidth + tileColumns - 1) / tileColumns;
+    numTiles = static_cast<int>(tracks.size()) * tilesPerTrack;
+    tiles = frameArena.allocate<Tile>(static_cast<size_t>(numTiles));
+
+    for (auto& laneState : lanes)
+        laneState.colourDerived = frameArena.allocate<float>(static_cast<size_t>(settings.colourWindowSamples * BandAnalyzer3::batchSize));
+
+    for (int i = 0; i < numTiles; ++i)
+    {
+        auto& tile = tiles[i];
+        tile.track = i / tilesPerTrack;
+        tile.firstColumn = (i % tilesPerTrack) * tileColumns;
+        tile.endColumn = juce::jmin(trackRenderWidth, tile.firstColumn + tileColumns);
+        tile.columnsAnalysed = 0;
+        tile.columnsRasterized = 0;
+        tile.columnsEasing = 0;
+        tile.dirtyPixelStart = 0;
+        tile.dirtyPixelEnd = 0;
+    }
+
+    auto analysePass = [this](int tileIndex, int lane) { analyseTile(tiles[tileIndex], lane); };
+    tilePool.run(numTiles, analysePass);
+
+    if (! settings.source.isOwnedCopy() && ! processor.isAnalysisReadCurrent(settings.source))
+    {
+        // The writer lapped the oldest columns while we read them in place; redo those from a
+        // private copy.
+        int64_t firstSample = 0;
+        const auto& window = settings.source;
+        scratch.setSize(window.numChannels, requestedSamples, false, false, true);
+        if (! processor.copyAnalysisWindow(scratch, window.numSamples, window.startSample + window.numSamples, firstSample))
+        {
+            for (auto& cache : trackCaches)
+                cache.invalidate();
+
+            return false;
+        }
+
+        for (auto& cache : trackCaches)
+        {
+            for (size_t x = 0; x < cache.analysed.size(); ++x)
+            {
+                if (cache.analysed[x] != 0)
+                    cache.columnStart[x] = -1;
+            }
+        }
+
+        settings.source = AnalysisRingBuffer::ReadSpans::fromBuffer(scratch, firstSample);
+        tilePool.run(numTiles, analysePass);
+    }
+
+    auto peaksEasing = false;
+    for (size_t i = 0; i < tracks.size(); ++i)
+    {
+        peaksEasing = updateNormalization(static_cast<int>(i)) || peaksEasing;
+        prepareImage(trackCaches[i], trackFrames[i].bounds.getHeight());
+    }
+
+    auto colourPass = [this](int tileIndex, int) { colourTile(tiles[tileIndex]); };
+    tilePool.run(numTiles, colourPass);
+
+    auto rasterPass = [this, &frame](int tileIndex, int) { rasterTile(tiles[tileIndex], frame.image); };
+    tilePool.run(numTiles, rasterPass);
+
+    for (int i = 0; i < numTiles; ++i)
+    {
+        const auto& tile = tiles[i];
+        frame.columnsAnalysed += tile.columnsAnalysed;
+        frame.columnsRasterized += tile.columnsRasterized;
+        frame.settling = frame.settling || tile.columnsEasing > 0;
+    }
+
+    // Scrolled columns are coloured once, so a peak still easing only reaches those to come.
+    frame.settling = frame.settling || (peaksEasing && ! scrolling);
+
+    for (const auto& trackFrame : trackFrames)
+        frame.tracks.push_back({ trackFrame.bounds, trackFrame.bounds.getX() + writeColumn(), trackFrame.descriptor.label });
+
+    // Only a frame laid out like the last full one can be shown by repainting what changed.
+    frame.wholeFrameDirty = frame.contentBounds != previousContentBounds || ! juce::exactlyEqual(scale, previousScale) || scrolled;
+    if (! frame.wholeFrameDirty)
+        collectDirtyRegions(frame);
+
+    lastContentBounds = frame.contentBounds;
+    lastFrameScale = scale;
+
+    wasVisibleForTemporalState = true;
+    lastThreeBandTemporalEnabled = temporalEnabled;
+    return true;
+}
+
+void WaveformRenderer::reserveFrameArena(int width, int numTracks)
+{
+    if (width == arenaWidth && numTracks == arenaTracks)
+        return;
+
+    arenaWidth = width;
+    arenaTracks = numTracks;
+
+    // Everything one frame of this shape takes: reset flags, tiles and each lane's colour
+    // windows at their longest, each with room to align.
+    const auto tilesPerTrack = static_cast<size_t>((width + tileColumns - 1) / tileColumns);
+    const auto tracks = static_cast<size_t>(numTracks);
+    const auto colourBytes = sizeof(float) * 2048 * BandAnalyzer3::batchSize;
+
+    frameArena.reserve(tracks + alignof(uint8_t)
+                       + sizeof(Tile) * tracks * tilesPerTrack + alignof(Tile)
+                       + (colourBytes + alignof(float)) * lanes.size());
+}
+
+void WaveformRenderer::collectDirtyRegions(Frame& frame) const
+{
+    // Tiles come track by track, left to right, so a run of neighbouring repaints becomes one area.
+    juce::Rectangle<int> pending;
+
+    for (int i = 0; i < numTiles; ++i)
+    {
+        const auto& tile = tiles[i];
+        if (tile.dirtyPixelStart >= tile.dirtyPixelEnd)
+            continue;
+
+        const auto& bounds = trackFrames[static_cast<size_t>(tile.track)].bounds;
+        const auto left = bounds.getX() + static_cast<int>(std::floor(static_cast<float>(tile.dirtyPixelStart) / settings.scale));
+        const auto right = bounds.getX() + static_cast<int>(std::ceil(static_cast<float>(tile.dirtyPixelEnd) / settings.scale));
+        const juce::Rectangle<int> area { left, bounds.getY(), right - left, bounds.getHeight() };
+
+        if (! pending.isEmpty() && pending.getY() == area.getY() && area.getX() <= pending.getRight())
+        {
+            pending = pending.getUnion(area);
+            continue;
+        }
+
+        if (! pending.isEmpty())
+            frame.dirty.push_back(pending);
+
+        pending = area;
+    }
+
+    if (! pending.isEmpty())
+        frame.dirty.push_back(pending);
+}
+
+void WaveformRenderer::ensureRenderBuffers(TrackCache& cache, int width) const
+{
+    const auto requiredSize = static_cast<size_t>(juce::jmax(1, width));
+
+    if (cache.energies.size() != requiredSize)
+    {
+        cache.columnStart.assign(requiredSize, -1);
+        cache.columnEnd.assign(requiredSize, -1);
+        cache.energies.assign(requiredSize);
+        cache.minimum.assign(requiredSize, 0.0f);
+        cache.maximum.assign(requiredSize, 0.0f);
+        cache.amplitude.assign(requiredSize, 0.0f);
+        cache.active.assign(requiredSize, static_cast<uint8_t>(0));
+        cache.analysed.assign(requiredSize, static_cast<uint8_t>(0));
+        cache.changed.assign(requiredSize, static_cast<uint8_t>(0));
+        cache.drawn.assign(requiredSize, {});
+        cache.target.assign(requiredSize, {});
+    }
+}
+
+int64_t WaveformRenderer::anchorLoopCycle(const AnalysisRingBuffer::ReadSpans& source, float loopPhase, int width)
+{
+    const auto cycleLength = static_cast<int64_t>(juce::jmax(1, source.numSamples));
+    const auto head = source.startSample + source.numSamples;
+    const auto estimate = static_cast<double>(head) - static_cast<double>(loopPhase) * static_cast<double>(cycleLength);
+
+    // The phase arrives as a float and follows the host clock; keep the previous anchor while it
+    // agrees to within half a column, so columns behind the head keep their exact ranges.
+    if (loopAnchorLength == cycleLength)
+    {
+        const auto cycleStart = loopAnchor + cycleLength * floorDiv(head - loopAnchor, cycleLength);
+        auto drift = estimate - static_cast<double>(cycleStart);
+        drift -= static_cast<double>(cycleLength) * std::round(drift / static_cast<double>(cycleLength));
+
+        if (std::abs(drift) <= juce::jmax(1.0, 0.5 * static_cast<double>(cycleLength) / juce::jmax(1, width)))
+            return cycleStart;
+    }
+
+    loopAnchor = static_cast<int64_t>(std::llround(estimate));
+    loopAnchorLength = cycleLength;
+    return loopAnchor + cycleLength * floorDiv(head - loopAnchor, cycleLength);
+}
+
+void WaveformRenderer::prepareAnalysis(TrackCache& cache) const
+{
+    ensureRenderBuffers(cache, settings.width);
+    std::fill(cache.analysed.begin(), cache.analysed.end(), static_cast<uint8_t>(0));
+
+    // The keys are copies of the settings they came from, so any change at all must invalidate.
+    if (! juce::exactlyEqual(settings.gainLinear, cache.analysedGain)
+        || ! juce::exactlyEqual(settings.smoothing, cache.analysedSmoothing)
+        || ! juce::exactlyEqual(settings.analysisRate, cache.analysedRate)
+        || settings.detail != cache.analysedDetail)
+    {
+        cache.invalidate();
+        cache.analysedGain = settings.gainLinear;
+        cache.analysedSmoothing = settings.smoothing;
+        cache.analysedRate = settings.analysisRate;
+        cache.analysedDetail = settings.detail;
+    }
+}
+
+bool WaveformRenderer::scrollCache(TrackCache& cache) const
+{
+    if (! settings.scrolling)
+    {
+        cache.scrollAligned = false;
+        return false;
+    }
+
+    const auto shift = settings.firstScrollColumn - cache.firstScrollColumn;
+    const auto wasAligned = std::exchange(cache.scrollAligned, true);
+    cache.firstScrollColumn = settings.firstScrollColumn;
+
+    // Nothing to move, or nothing on screen would survive the move; the column ranges then tell
+    // what has to be analysed again.
+    if (! wasAligned || shift <= 0 || shift >= settings.width)
+        return false;
+
+    const auto columns = static_cast<int>(shift);
+    auto shiftLeft = [columns](auto& values, auto emptyValue)
+    {
+        std::move(values.begin() + columns, values.end(), values.begin());
+        std::fill(values.end() - columns, values.end(), emptyValue);
+    };
+
+    shiftLeft(cache.columnStart, int64_t { -1 });
+    shiftLeft(cache.columnEnd, int64_t { -1 });
+    shiftLeft(cache.energies.low, 0.0f);
+    shiftLeft(cache.energies.mid, 0.0f);
+    shiftLeft(cache.energies.high, 0.0f);
+    shiftLeft(cache.minimum, 0.0f);
+    shiftLeft(cache.maximum, 0.0f);
+    shiftLeft(cache.amplitude, 0.0f);
+    shiftLeft(cache.active, static_cast<uint8_t>(0));
+    shiftLeft(cache.target, ColumnRasterizer::Column {});
+    shiftLeft(cache.drawn, DrawnColumn {});
+
+    // The image moves with its columns when they start on whole pixels; otherwise every column
+    // is drawn again.
+    const auto pixelShift = static_cast<float>(columns) * settings.scale;
+    const auto wholePixels = juce::roundToInt(pixelShift);
+
+    if (cache.image.isValid() && juce::exactlyEqual(cache.imageScale, settings.scale)
+        && std::abs(pixelShift - static_cast<float>(wholePixels)) < 1.0e-3f && wholePixels < cache.image.getWidth())
+    {
+        juce::Image::BitmapData bitmap(cache.image, juce::Image::BitmapData::readWrite);
+        const auto rowBytes = static_cast<size_t>((bitmap.width - wholePixels) * bitmap.pixelStride);
+
+        for (int y = 0; y < bitmap.height; ++y)
+            std::memmove(bitmap.getLinePointer(y), bitmap.getPixelPointer(wholePixels, y), rowBytes);
+
+        // The left edge still shows glow from columns that scrolled off.
+        std::fill_n(cache.drawn.begin(), juce::jmin(rasterReachColumns, settings.width), DrawnColumn {});
+    }
+    else
+    {
+        std::fill(cache.drawn.begin(), cache.drawn.end(), DrawnColumn {});
+    }
+
+    return true;
+}
+
+void WaveformRenderer::analyseTile(Tile& tile, int lane)
+{
+    const auto& source = settings.source;
+    const auto& track = trackFrames[static_cast<size_t>(tile.track)].descriptor;
+    auto& cache = trackCaches[static_cast<size_t>(tile.track)];
+    const auto width = settings.width;
+    const auto numSamples = source.numSamples;
+
+    if (width <= 0 || numSamples <= 0 || source.numChannels <= 0)
+        return;
+
+    const auto mode = track.mode;
+    const auto channel = juce::jlimit(0, source.numChannels - 1, track.channel);
+    const auto analysisRate = settings.analysisRate;
+    const auto gainLinear = settings.gainLinear;
+
+    const auto colourWindowSamples = settings.colourWindowSamples;
+    const auto energyLane = mode == RenderMode::channel ? BandEnergyRing::Lane::channel
+                          : mode == RenderMode::side    ? BandEnergyRing::Lane::side
+                                                        : BandEnergyRing::Lane::mid;
+
+    auto storeEnergies = [&](int x, const BandEnergies& energies)
+    {
+        cache.energies.set(static_cast<size_t>(x), energies);
+    };
+
+    // Columns the band-energy ring cannot answer are filtered together, a batch at a time, each
+    // with its own slice of the lane's scratch.
+    constexpr auto batchSize = BandAnalyzer3::batchSize;
+    auto& laneState = lanes[static_cast<size_t>(lane)];
+    std::array<const float*, batchSize> pendingData {};
+    std::array<int, batchSize> pendingLengths {};
+    std::array<int, batchSize> pendingColumns {};
+    std::array<BandEnergies, batchSize> pendingEnergies {};
+    auto numPending = 0;
+
+    auto analysePending = [&]
+    {
+        laneState.bandAnalyzer.analyzeSegments(pendingData.data(),
+                                               pendingLengths.data(),
+                                               numPending,
+                                               analysisRate,
+                                               settings.smoothing,
+                                               pendingEnergies.data());
+
+        for (int i = 0; i < numPending; ++i)
+            storeEnergies(pendingColumns[static_cast<size_t>(i)], pendingEnergies[static_cast<size_t>(i)]);
+
+        numPending = 0;
+    };
+
+    const auto head = source.startSample + numSamples;
+    const auto detail = settings.detail;
+    const auto columnLength = static_cast<double>(numSamples) / width;
+
+    // At a reduced rate the stored samples are filtered, so any column wide enough for the peak
+    // pyramid takes the summaries' full-rate envelopes instead, rounded out to whole records the
+    // same way channel peaks round out to whole pyramid blocks.
+    const auto summaryMinSamples = settings.decimated ? pyramidMinSegmentSamples
+                                                      : summaryMinRecordsPerColumn * summaryHistory.getSamplesPerSummary();
+
+    for (int x = tile.firstColumn; x < tile.endColumn; ++x)
+    {
+        const auto index = static_cast<size_t>(x);
+        const auto scrollColumn = settings.firstScrollColumn + x;
+        TraceSpan trace;
+        ColumnRange range;
+
+        if (detail == DetailLevel::interpolated)
+        {
+            auto left = settings.scrolling ? static_cast<double>(scrollColumn) * columnLength
+                                           : static_cast<double>(settings.cycleStart) + x * columnLength;
+            if (! settings.scrolling && static_cast<int64_t>(std::floor(left)) >= head)
+                left -= static_cast<double>(numSamples);
+
+            trace = traceColumnSpan(left, columnLength, source.startSample, head);
+            range = trace.range;
+        }
+        else
+        {
+            range = settings.scrolling ? scrollColumnRange(scrollColumn, width, numSamples, source.startSample, head)
+                                       : loopColumnRange(x, width, settings.cycleStart, numSamples, head);
+        }
+
+        // Ring samples never change once written, so a column showing the same range is done.
+        if (range.start == cache.columnStart[index] && range.end == cache.columnEnd[index])
+            continue;
+
+        cache.columnStart[index] = range.start;
+        cache.columnEnd[index] = range.end;
+        cache.analysed[index] = static_cast<uint8_t>(1);
+        cache.active[index] = static_cast<uint8_t>(0);
+        ++tile.columnsAnalysed;
+
+        // Before the window starts: the ring is still filling, or the loop just changed length.
+        if (range.start < source.startSample || range.end > head || range.end <= range.start)
+            continue;
+
+        auto start = static_cast<int>(range.start - source.startSample);
+        auto end = static_cast<int>(range.end - source.startSample);
+
+        float minimum = std::numeric_limits<float>::max();
+        float maximum = -std::numeric_limits<float>::max();
+
+        const auto segmentLength = end - start;
+        const auto summaryLane = mode == RenderMode::channel ? BlockSummaryHistory::Lane::channel
+                               : mode == RenderMode::side    ? BlockSummaryHistory::Lane::side
+                                                             : BlockSummaryHistory::Lane::mid;
+
+        // Columns spanning several summary records read the drained history; edges round out to
+        // whole records.
+        auto resolved = detail == DetailLevel::pyramid
+            && segmentLength >= summaryMinSamples
+            && summaryHistory.getRange(summaryLane,
+                                       channel,
+                                       source.startSample + start,
+                                       source.startSample + end,
+                                       minimum,
+                                       maximum);
+
+        if (detail == DetailLevel::interpolated)
+        {
+            const auto traced = traceColumn(mode,
+                                            channel,
+                                            source,
+                                            trace.left - static_cast<double>(source.startSample),
+                                            trace.right - static_cast<double>(source.startSample));
+            minimum = traced.getStart();
+            maximum = traced.getEnd();
+
+            // Colour by the sample the column starts on.
+            start = juce::jlimit(0, numSamples - 1, static_cast<int>(std::floor(trace.left - static_cast<double>(source.startSample))));
+            end = start + 1;
+        }
+        else if (! resolved && mode == RenderMode::channel)
+        {
+            // Wide columns ask the ring's peak pyramid instead of rescanning every sample.
+            resolved = detail == DetailLevel::pyramid
+                && segmentLength >= pyramidMinSegmentSamples
+                && processor.getPeakRange(channel,
+                                          source.startSample + start,
+                                          source.startSample + end,
+                                          minimum,
+                                          maximum);
+
+            if (! resolved)
+            {
+                const auto scanned = spanMinMax(source, channel, start, end);
+                minimum = scanned.getStart();
+                maximum = scanned.getEnd();
+            }
+        }
+        else if (! resolved)
+        {
+            for (int i = start; i < end; ++i)
+            {
+                const auto sample = sampleForMode(mode, channel, source, i);
+                minimum = juce::jmin(minimum, sample);
+                maximum = juce::jmax(maximum, sample);
+            }
+        }
+
+        minimum *= gainLinear;
+        maximum *= gainLinear;
+
+        const auto amplitudeNorm = juce::jlimit(0.0f,
+                                                1.0f,
+                                                juce::jmax(std::abs(maximum), std::abs(minimum)));
+
+        const auto colourEnd = juce::jlimit(1, numSamples, end);
+        const auto colourStart = juce::jmax(0, colourEnd - colourWindowSamples);
+        const auto colourLength = juce::jmax(1, colourEnd - colourStart);
+
+        cache.minimum[index] = minimum;
+        cache.maximum[index] = maximum;
+        cache.amplitude[index] = amplitudeNorm;
+        cache.active[index] = static_cast<uint8_t>(1);
+
+        // The audio thread has usually analysed this span already, and the side ring answers
+        // for the whole column at the cost of two lookups, so wide columns colour by everything
+        // they cover. Only re-filter the trailing window when it cannot (not yet written,
+        // overwritten, or a ring swap in between).
+        const auto lookupStart = juce::jmin(colourStart, juce::jmax(0, start));
+        BandEnergies energies;
+        if (processor.getBandEnergies(energyLane,
+                                      channel,
+                                      source.startSample + lookupStart,
+                                      source.startSample + colourEnd,
+                                      energies))
+        {
+            storeEnergies(x, energies);
+            continue;
+        }
+
+        auto* window = laneState.colourDerived + static_cast<size_t>(numPending) * static_cast<size_t>(colourWindowSamples);
+        const float* colourData = nullptr;
+        if (mode == RenderMode::channel)
+        {
+            colourData = contiguousSamples(source,
+                                           channel,
+                                           colourStart,
+                                           colourLength,
+                                           window);
+        }
+        else
+        {
+            for (int i = 0; i < colourLength; ++i)
+                window[i] = sampleForMode(mode, channel, source, colourStart + i);
+
+            colourData = window;
+        }
+
+        pendingData[static_cast<size_t>(numPending)] = colourData;
+        pendingLengths[static_cast<size_t>(numPending)] = colourLength;
+        pendingColumns[static_cast<size_t>(numPending)] = x;
+
+        if (++numPending == batchSize)
+            analysePending();
+    }
+
+
+    if (numPending > 0)
+        analysePending();
+}
+
+bool WaveformRenderer::updateNormalization(int trackIndex)
+{
+    const auto& cache = trackCaches[static_cast<size_t>(trackIndex)];
+    const auto resetTemporalState = trackFrames[static_cast<size_t>(trackIndex)].resetTemporal;
+    const auto smoothing = settings.smoothing;
+    const auto dtSeconds = settings.dtSeconds;
+
+    if (settings.colorMode != ColorMode::threeBand
+        || ! juce::isPositiveAndBelow(trackIndex, static_cast<int>(normalizationPeakByTrack.size()))
+        || ! juce::isPositiveAndBelow(trackIndex, static_cast<int>(normalizationPeakInitByTrack.size())))
+        return false;
+
+    const auto framePeak = peakBandColumns(cache.energies, cache.active.data());
+
+    auto* normalizationPeak = &normalizationPeakByTrack[static_cast<size_t>(trackIndex)];
+    auto* normalizationPeakInit = &normalizationPeakInitByTrack[static_cast<size_t>(trackIndex)];
+
+    const auto peakAttackTauSeconds = juce::jmax(1.0e-4, static_cast<double>(juce::jmap(smoothing, 0.0f, 1.0f, 0.010f, 0.028f)));
+    const auto peakReleaseTauSeconds = juce::jmax(1.0e-4, static_cast<double>(juce::jmap(smoothing, 0.0f, 1.0f, 0.26f, 0.56f)));
+
+    const auto safeFramePeak = BandEnergies {
+        juce::jmax(peakFloor, framePeak.low),
+        juce::jmax(peakFloor, framePeak.mid),
+        juce::jmax(peakFloor, framePeak.high)
+    };
+
+    if (resetTemporalState || *normalizationPeakInit == 0)
+    {
+        *normalizationPeak = safeFramePeak;
+        *normalizationPeakInit = static_cast<uint8_t>(1);
+    }
+    else
+    {
+        normalizationPeak->low = smoothToward(normalizationPeak->low,
+                                              safeFramePeak.low,
+                                              dtSeconds,
+                                              peakAttackTauSeconds,
+                                              peakReleaseTauSeconds);
+        normalizationPeak->mid = smoothToward(normalizationPeak->mid,
+                                              safeFramePeak.mid,
+                                              dtSeconds,
+                                              peakAttackTauSeconds,
+                                              peakReleaseTauSeconds);
+        normalizationPeak->high = smoothToward(normalizationPeak->high,
+                                               safeFramePeak.high,
+                                               dtSeconds,
+                                               peakAttackTauSeconds,
+                                               peakReleaseTauSeconds);
+    }
+
+    normalizationPeak->low = juce::jmax(peakFloor, normalizationPeak->low);
+    normalizationPeak->mid = juce::jmax(peakFloor, normalizationPeak->mid);
+    normalizationPeak->high = juce::jmax(peakFloor, normalizationPeak->high);
+
+    return stillEasing(normalizationPeak->low, safeFramePeak.low, safeFramePeak.low)
+        || stillEasing(normalizationPeak->mid, safeFramePeak.mid, safeFramePeak.mid)
+        || stillEasing(normalizationPeak->high, safeFramePeak.high, safeFramePeak.high);
+}
+
+void WaveformRenderer::colourTile(Tile& tile)
+{
+    const auto trackIndex = tile.track;
+    const auto& bounds = trackFrames[static_cast<size_t>(trackIndex)].bounds;
+    const auto resetTemporalState = trackFrames[static_cast<size_t>(trackIndex)].resetTemporal;
+    auto& cache = trackCaches[static_cast<size_t>(trackIndex)];
+    const auto width = settings.width;
+    const auto colorMode = settings.colorMode;
+    const auto& colourLut = colourLuts.front();
+    const auto first = tile.firstColumn;
+    const auto count = tile.endColumn - tile.firstColumn;
+
+    const auto centerY = static_cast<float>(bounds.getHeight() / 2);
+    const auto halfHeight = static_cast<float>(bounds.getHeight()) * 0.46f;
+
+    // A traced column spans the signal's rise or fall across it; a flat stretch would span
+    // nothing, so every one is drawn at least a line's thickness tall.
+    const auto tracePad = settings.detail == DetailLevel::interpolated ? 0.5f * settings.style.coreThickness : 0.0f;
+
+    const auto applyTemporalSmoothing = colorMode == ColorMode::threeBand
+        && ! settings.scrolling
+        && trackIndex >= 0
+        && trackIndex < static_cast<int>(temporalEnergiesByTrack.size())
+        && trackIndex < static_cast<int>(temporalInitByTrack.size())
+        && temporalEnergiesByTrack[static_cast<size_t>(trackIndex)].size() == static_cast<size_t>(width)
+        && temporalInitByTrack[static_cast<size_t>(trackIndex)].size() == static_cast<size_t>(width);
+    const auto applyDynamicNormalization = colorMode == ColorMode::threeBand
+        && trackIndex >= 0
+        && trackIndex < static_cast<int>(normalizationPeakByTrack.size())
+        && trackIndex < static_cast<int>(normalizationPeakInitByTrack.size())
+        && normalizationPeakInitByTrack[static_cast<size_t>(trackIndex)] != 0;
+
+    // The tile's colours, band by band, on their way from the analysed energies to the table.
+    float low[tileColumns];
+    float mid[tileColumns];
+    float high[tileColumns];
+    const BandSpans bands { low, mid, high };
+
+    if (settings.blurColors)
+    {
+        blurBandColumns(cache.energies, cache.active.data(), cache.amplitude.data(), settings.colorMatch, ! settings.scrolling, first, tile.endColumn, bands);
+    }
+    else
+    {
+        std::copy_n(cache.energies.low.data() + first, count, low);
+        std::copy_n(cache.energies.mid.data() + first, count, mid);
+        std::copy_n(cache.energies.high.data() + first, count, high);
+    }
+
+    if (applyTemporalSmoothing)
+    {
+        float goalLow[tileColumns];
+        float goalMid[tileColumns];
+        float goalHigh[tileColumns];
+        std::copy_n(low, count, goalLow);
+        std::copy_n(mid, count, goalMid);
+        std::copy_n(high, count, goalHigh);
+
+        smoothBandColumns(temporalEnergiesByTrack[static_cast<size_t>(trackIndex)],
+                          temporalInitByTrack[static_cast<size_t>(trackIndex)].data(),
+                          cache.active.data(),
+                          first,
+                          tile.endColumn,
+                          settings.attackAlpha,
+                          settings.releaseAlpha,
+                          resetTemporalState,
+                          bands);
+
+        // Judged at the scale the bands are drawn at: the normalisation peak, or 1 when clamped.
+        const auto fullScale = applyDynamicNormalization ? normalizationPeakByTrack[static_cast<size_t>(trackIndex)]
+                                                         : BandEnergies { 1.0f, 1.0f, 1.0f };
+
+        for (int i = 0; i < count; ++i)
+        {
+            if (cache.active[static_cast<size_t>(first + i)] != 0
+                && (stillEasing(low[i], goalLow[i], fullScale.low) || stillEasing(mid[i], goalMid[i], fullScale.mid)
+                    || stillEasing(high[i], goalHigh[i], fullScale.high)))
+                ++tile.columnsEasing;
+        }
+    }
+
+    if (applyDynamicNormalization)
+    {
+        normalizeBandColumns(bands, count, normalizationPeakByTrack[static_cast<size_t>(trackIndex)]);
+        colourLut.shapeBands(low, count);
+        colourLut.shapeBands(mid, count);
+        colourLut.shapeBands(high, count);
+    }
+    else if (colorMode == ColorMode::threeBand)
+    {
+        clampBandColumns(bands, count);
+    }
+
+    // The raster pass reads changed across tile edges; drawn is only ever touched here.
+    const auto height = static_cast<float>(bounds.getHeight());
+    auto analysedNear = [&](int x)
+    {
+        for (auto nx = juce::jmax(0, x - 2); nx <= juce::jmin(width - 1, x + 2); ++nx)
+        {
+            if (cache.analysed[static_cast<size_t>(nx)] != 0)
+                return true;
+        }
+
+        return false;
+    };
+
+    for (int i = 0; i < count; ++i)
+    {
+        const auto index = static_cast<size_t>(first + i);
+        auto& target = cache.target[index];
+
+        // Scrolling, a drawn column keeps its colour unless it or a neighbour its blur reads was
+        // analysed again, so what a frame costs follows the columns that appeared.
+        if (settings.scrolling && cache.drawn[index].valid && ! analysedNear(first + i))
+        {
+            cache.changed[index] = 0;
+            continue;
+        }
+
+        if (cache.active[index] == 0)
+        {
+            target = {};
+        }
+        else
+        {
+            target = { colourLut.lookup({ low[i], mid[i], high[i] }, cache.amplitude[index]),
+                       juce::jlimit(0.0f, height, centerY - cache.maximum[index] * halfHeight - tracePad),
+                       juce::jlimit(0.0f, height, centerY - cache.minimum[index] * halfHeight + tracePad) };
+        }
+
+        auto& drawn = cache.drawn[index];
+        cache.changed[index] = static_cast<uint8_t>(! drawn.valid || ! (drawn.column == target) ? 1 : 0);
+        drawn = { target, true };
+    }
+}
+
+void WaveformRenderer::prepareImage(TrackCache& cache, int height) const
+{
+    // The track keeps its own image at the display's pixel density; only columns whose look
+    // changed since it was last drawn are cleared and drawn again, along with the neighbours
+    // whose glow reaches into them.
+    const auto imageWidth = juce::roundToInt(static_cast<float>(settings.width) * settings.scale);
+    const auto imageHeight = juce::jmax(1, juce::roundToInt(static_cast<float>(height) * settings.scale));
+
+    if (cache.image.getWidth() != imageWidth || cache.image.getHeight() != imageHeight
+        || ! juce::exactlyEqual(cache.imageScale, settings.scale) || cache.drawnColorMode != settings.colorMode
+        || ! juce::exactlyEqual(cache.drawnColorMatch, settings.colorMatch) || cache.drawnBackend != settings.backend)
+    {
+        if (cache.image.getWidth() != imageWidth || cache.image.getHeight() != imageHeight)
+            cache.image = juce::Image(juce::Image::ARGB, imageWidth, imageHeight, false, juce::SoftwareImageType());
+
+        cache.imageScale = settings.scale;
+        cache.drawnColorMode = settings.colorMode;
+        cache.drawnColorMatch = settings.colorMatch;
+        cache.drawnBackend = settings.backend;
+        std::fill(cache.drawn.begin(), cache.drawn.end(), DrawnColumn {});
+    }
+}
+
+void WaveformRenderer::rasterTile(Tile& tile, juce::Image& frameImage)
+{
+    const auto& trackFrame = trackFrames[static_cast<size_t>(tile.track)];
+    auto& cache = trackCaches[static_cast<size_t>(tile.track)];
+    const auto width = settings.width;
+    const auto scale = settings.scale;
+    const auto imageWidth = cache.image.getWidth();
+
+    // Tiles own the image pixels from their first column's left edge to the next tile's, so
+    // neighbouring tiles never write the same pixel even where a line straddles the edge.
+    const auto tilePixelStart = static_cast<int>(std::floor(static_cast<float>(tile.firstColumn) * scale));
+    const auto tilePixelEnd = tile.endColumn == width ? imageWidth
+                                                      : static_cast<int>(std::floor(static_cast<float>(tile.endColumn) * scale));
+
+    ColumnRasterizer::Strip strip;
+    strip.centreY = trackFrame.bounds.getHeight() / 2;
+    strip.background = backgroundColour();
+    strip.centreLine = backgroundColour().interpolatedWith(juce::Colours::white, 0.08f);
+
+    // Changes just outside the tile still reach into it.
+    const auto scanEnd = juce::jmin(width, tile.endColumn + rasterReachColumns);
+    auto x = juce::jmax(0, tile.firstColumn - rasterReachColumns);
+
+    while (x < scanEnd)
+    {
+        if (cache.changed[static_cast<size_t>(x)] == 0)
+        {
+            ++x;
+            continue;
+        }
+
+        // Grow a run of changed columns until the next change is too far away to share it.
+        auto runEnd = x + 1;
+        for (auto next = runEnd; next < scanEnd && next <= runEnd + 2 * rasterReachColumns; ++next)
+        {
+            if (cache.changed[static_cast<size_t>(next)] != 0)
+                runEnd = next + 1;
+        }
+
+        const auto clearStart = juce::jmax(0, x - rasterReachColumns);
+        const auto clearEnd = juce::jmin(width, runEnd + rasterReachColumns);
+        strip.pixelStart = juce::jmax(tilePixelStart, static_cast<int>(std::floor(static_cast<float>(clearStart) * scale)));
+        strip.pixelEnd = juce::jmin(tilePixelEnd, static_cast<int>(std::ceil(static_cast<float>(clearEnd) * scale)));
+
+        if (strip.pixelStart < strip.pixelEnd)
+        {
+            if (tile.dirtyPixelStart >= tile.dirtyPixelEnd)
+                tile.dirtyPixelStart = strip.pixelStart;
+
+            tile.dirtyPixelEnd = strip.pixelEnd;
+            rasterizer.paintStrip(cache.image,
+                                  scale,
+                                  strip,
+                                  cache.target.data(),
+                                  juce::jmax(0, clearStart - rasterReachColumns - 1),
+                                  juce::jmin(width, clearEnd + rasterReachColumns + 1),
+                                  settings.style);
+        }
+
+        x = runEnd;
+    }
+
+    for (auto column = tile.firstColumn; column < tile.endColumn; ++column)
+        tile.columnsRasterized += cache.changed[static_cast<size_t>(column)];
+
+    copyPixels(cache.image, frameImage, trackFrame.imageY, tilePixelStart, tilePixelEnd);
+}
+
+int WaveformRenderer::writeColumn() const noexcept
+{
+    // The head sits in the last column whose range starts before the newest sample.
+    const auto& source = settings.source;
+    const auto width = settings.width;
+    if (settings.scrolling)
+        return width - 1;
+
+    const auto headOffset = source.startSample + source.numSamples - settings.cycleStart;
+    const auto headColumn = static_cast<int>((headOffset * width + source.numSamples - 1) / juce::jmax(1, source.numSamples)) - 1;
+    return headColumn < 0 ? width - 1 : juce::jmin(width - 1, headColumn);
+}
+
+WaveformRenderer::DetailLevel WaveformRenderer::detailFor(int numSamples, int width) noexcept
+{
+    if (numSamples < width)
+        return DetailLevel::interpolated;
+
+    return numSamples < static_cast<int64_t>(pyramidMinSegmentSamples) * width ? DetailLevel::direct : DetailLevel::pyramid;
+}
+
+juce::Range<float> WaveformRenderer::traceColumn(RenderMode mode,
+                                                 int channel,
+                                                 const AnalysisRingBuffer::ReadSpans& source,
+                                                 double left,
+                                                 double right) const noexcept
+{
+    // Less than a sample wide, so one extra sample past the taps around left also covers right.
+    // Taps before the window or past the newest sample hold the nearest one.
+    constexpr auto halfTaps = SincInterpolator::halfTaps;
+    const auto first = static_cast<int>(std::floor(left)) - (halfTaps - 1);
+    float window[SincInterpolator::taps + 1];
+
+    for (int i = 0; i <= SincInterpolator::taps; ++i)
+        window[i] = sampleForMode(mode, channel, source, juce::jlimit(0, source.numSamples - 1, first + i));
+
+    auto valueAt = [&](double position)
+    {
+        const auto base = static_cast<int>(std::floor(position));
+        const auto offset = juce::jlimit(0, 1, base - first - (halfTaps - 1));
+        return interpolator.interpolate(window + offset, static_cast<float>(position - base));
+    };
+
+    const auto a = valueAt(left);
+    const auto b = valueAt(0.5 * (left + right));
+    const auto c = valueAt(right);
+    return { juce::jmin(a, b, c), juce::jmax(a, b, c) };
+}
+
+float WaveformRenderer::sampleForMode(RenderMode mode,
+                                  int channel,
+                                  const AnalysisRingBuffer::ReadSpans& source,
+                                  int sampleIndex) const noexcept
+{
+    if (mode == RenderMode::channel)
+        return source.getSample(juce::jlimit(0, source.numChannels - 1, channel), sampleIndex);
+
+    // Derived views fold the first pair; a mono capture stands in for both sides.
+    const auto left = source.getSample(0, sampleIndex);
+    const auto right = source.numChannels > 1 ? source.getSample(1, sampleIndex) : left;
+
+    switch (mode)
+    {
+        case RenderMode::mono: return mixForChannelView(ChannelView::mono, left, right);
+        case RenderMode::mid: return mixForChannelView(ChannelView::mid, left, right);
+        case RenderMode::side: return mixForChannelView(ChannelView::side, left, right);
+        case RenderMode::channel: break;
+    }
+
+    return left;
+}
+
+void WaveformRenderer::updateTrackDescriptors(ChannelView channelMode, int numChannels)
+{
+    const auto channels = juce::jmax(1, numChannels);
+    const auto layout = processor.getCaptureLayout();
+
+    // Labels are strings; keep the list until what it was built from changes.
+    if (! trackDescriptors.empty() && channelMode == trackChannelView && channels == trackChannels && layout == trackLayout)
+        return;
+
+    trackChannelView = channelMode;
+    trackChannels = channels;
+    trackLayout = layout;
+    trackDescriptors.clear();
+
+    const auto secondChannel = juce::jmin(1, channels - 1);
+
+    switch (channelMode)
+    {
+        case ChannelView::left:
+            trackDescriptors.push_back({ RenderMode::channel, 0, "LEFT" });
+            return;
+        case ChannelView::right:
+            trackDescriptors.push_back({ RenderMode::channel, secondChannel, "RIGHT" });
+            return;
+        case ChannelView::mono:
+            trackDescriptors.push_back({ RenderMode::mono, 0, "MONO" });
+            return;
+        case ChannelView::mid:
+            trackDescriptors.push_back({ RenderMode::mid, 0, "MID" });
+            return;
+        case ChannelView::side:
+            trackDescriptors.push_back({ RenderMode::side, 0, "SIDE" });
+            return;
+        case ChannelView::lrSplit:
+        default:
+            break;
+    }
+
+    // One track per captured channel, labelled from the bus layout when it still matches the
+    // capture.
+    const auto useLayoutNames = layout.size() == channels;
+
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        auto label = useLayoutNames ? juce::AudioChannelSet::getAbbreviatedChannelTypeName(layout.getTypeOfChannel(channel))
+                                    : juce::String();
+
+        if (label.isEmpty())
+            label = juce::String(channel + 1);
+
+        trackDescriptors.push_back({ RenderMode::channel, channel, label });
+    }
+}
+
+} // namespace wvfrm
@@ -0,0 +1,312 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "../Parameters.h"
+#include "../dsp/AnalysisRingBuffer.h"
+#include "../dsp/BandAnalyzer3.h"
+#include "../dsp/BlockSummary.h"
+#include "../dsp/SincInterpolator.h"
+#include "BandColumnPasses.h"
+#include "ColourLut.h"
+#include "ColumnRasterizer.h"
+#include "FrameArena.h"
+#include "FrameMailbox.h"
+#include "RenderSource.h"
+#include "ThemeEngine.h"
+#include "WorkStealingPool.h"
+
+namespace wvfrm
+{
+
+// Builds the waveform view's frames on a thread of its own. Each frame reads the loop from the
+// processor, analyses and rasterizes the tracks into their cached images, copies those into the
+// frame image and publishes it through a FrameMailbox, so the view's paint only blits the newest
+// finished frame and never waits for one. With the loop off the tracks scroll instead: the
+// newest sample sits at the right edge, and each frame shifts the cached columns and images left
+// by the columns that elapsed and only analyses and draws the ones that appeared. Everything kept
+// between frames belongs to the render thread; the message thread only asks for frames, fetches
+// them and tabulates the colour LUT whenever the look changes, which the render thread swaps in.
+class WaveformRenderer : private juce::Thread
+{
+public:
+    // What the view draws over a track's pixels: its outline, write cursor and label.
+    struct TrackOverlay
+    {
+        juce::Rectangle<int> bounds;
+        int cursorX = 0;
+        juce::String label;
+    };
+
+    struct Frame
+    {
+        juce::Image image; // contentBounds at scale physical pixels per point
+        float scale = 1.0f;
+        juce::Rectangle<int> contentBounds;
+        bool hasAudio = false;
+        std::vector<TrackOverlay> tracks;
+        int columnsAnalysed = 0;
+        int columnsRasterized = 0;
+
+        // Colours are still easing towards what the audio shown asks for, so the next frame
+        // would differ from this one even if nothing else moved.
+        bool settling = false;
+
+        // Counts every frame built, so a consumer can tell whether it missed one. Unless
+        // wholeFrameDirty, dirty covers every view area whose pixels differ from the frame built
+        // just before this one.
+        uint64_t sequence = 0;
+        bool wholeFrameDirty = true;
+        std::vector<juce::Rectangle<int>> dirty;
+    };
+
+    explicit WaveformRenderer(RenderSource& sourceToUse);
+    ~WaveformRenderer() override;
+
+    // Message thread. Asks for a frame for a view of this size at the display's pixel scale. A
+    // request made while the previous frame is still being built is folded into the next one.
+    // When the theme, colour mode, intensity or colour match moved, the colour LUT is rebuilt
+    // here first, so the frame picks up the finished table.
+    void requestFrame(juce::Rectangle<int> viewBounds, float scale);
+
+    // Message thread. The view stopped showing; colour smoothing starts afresh when it returns.
+    void noteHidden() noexcept;
+
+    // Message thread. Takes the newest finished frame as currentFrame(); false when none
+    // arrived since the last call.
+    bool fetchFrame() noexcept;
+    const Frame& currentFrame() const noexcept;
+    uint64_t getDroppedFrames() const noexcept;
+
+private:
+    enum class RenderMode
+    {
+        channel,
+        mono,
+        mid,
+        side
+    };
+
+    // How a frame turns samples into columns, picked from the samples each column covers: many
+    // per column read summaries (block records, then the peak pyramid), a handful scan the
+    // samples, and fewer than one trace the band-limited signal between them.
+    enum class DetailLevel
+    {
+        pyramid,
+        direct,
+        interpolated
+    };
+
+    struct TrackDescriptor
+    {
+        RenderMode mode = RenderMode::channel;
+        int channel = 0;
+        juce::String label;
+    };
+
+    // What one column of a track image currently shows; not valid until it has been drawn.
+    struct DrawnColumn
+    {
+        ColumnRasterizer::Column column;
+        bool valid = false;
+    };
+
+    // Per-track columns kept between frames. columnStart/columnEnd are the absolute ring range each
+    // column was analysed over (-1: never), so a column whose range has not moved keeps its
+    // analysis; drawn mirrors the image, so only columns whose look changed are rasterized again.
+    struct TrackCache
+    {
+        std::vector<int64_t> columnStart;
+        std::vector<int64_t> columnEnd;
+        BandPlanes energies;
+        std::vector<float> minimum;
+        std::vector<float> maximum;
+        std::vector<float> amplitude;
+        std::vector<uint8_t> active;
+        std::vector<uint8_t> analysed;
+        std::vector<uint8_t> changed; // target differs from what the image shows
+        float analysedGain = 0.0f;
+        float analysedSmoothing = -1.0f;
+        double analysedRate = 0.0;
+        DetailLevel analysedDetail = DetailLevel::pyramid;
+        int64_t firstScrollColumn = 0; // what column 0 shows, while scrollAligned
+        bool scrollAligned = false;
+
+        juce::Image image;
+        float imageScale = 0.0f;
+        std::vector<DrawnColumn> drawn;
+        std::vector<ColumnRasterizer::Column> target;
+        ColorMode drawnColorMode = ColorMode::threeBand;
+        float drawnColorMatch = -1.0f;
+        RasterBackend drawnBackend = RasterBackend::direct;
+
+        void invalidate() noexcept
+        {
+            std::fill(columnStart.begin(), columnStart.end(), int64_t { -1 });
+            std::fill(columnEnd.begin(), columnEnd.end(), int64_t { -1 });
+            std::fill(drawn.begin(), drawn.end(), DrawnColumn {});
+        }
+    };
+
+    // One track's share of the current frame.
+    struct TrackFrame
+    {
+        TrackDescriptor descriptor;
+        juce::Rectangle<int> bounds;
+        int imageY = 0; // first row of the track in the frame image
+        bool resetTemporal = false;
+    };
+
+    // Everything a frame's tiles read; set before the first pass and left alone until the last.
+    struct FrameSettings
+    {
+        AnalysisRingBuffer::ReadSpans source;
+        int width = 1;
+        float scale = 1.0f;
+        int64_t cycleStart = 0;
+        ColorMode colorMode = ColorMode::threeBand;
+        float colorMatch = 1.0f;
+        float gainLinear = 1.0f;
+        float smoothing = 0.0f;
+        double dtSeconds = 0.0;
+        float attackAlpha = 0.0f;
+        float releaseAlpha = 0.0f;
+        double analysisRate = 0.0;
+        bool decimated = false; // the ring holds filtered samples below the host rate
+        int colourWindowSamples = 64;
+        DetailLevel detail = DetailLevel::pyramid;
+        bool scrolling = false;
+        int64_t firstScrollColumn = 0; // absolute column shown at x = 0 when scrolling
+        bool blurColors = false;
+        ColumnRasterizer::Style style;
+        RasterBackend backend = RasterBackend::direct;
+    };
+
+    // A track's columns [firstColumn, endColumn), the unit of work for every pass. Each tile
+    // writes only its own columns of the track's buffers and its own pixels of the images.
+    struct alignas(64) Tile
+    {
+        int track = 0;
+        int firstColumn = 0;
+        int endColumn = 0;
+        int columnsAnalysed = 0;
+        int columnsRasterized = 0;
+        int columnsEasing = 0; // coloured short of their target by temporal smoothing
+        int dirtyPixelStart = 0; // image pixels the raster pass repainted; empty when equal
+        int dirtyPixelEnd = 0;
+    };
+
+    // Scratch for whichever tile a pool lane is running. colourDerived holds a batch of colour
+    // windows and comes from the frame arena.
+    struct LaneState
+    {
+        BandAnalyzer3 bandAnalyzer;
+        float* colourDerived = nullptr;
+    };
+
+    static constexpr int tileColumns = 128;
+
+    void run() override;
+    void publishColourLut();
+    // False when the frame stopped short after finding audio; it must not be published then.
+    bool renderFrame(Frame& frame, int viewWidth, int viewHeight, float scale);
+    void reserveFrameArena(int width, int numTracks);
+    void collectDirtyRegions(Frame& frame) const;
+
+    void ensureRenderBuffers(TrackCache& cache, int width) const;
+    int64_t anchorLoopCycle(const AnalysisRingBuffer::ReadSpans& source, float loopPhase, int width);
+    int writeColumn() const noexcept;
+
+    // Serial steps between the passes.
+    void prepareAnalysis(TrackCache& cache) const;
+    bool scrollCache(TrackCache& cache) const;
+    // True while the track's normalisation peak is still easing towards this frame's.
+    bool updateNormalization(int trackIndex);
+    void prepareImage(TrackCache& cache, int height) const;
+
+    // The passes, one tile at a time on the pool.
+    void analyseTile(Tile& tile, int lane);
+    void colourTile(Tile& tile);
+    void rasterTile(Tile& tile, juce::Image& frameImage);
+
+    static DetailLevel detailFor(int numSamples, int width) noexcept;
+    juce::Range<float> traceColumn(RenderMode mode,
+                                   int channel,
+                                   const AnalysisRingBuffer::ReadSpans& source,
+                                   double left,
+                                   double right) const noexcept;
+    float sampleForMode(RenderMode mode, int channel, const AnalysisRingBuffer::ReadSpans& source, int sampleIndex) const noexcept;
+    void updateTrackDescriptors(ChannelView channelMode, int numChannels);
+
+    RenderSource& processor;
+    FrameMailbox<Frame> frames;
+
+    // Written by the message thread, read at the start of each frame.
+    std::atomic<int> requestedWidth { 0 };
+    std::atomic<int> requestedHeight { 0 };
+    std::atomic<float> requestedScale { 1.0f };
+    std::atomic<bool> restartSmoothing { true };
+
+    // Built by the message thread and fetched by the render thread at the start of each frame,
+    // so a new look costs the render thread a swap rather than a retabulation.
+    FrameMailbox<ColourLut> colourLuts;
+    ThemeEngine themeEngine;
+    ColourLut::Settings publishedLook;
+    bool lookPublished = false;
+
+    // Looked up once; reading them by ID would build a string every frame.
+    const std::atomic<float>* channelViewValue = nullptr;
+    const std::atomic<float>* colorModeValue = nullptr;
+    const std::atomic<float>* themePresetValue = nullptr;
+    const std::atomic<float>* themeIntensityValue = nullptr;
+    const std::atomic<float>* smoothingValue = nullptr;
+    const std::atomic<float>* colorMatchValue = nullptr;
+    const std::atomic<float>* waveGainVisualValue = nullptr;
+    const std::atomic<float>* rasterBackendValue = nullptr;
+    const std::atomic<float>* waveLoopValue = nullptr;
+
+    // Render-thread state. Whatever only lives for one frame comes from frameArena, sized when
+    // the view's width or track count changes; the rest is kept between frames.
+    WorkStealingPool tilePool { WorkStealingPool::suggestedWorkerCount() };
+    FrameArena frameArena;
+    int arenaWidth = 0;
+    int arenaTracks = 0;
+    std::vector<LaneState> lanes;
+    std::vector<TrackDescriptor> trackDescriptors; // rebuilt only when the channel view changes
+    ChannelView trackChannelView = ChannelView::lrSplit;
+    int trackChannels = 0;
+    juce::AudioChannelSet trackLayout;
+    std::vector<TrackFrame> trackFrames;
+    Tile* tiles = nullptr;
+    int numTiles = 0;
+    FrameSettings settings;
+    SincInterpolator interpolator;
+    ColumnRasterizer rasterizer;
+    uint64_t frameSequence = 0;
+    juce::Rectangle<int> lastContentBounds; // of the last frame built in full; empty when it was not
+    float lastFrameScale = 0.0f;
+
+    BlockSummaryHistory summaryHistory;
+    double summaryHistoryRate = 0.0;
+    juce::AudioBuffer<float> scratch;
+    std::vector<TrackCache> trackCaches;
+    int64_t loopAnchor = 0;
+    int64_t loopAnchorLength = 0;
+    std::vector<BandPlanes> temporalEnergiesByTrack;
+    std::vector<std::vector<uint8_t>> temporalInitByTrack;
+    std::vector<BandEnergies> normalizationPeakByTrack;
+    std::vector<uint8_t> normalizationPeakInitByTrack;
+    std::vector<RenderMode> temporalTrackModes;
+    std::vector<int> temporalTrackChannels;
+    double lastColourFrameTimeSec = 0.0;
+    bool wasVisibleForTemporalState = false;
+    bool lastThreeBandTemporalEnabled = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformRenderer)
+};
+
+} // namespace wvfrm
@@ -2,19 +2,26 @@
 
 #include "../JuceIncludes.h"
 
+#include <array>
 #include <vector>
 
-#include "../Parameters.h"
-#include "../dsp/BandAnalyzer3.h"
-#include "ThemeEngine.h"
+#include "../PluginProcessor.h"
+#include "WaveformRenderer.h"
 
 namespace wvfrm
 {
 
-class WaveformAudioProcessor;
-
-class WaveformView : public juce::Component,
-                     private juce::Timer
+// Shows the renderer's newest frame and, once per display refresh, asks for another only when
+// something the frame reads has moved: new audio, the loop clock, a parameter, the view's size
+// or pixel scale, or colours still settling from the last change. An idle view costs a stamp
+// comparison per refresh and no frames.
+//
+// Paints in layers: the background, the frame's waveform, the chrome (track outlines and labels)
+// and the overlay (write cursors and debug text). The chrome and debug text are drawn into
+// images once and only redrawn when the layout, pixel scale or text changes. A new frame repaints
+// just the areas the renderer redrew and the cursors that moved; a missed frame or a new layout
+// repaints everything.
+class WaveformView : public juce::Component
 {
 public:
     explicit WaveformView(WaveformAudioProcessor& processorToUse);
@@ -24,64 +31,46 @@ public:
     void setDebugOverlayEnabled(bool enabled) noexcept;
 
 private:
-    enum class RenderMode
-    {
-        left,
-        right,
-        mono,
-        mid,
-        side
-    };
-
-    struct TrackDescriptor
+    // What the last requested frame was built from.
+    struct FrameRequest
     {
-        RenderMode mode = RenderMode::left;
-        juce::String label;
+        WaveformAudioProcessor::ViewStamp stamp;
+        juce::Rectangle<int> bounds;
+        float scale = 0.0f;
+
+        // The scale comes straight from the display, so any change at all asks for a new frame.
+        bool operator==(const FrameRequest& other) const noexcept
+        {
+            return stamp == other.stamp && bounds == other.bounds && juce::exactlyEqual(scale, other.scale);
+        }
     };
 
-    void timerCallback() override;
-    void ensureRenderBuffers(int width) const;
-
-    void drawTrack(juce::Graphics& g,
-                   juce::Rectangle<int> bounds,
-                   const juce::AudioBuffer<float>& source,
-                   int trackIndex,
-                   RenderMode mode,
-                   const juce::String& label,
-                   ThemePreset themePreset,
-                   ColorMode colorMode,
-                   float intensity,
-                   float colorMatch,
-                   float loopPhase,
-                   bool phaseReliable,
-                   bool resetSuggested,
-                   bool resetTemporalState,
-                   double dtSeconds,
-                   float gainLinear,
-                   float rmsSmoothing) const;
-
-    float sampleForMode(RenderMode mode, const juce::AudioBuffer<float>& source, int sampleIndex) const noexcept;
+    void onVBlank();
+    void repaintChangedAreas();
+    bool chromeMatches(const WaveformRenderer::Frame& frame) const noexcept;
+    void updateChrome(const WaveformRenderer::Frame& frame);
+    void updateDebugText(const WaveformRenderer::Frame& frame);
+    juce::Rectangle<int> debugArea() const noexcept;
 
     WaveformAudioProcessor& processor;
-    BandAnalyzer3 bandAnalyzer;
-    ThemeEngine themeEngine;
-
-    mutable juce::AudioBuffer<float> scratch;
-    mutable std::vector<BandEnergies> energiesPerX;
-    mutable std::vector<float> minPerX;
-    mutable std::vector<float> maxPerX;
-    mutable std::vector<float> ampPerX;
-    mutable std::vector<uint8_t> activePerX;
-    mutable std::vector<std::vector<BandEnergies>> temporalEnergiesByTrack;
-    mutable std::vector<std::vector<uint8_t>> temporalInitByTrack;
-    mutable std::vector<BandEnergies> normalizationPeakByTrack;
-    mutable std::vector<uint8_t> normalizationPeakInitByTrack;
-    mutable std::vector<RenderMode> temporalTrackModes;
-    mutable double lastColourFrameTimeSec = 0.0;
-    mutable bool wasVisibleForTemporalState = false;
-    mutable bool lastThreeBandTemporalEnabled = false;
+    WaveformRenderer renderer;
+    FrameRequest lastRequest;
+    float displayScale = 1.0f;
     bool debugOverlayEnabled = false;
 
+    // What the layers were last drawn for.
+    juce::Image chromeLayer;
+    float chromeScale = 0.0f;
+    std::vector<WaveformRenderer::TrackOverlay> chromeTracks; // cursors unused
+    juce::Image debugLayer;
+    std::array<juce::String, 3> debugLines;
+    uint64_t shownSequence = 0;
+    bool shownHasAudio = false;
+    std::vector<int> shownCursors;
+
+    // Last, so it stops calling back before anything it touches goes away.
+    juce::VBlankAttachment vblank { this, [this] { onVBlank(); } };
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformView)
 };
 
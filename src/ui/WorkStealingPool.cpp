@@ -0,0 +1,175 @@
+#include "WorkStealingPool.h"
+
+namespace wvfrm
+{
+
+namespace
+{
+uint64_t packRange(int begin, int end) noexcept
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(end)) << 32) | static_cast<uint32_t>(begin);
+}
+
+int rangeBegin(uint64_t range) noexcept
+{
+    return static_cast<int>(static_cast<uint32_t>(range));
+}
+
+int rangeEnd(uint64_t range) noexcept
+{
+    return static_cast<int>(static_cast<uint32_t>(range >> 32));
+}
+} // namespace
+
+class WorkStealingPool::Worker : public juce::Thread
+{
+public:
+    Worker(WorkStealingPool& poolToServe, int laneToUse)
+        : juce::Thread("wvfrm tile worker"),
+          pool(poolToServe),
+          lane(laneToUse)
+    {
+    }
+
+    ~Worker() override
+    {
+        stopThread(1000);
+    }
+
+private:
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            // Woken once per batch; a late wake-up just finds the shares empty, or helps with
+            // whichever batch is running by then.
+            wait(-1);
+
+            while (! threadShouldExit() && pool.runOne(lane))
+            {
+            }
+        }
+    }
+
+    WorkStealingPool& pool;
+    const int lane;
+};
+
+WorkStealingPool::WorkStealingPool(int numWorkers)
+    : shares(std::make_unique<Share[]>(static_cast<size_t>(juce::jmax(0, numWorkers) + 1))),
+      numLanes(juce::jmax(0, numWorkers) + 1)
+{
+    for (int lane = 0; lane < numLanes - 1; ++lane)
+    {
+        workers.push_back(std::make_unique<Worker>(*this, lane));
+        workers.back()->startThread();
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    for (auto& worker : workers)
+        worker->signalThreadShouldExit();
+
+    workers.clear();
+}
+
+int WorkStealingPool::suggestedWorkerCount() noexcept
+{
+    // Leave a core for the audio thread and one for the message thread.
+    return juce::jlimit(0, 7, juce::SystemStats::getNumCpus() - 2);
+}
+
+int WorkStealingPool::getNumLanes() const noexcept
+{
+    return numLanes;
+}
+
+void WorkStealingPool::dispatch(int numTasks, TaskFunction function, void* context)
+{
+    if (numTasks <= 0)
+        return;
+
+    if (numLanes == 1 || numTasks == 1)
+    {
+        for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
+            function(context, taskIndex, numLanes - 1);
+
+        return;
+    }
+
+    // The previous batch is over, so nothing reads these until the shares below are dealt.
+    batchFunction.store(function, std::memory_order_relaxed);
+    batchContext.store(context, std::memory_order_relaxed);
+    remaining.store(numTasks, std::memory_order_relaxed);
+
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        const auto begin = static_cast<int>(static_cast<int64_t>(numTasks) * lane / numLanes);
+        const auto end = static_cast<int>(static_cast<int64_t>(numTasks) * (lane + 1) / numLanes);
+        shares[static_cast<size_t>(lane)].range.store(packRange(begin, end), std::memory_order_release);
+    }
+
+    for (auto& worker : workers)
+        worker->notify();
+
+    const auto callerLane = numLanes - 1;
+    while (remaining.load(std::memory_order_acquire) > 0)
+    {
+        if (! runOne(callerLane))
+            juce::Thread::yield();
+    }
+}
+
+bool WorkStealingPool::runOne(int lane) noexcept
+{
+    auto taskIndex = 0;
+    auto found = takeFront(lane, taskIndex);
+
+    for (int offset = 1; ! found && offset < numLanes; ++offset)
+        found = takeBack((lane + offset) % numLanes, taskIndex);
+
+    if (! found)
+        return false;
+
+    // Taking a task keeps its batch open, so the function and context are that batch's.
+    batchFunction.load(std::memory_order_relaxed)(batchContext.load(std::memory_order_relaxed), taskIndex, lane);
+    remaining.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+bool WorkStealingPool::takeFront(int lane, int& taskIndex) noexcept
+{
+    auto& range = shares[static_cast<size_t>(lane)].range;
+    auto current = range.load(std::memory_order_acquire);
+
+    while (rangeBegin(current) < rangeEnd(current))
+    {
+        if (range.compare_exchange_weak(current, packRange(rangeBegin(current) + 1, rangeEnd(current)), std::memory_order_acq_rel))
+        {
+            taskIndex = rangeBegin(current);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool WorkStealingPool::takeBack(int lane, int& taskIndex) noexcept
+{
+    auto& range = shares[static_cast<size_t>(lane)].range;
+    auto current = range.load(std::memory_order_acquire);
+
+    while (rangeBegin(current) < rangeEnd(current))
+    {
+        if (range.compare_exchange_weak(current, packRange(rangeBegin(current), rangeEnd(current) - 1), std::memory_order_acq_rel))
+        {
+            taskIndex = rangeEnd(current) - 1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace wvfrm
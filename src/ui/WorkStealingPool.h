@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../JuceIncludes.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace wvfrm
+{
+
+// A few persistent worker threads that help one caller through batches of independent tasks.
+// run() deals each lane (every worker plus the caller) a contiguous share of the task indices;
+// a lane works through its own share from the front and, once that runs dry, steals from the
+// back of the others', so an uneven batch still finishes together. The caller works too and
+// returns once every task has finished. Only one thread may call run().
+class WorkStealingPool
+{
+public:
+    // numWorkers threads besides the caller; 0 runs every batch on the caller.
+    explicit WorkStealingPool(int numWorkers);
+    ~WorkStealingPool();
+
+    // Workers worth starting alongside one busy thread on this machine.
+    static int suggestedWorkerCount() noexcept;
+
+    // Workers plus the caller; lane indices passed to tasks are below this.
+    int getNumLanes() const noexcept;
+
+    // Calls task(taskIndex, lane) once for every taskIndex in [0, numTasks). Tasks of one batch
+    // run concurrently, so they must not write anything another task reads.
+    template <typename Task>
+    void run(int numTasks, Task& task)
+    {
+        dispatch(numTasks,
+                 [](void* context, int taskIndex, int lane) { (*static_cast<Task*>(context))(taskIndex, lane); },
+                 &task);
+    }
+
+private:
+    using TaskFunction = void (*)(void* context, int taskIndex, int lane);
+
+    class Worker;
+
+    // Task indices [begin, end) packed into one word, so the owner taking from the front and a
+    // thief taking from the back settle any race with a single compare-exchange.
+    struct alignas(64) Share
+    {
+        std::atomic<uint64_t> range { 0 };
+    };
+
+    void dispatch(int numTasks, TaskFunction function, void* context);
+    bool runOne(int lane) noexcept;
+    bool takeFront(int lane, int& taskIndex) noexcept;
+    bool takeBack(int lane, int& taskIndex) noexcept;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::unique_ptr<Share[]> shares;
+    int numLanes = 1;
+
+    std::atomic<TaskFunction> batchFunction { nullptr };
+    std::atomic<void*> batchContext { nullptr };
+    alignas(64) std::atomic<int> remaining { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(WorkStealingPool)
+};
+
+} // namespace wvfrm
@@ -0,0 +1,133 @@
+#include "AllocationHook.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// On glibc the C allocator is replaced as well, forwarding to glibc's own entry points, so
+// juce::HeapBlock and anything else that calls malloc directly is counted too; operator new
+// then counts through malloc. Elsewhere only operator new is counted.
+#if defined(__GLIBC__)
+ #define WVFRM_COUNT_MALLOC 1
+#else
+ #define WVFRM_COUNT_MALLOC 0
+#endif
+
+namespace
+{
+std::atomic<bool> countAllocations { false };
+std::atomic<int> allocationCount { 0 };
+
+void noteAllocation() noexcept
+{
+    if (countAllocations.load(std::memory_order_relaxed))
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* allocate(std::size_t size, std::size_t alignment)
+{
+   #if ! WVFRM_COUNT_MALLOC
+    noteAllocation();
+   #endif
+
+    size = size == 0 ? 1 : size;
+    auto* pointer = alignment > alignof(std::max_align_t)
+        ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+        : std::malloc(size);
+
+    if (pointer == nullptr)
+        throw std::bad_alloc();
+
+    return pointer;
+}
+} // namespace
+
+#if WVFRM_COUNT_MALLOC
+extern "C"
+{
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* pointer, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+
+void* malloc(std::size_t size) noexcept
+{
+    noteAllocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept
+{
+    noteAllocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, std::size_t size) noexcept
+{
+    noteAllocation();
+    return __libc_realloc(pointer, size);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept
+{
+    noteAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** result, std::size_t alignment, std::size_t size) noexcept
+{
+    noteAllocation();
+    *result = __libc_memalign(alignment, size);
+    return *result != nullptr ? 0 : ENOMEM;
+}
+}
+#endif
+
+void* operator new(std::size_t size)
+{
+    return allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+AllocationProbe::AllocationProbe()
+{
+    allocationCount.store(0);
+    countAllocations.store(true);
+}
+
+AllocationProbe::~AllocationProbe()
+{
+    countAllocations.store(false);
+}
+
+int AllocationProbe::count() const
+{
+    countAllocations.store(false);
+    return allocationCount.load();
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// Test-only allocation hook for the wvfrm_allocation_tests binary: its global operator new, and
+// on glibc malloc, calloc and realloc too, count every allocation made on any thread while a
+// probe is open. It lives in a binary of its own so the other suites keep the standard allocator.
+
+// Counts the allocations made between construction and count().
+class AllocationProbe
+{
+public:
+    AllocationProbe();
+    ~AllocationProbe();
+
+    int count() const;
+};
@@ -0,0 +1,21 @@
+#include <cstdlib>
+#include <iostream>
+
+// The suites here run under the counting allocator in AllocationHook.cpp.
+bool runFrameArenaTests();
+bool runWaveformRendererTests();
+
+int main()
+{
+    const auto arenaOk = runFrameArenaTests();
+    const auto rendererOk = runWaveformRendererTests();
+
+    if (arenaOk && rendererOk)
+    {
+        std::cout << "All allocation tests passed." << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::cerr << "At least one allocation test suite failed." << std::endl;
+    return EXIT_FAILURE;
+}
@@ -1,6 +1,7 @@
 #include "dsp/AnalysisRingBuffer.h"
 
 #include <atomic>
+#include <chrono>
 #include <cmath>
 #include <iostream>
 #include <thread>
@@ -86,6 +87,83 @@ bool runAnalysisRingBufferTests()
         ok = false;
     }
 
+    {
+        wvfrm::AnalysisRingBuffer smallRing;
+        smallRing.prepare(2, 8);
+
+        juce::AudioBuffer<float> oversized(2, 21);
+        for (int i = 0; i < 21; ++i)
+        {
+            oversized.setSample(0, i, static_cast<float>(i + 1));
+            oversized.setSample(1, i, static_cast<float>(-(i + 1)));
+        }
+
+        smallRing.pushBuffer(oversized);
+
+        if (! smallRing.copyMostRecent(out, 8))
+        {
+            std::cerr << "AnalysisRingBuffer: expected copy after block larger than capacity." << std::endl;
+            ok = false;
+        }
+        else if (out.getSample(0, 0) != 14.0f
+                 || out.getSample(0, 7) != 21.0f
+                 || out.getSample(1, 7) != -21.0f
+                 || ! isContiguousAscending(out))
+        {
+            std::cerr << "AnalysisRingBuffer: block larger than capacity should keep only its newest samples." << std::endl;
+            ok = false;
+        }
+    }
+
+    {
+        // Ring holds absolute samples 3..10 as values 4..11; slot 0 wraps at absolute 8.
+        wvfrm::AnalysisRingBuffer::ReadSpans spans;
+        if (! ring.readWindowEndingAt(spans, 6, 11))
+        {
+            std::cerr << "AnalysisRingBuffer: expected in-place read ending at sample 11." << std::endl;
+            ok = false;
+        }
+        else
+        {
+            auto contentsOk = spans.numSamples == 6 && spans.startSample == 5 && spans.firstSize == 3 && spans.secondSize() == 3;
+
+            for (int i = 0; contentsOk && i < spans.numSamples; ++i)
+                contentsOk = spans.getSample(0, i) == static_cast<float>(i + 6);
+
+            contentsOk = contentsOk && spans.firstSpan(0)[0] == 6.0f && spans.secondSpan(0)[0] == 9.0f;
+
+            if (! contentsOk)
+            {
+                std::cerr << "AnalysisRingBuffer: in-place read should split [6..11] at the wrap." << std::endl;
+                ok = false;
+            }
+
+            if (! ring.isReadStillValid(spans))
+            {
+                std::cerr << "AnalysisRingBuffer: untouched in-place read should stay valid." << std::endl;
+                ok = false;
+            }
+
+            juce::AudioBuffer<float> small(1, 2);
+            small.clear();
+            ring.pushBuffer(small);
+
+            if (! ring.isReadStillValid(spans))
+            {
+                std::cerr << "AnalysisRingBuffer: in-place read should survive writes that do not reach it." << std::endl;
+                ok = false;
+            }
+
+            ring.pushBuffer(small);
+
+            if (ring.isReadStillValid(spans))
+            {
+                std::cerr << "AnalysisRingBuffer: in-place read should be invalid once its oldest sample is overwritten." << std::endl;
+                ok = false;
+            }
+        }
+    }
+
     {
         wvfrm::AnalysisRingBuffer concurrentRing;
         concurrentRing.prepare(1, 512);
@@ -154,5 +232,76 @@ bool runAnalysisRingBufferTests()
 
     }
 
+    {
+        // Windows spanning most of the ring must keep succeeding while the writer streams blocks.
+        constexpr auto capacity = 48000;
+        wvfrm::AnalysisRingBuffer pressuredRing;
+        pressuredRing.prepare(2, capacity);
+
+        std::atomic<bool> stopWriter { false };
+
+        std::thread writer([&]()
+        {
+            juce::AudioBuffer<float> block(2, 32);
+            float value = 1.0f;
+
+            while (! stopWriter.load(std::memory_order_acquire))
+            {
+                for (int s = 0; s < 32; ++s)
+                {
+                    block.setSample(0, s, value);
+                    block.setSample(1, s, -value);
+                    value += 1.0f;
+                }
+
+                pressuredRing.pushBuffer(block);
+
+                // Keep the float sample values exactly representable.
+                if (value > 8.0e6f)
+                    break;
+
+                // Roughly ten times real time at 48 kHz.
+                std::this_thread::sleep_for(std::chrono::microseconds(60));
+            }
+        });
+
+        while (pressuredRing.getTotalWrittenSamples() < capacity)
+            std::this_thread::yield();
+
+        juce::AudioBuffer<float> window;
+        auto successes = 0;
+
+        for (int i = 0; i < 200; ++i)
+        {
+            int64_t firstSample = 0;
+            const auto end = pressuredRing.getTotalWrittenSamples();
+
+            if (! pressuredRing.copyWindowEndingAt(window, 40000, end, &firstSample))
+                continue;
+
+            ++successes;
+
+            if (window.getSample(0, 0) != static_cast<float>(firstSample + 1)
+                || window.getSample(1, window.getNumSamples() - 1) != -static_cast<float>(firstSample + window.getNumSamples())
+                || ! isContiguousAscending(window))
+            {
+                std::cerr << "AnalysisRingBuffer: large window read returned samples that do not match its start." << std::endl;
+                ok = false;
+                break;
+            }
+        }
+
+        stopWriter.store(true, std::memory_order_release);
+        writer.join();
+
+        const auto stats = pressuredRing.getReadStats();
+        if (successes == 0 || stats.failedReads > 100)
+        {
+            std::cerr << "AnalysisRingBuffer: large window reads kept failing under writer pressure ("
+                      << successes << " ok, " << stats.failedReads << " failed)." << std::endl;
+            ok = false;
+        }
+    }
+
     return ok;
 }
@@ -0,0 +1,410 @@
+#include "dsp/AnalysisRingHost.h"
+
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+using Layout = wvfrm::AnalysisRingHost::Layout;
+
+float rampAt(int64_t position, int channel)
+{
+    const auto value = static_cast<float>(position % 997) / 997.0f;
+    return channel == 0 ? value : -value;
+}
+
+// Stands in for processBlock: adopt any parked replacement, then push the next block of ramp.
+bool pushRamp(wvfrm::AnalysisRingHost& host, int64_t& position, int numSamples)
+{
+    juce::AudioBuffer<float> block(2, numSamples);
+    for (int channel = 0; channel < 2; ++channel)
+        for (int s = 0; s < numSamples; ++s)
+            block.setSample(channel, s, rampAt(position + s, channel));
+
+    auto adopted = false;
+    host.beginBlock(adopted).pushBuffer(block);
+    position += numSamples;
+    return adopted;
+}
+
+bool checkRamp(const wvfrm::AnalysisRingBuffer& ring, int numSamples, const char* context)
+{
+    juce::AudioBuffer<float> window;
+    int64_t firstSample = 0;
+    if (! ring.copyWindowEndingAt(window, numSamples, ring.getTotalWrittenSamples(), &firstSample)
+        || window.getNumSamples() != numSamples)
+    {
+        std::cerr << "AnalysisRingHost: " << context << ": window of " << numSamples << " samples unavailable." << std::endl;
+        return false;
+    }
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        for (int s = 0; s < numSamples; ++s)
+        {
+            if (window.getSample(channel, s) != rampAt(firstSample + s, channel))
+            {
+                std::cerr << "AnalysisRingHost: " << context << ": discontinuity at sample " << firstSample + s << "." << std::endl;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+Layout makeLayout(int capacity, double sampleRate = 48000.0, wvfrm::SampleFormat format = wvfrm::SampleFormat::float32)
+{
+    Layout layout;
+    layout.channels = 2;
+    layout.capacity = capacity;
+    layout.format = format;
+    layout.sampleRate = sampleRate;
+    return layout;
+}
+
+bool runGrowTest()
+{
+    wvfrm::AnalysisRingHost host;
+    int64_t position = 0;
+
+    host.rebuild(makeLayout(16384));
+    while (position < 20000)
+        pushRamp(host, position, 480);
+
+    if (! host.rebuild(makeLayout(65536)) || host.reader().getCapacity() != 16384)
+    {
+        std::cerr << "AnalysisRingHost: the replacement should wait for the audio thread." << std::endl;
+        return false;
+    }
+
+    if (! pushRamp(host, position, 480) || host.reader().getCapacity() != 65536)
+    {
+        std::cerr << "AnalysisRingHost: the next block should adopt the grown ring." << std::endl;
+        return false;
+    }
+
+    host.releaseRetired();
+
+    for (int block = 0; block < 10; ++block)
+        pushRamp(host, position, 480);
+
+    if (host.reader().getTotalWrittenSamples() != position)
+    {
+        std::cerr << "AnalysisRingHost: the sample clock should run on across the swap." << std::endl;
+        return false;
+    }
+
+    // Everything the old ring held plus what arrived since has to read back seamlessly.
+    return checkRamp(host.reader(), 16384 + 11 * 480 - 480, "grow");
+}
+
+bool runConcurrentSwapTest()
+{
+    wvfrm::AnalysisRingHost host;
+    host.rebuild(makeLayout(16384));
+
+    std::atomic<bool> running { true };
+    std::atomic<int64_t> written { 0 };
+
+    std::thread audio([&]
+    {
+        int64_t position = 0;
+        while (running.load())
+        {
+            pushRamp(host, position, 256);
+            written.store(position);
+            std::this_thread::yield();
+        }
+    });
+
+    const int capacities[] { 65536, 32768, 131072, 16384, 65536 };
+    for (const auto capacity : capacities)
+    {
+        while (! host.rebuild(makeLayout(capacity)))
+            std::this_thread::yield();
+
+        while (host.reader().getCapacity() != capacity)
+            std::this_thread::yield();
+
+        host.releaseRetired();
+    }
+
+    const auto target = written.load() + 40000;
+    while (written.load() < target)
+        std::this_thread::yield();
+
+    running.store(false);
+    audio.join();
+
+    return checkRamp(host.reader(), 32768, "concurrent swaps");
+}
+
+bool runSampleRateChangeTest()
+{
+    wvfrm::AnalysisRingHost host;
+    int64_t position = 0;
+
+    host.noteSampleRateChange(48000.0, 0);
+    host.rebuild(makeLayout(16384, 48000.0));
+
+    // A slow tone, so linear interpolation is near exact.
+    juce::AudioBuffer<float> block(2, 500);
+    const auto toneAt = [](double seconds) { return static_cast<float>(std::sin(2.0 * juce::MathConstants<double>::pi * 50.0 * seconds)); };
+
+    while (position < 40000)
+    {
+        for (int channel = 0; channel < 2; ++channel)
+            for (int s = 0; s < block.getNumSamples(); ++s)
+                block.setSample(channel, s, toneAt(static_cast<double>(position + s) / 48000.0));
+
+        auto adopted = false;
+        host.beginBlock(adopted).pushBuffer(block);
+        position += block.getNumSamples();
+    }
+
+    host.noteSampleRateChange(96000.0, position);
+    host.rebuild(makeLayout(65536, 96000.0));
+
+    juce::AudioBuffer<float> silence(2, 64);
+    silence.clear();
+    auto adopted = false;
+    host.beginBlock(adopted).pushBuffer(silence);
+    position += silence.getNumSamples();
+
+    if (! adopted || host.reader().getTotalWrittenSamples() != position)
+    {
+        std::cerr << "AnalysisRingHost: rate change should keep the clock and swap on the next block." << std::endl;
+        return false;
+    }
+
+    // 16384 samples at 48 kHz become ~32768 at 96 kHz, still ending where the old rate stopped.
+    juce::AudioBuffer<float> window;
+    int64_t firstSample = 0;
+    if (! host.reader().copyWindowEndingAt(window, 32000, position - 64, &firstSample) || window.getNumSamples() != 32000)
+    {
+        std::cerr << "AnalysisRingHost: resampled history should cover twice as many samples." << std::endl;
+        return false;
+    }
+
+    const auto oldEndSeconds = 40000.0 / 48000.0;
+    for (int s = 0; s < window.getNumSamples(); s += 97)
+    {
+        const auto seconds = oldEndSeconds - static_cast<double>(window.getNumSamples() - s) / 96000.0;
+        if (std::abs(window.getSample(0, s) - toneAt(seconds)) > 2.0e-3f)
+        {
+            std::cerr << "AnalysisRingHost: resampled history drifts from the tone at " << s << "." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool runFormatChangeTest()
+{
+    wvfrm::AnalysisRingHost host;
+    int64_t position = 0;
+
+    host.rebuild(makeLayout(16384));
+    while (position < 8000)
+        pushRamp(host, position, 400);
+
+    host.rebuild(makeLayout(16384, 48000.0, wvfrm::SampleFormat::int16));
+    pushRamp(host, position, 400);
+
+    if (host.reader().getFormat() != wvfrm::SampleFormat::int16)
+    {
+        std::cerr << "AnalysisRingHost: format change was not adopted." << std::endl;
+        return false;
+    }
+
+    juce::AudioBuffer<float> window;
+    int64_t firstSample = 0;
+    host.reader().copyWindowEndingAt(window, static_cast<int>(position), position, &firstSample);
+
+    for (int s = 0; s < window.getNumSamples(); ++s)
+    {
+        const auto expected = rampAt(firstSample + s, 0);
+        if (std::abs(window.getSample(0, s) - expected) > wvfrm::SampleCodec::maxError(wvfrm::SampleFormat::int16, expected))
+        {
+            std::cerr << "AnalysisRingHost: history was not carried into the int16 ring." << std::endl;
+            return false;
+        }
+    }
+
+    return window.getNumSamples() == position;
+}
+
+bool runReclaimTest()
+{
+    wvfrm::AnalysisRingHost host;
+    int64_t position = 0;
+
+    host.rebuild(makeLayout(16384));
+    pushRamp(host, position, 512);
+
+    // Audio stalls: the first replacement is never adopted and must be superseded, not queued.
+    host.rebuild(makeLayout(32768));
+    if (! host.rebuild(makeLayout(65536)) || host.getTargetLayout() != makeLayout(65536))
+    {
+        std::cerr << "AnalysisRingHost: an unadopted replacement should be reclaimed." << std::endl;
+        return false;
+    }
+
+    pushRamp(host, position, 512);
+    if (host.reader().getCapacity() != 65536)
+    {
+        std::cerr << "AnalysisRingHost: the latest replacement should be the one adopted." << std::endl;
+        return false;
+    }
+
+    return checkRamp(host.reader(), 1024, "reclaim");
+}
+
+bool runReadScopeTest()
+{
+    wvfrm::AnalysisRingHost host;
+    int64_t position = 0;
+
+    host.rebuild(makeLayout(16384));
+    pushRamp(host, position, 512);
+    host.rebuild(makeLayout(32768));
+
+    {
+        // A reader on another thread may still hold spans into the ring being retired.
+        const wvfrm::AnalysisRingHost::ReadScope scope(host);
+        pushRamp(host, position, 512);
+
+        if (host.releaseRetired() || host.rebuild(makeLayout(65536)))
+        {
+            std::cerr << "AnalysisRingHost: a retired ring must outlive an open read scope." << std::endl;
+            return false;
+        }
+    }
+
+    if (! host.releaseRetired() || ! host.rebuild(makeLayout(65536)))
+    {
+        std::cerr << "AnalysisRingHost: the retired ring should go once the scope closes." << std::endl;
+        return false;
+    }
+
+    pushRamp(host, position, 512);
+    return checkRamp(host.reader(), 1536, "read scope");
+}
+
+bool runAdoptionCatchUpTest()
+{
+    using Host = wvfrm::AnalysisRingHost;
+    Host host;
+    int64_t position = 0;
+
+    host.rebuild(makeLayout(65536));
+    while (position < 30000)
+        pushRamp(host, position, 500);
+
+    // The audio thread writes a long stretch into the live ring after the replacement was
+    // parked, more than it may copy when it adopts it.
+    auto adopted = false;
+    auto& live = host.beginBlock(adopted);
+    host.rebuild(makeLayout(131072));
+
+    juce::AudioBuffer<float> stretch(2, 20000);
+    for (int channel = 0; channel < 2; ++channel)
+        for (int s = 0; s < stretch.getNumSamples(); ++s)
+            stretch.setSample(channel, s, rampAt(position + s, channel));
+
+    live.pushBuffer(stretch);
+    position += stretch.getNumSamples();
+
+    if (! pushRamp(host, position, 500) || host.reader().getTotalWrittenSamples() != position)
+    {
+        std::cerr << "AnalysisRingHost: a long gap at adoption should keep the clock." << std::endl;
+        return false;
+    }
+
+    if (! checkRamp(host.reader(), Host::maxAdoptionCatchUp + 500, "bounded catch-up"))
+        return false;
+
+    // Only the newest maxAdoptionCatchUp samples were copied; the stretch before them is a gap.
+    juce::AudioBuffer<float> window;
+    const auto skipped = position - 500 - Host::maxAdoptionCatchUp - 1;
+    if (! host.reader().copyWindowEndingAt(window, 1, skipped + 1) || juce::exactlyEqual(window.getSample(0, 0), rampAt(skipped, 0)))
+    {
+        std::cerr << "AnalysisRingHost: adoption should not copy more than maxAdoptionCatchUp samples." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool runCapacityPolicyTest()
+{
+    using Host = wvfrm::AnalysisRingHost;
+
+    for (const auto window : { 0.0, 1000.0, 48000.0, 9.0 * 96000.0, 1.0e9 })
+    {
+        const auto capacity = Host::capacityForWindow(window);
+        const auto isPowerOfTwo = (capacity & (capacity - 1)) == 0;
+        const auto fits = capacity == Host::maximumCapacity || capacity >= window * 1.25;
+
+        if (! isPowerOfTwo || ! fits || capacity < Host::minimumCapacity || capacity > Host::maximumCapacity)
+        {
+            std::cerr << "AnalysisRingHost: bad capacity " << capacity << " for a " << window << " sample window." << std::endl;
+            return false;
+        }
+    }
+
+    Host host;
+    host.rebuild(makeLayout(65536));
+
+    if (host.needsResize(65536) || host.needsResize(32768) || ! host.needsResize(131072) || ! host.needsResize(16384)
+        || host.chooseCapacity(32768) != 65536 || host.chooseCapacity(131072) != 131072)
+    {
+        std::cerr << "AnalysisRingHost: resize hysteresis is wrong." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool runGenerationTest()
+{
+    wvfrm::AnalysisRingBuffer first;
+    wvfrm::AnalysisRingBuffer second;
+    first.prepare(1, 4096);
+    second.prepare(1, 4096);
+
+    juce::AudioBuffer<float> block(1, 1024);
+    block.clear();
+    first.pushBuffer(block);
+    second.pushBuffer(block);
+
+    // Spans from a retired ring must never validate against its replacement.
+    wvfrm::AnalysisRingBuffer::ReadSpans spans;
+    if (! first.readWindowEndingAt(spans, 512, 1024) || second.isReadStillValid(spans))
+    {
+        std::cerr << "AnalysisRingHost: ring generations should be unique across instances." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+} // namespace
+
+bool runAnalysisRingHostTests()
+{
+    bool ok = true;
+    ok = runGrowTest() && ok;
+    ok = runConcurrentSwapTest() && ok;
+    ok = runSampleRateChangeTest() && ok;
+    ok = runFormatChangeTest() && ok;
+    ok = runReclaimTest() && ok;
+    ok = runReadScopeTest() && ok;
+    ok = runAdoptionCatchUpTest() && ok;
+    ok = runCapacityPolicyTest() && ok;
+    ok = runGenerationTest() && ok;
+    return ok;
+}
@@ -57,5 +57,32 @@ bool runBandAnalyzerTests()
         ok = false;
     }
 
+    // Batched analysis must agree with the scalar path for every segment, including ragged
+    // lengths, an empty segment, and a final batch that does not fill the SIMD lanes.
+    const auto mixed = makeSine(1700.0, sampleRate, numSamples);
+    const int lengths[] { 576, 575, 64, 1, 0, 2048, 577, 300, 1000, 12, 576 };
+    constexpr auto numSegments = static_cast<int>(std::size(lengths));
+    const float* segments[numSegments] {};
+
+    for (int i = 0; i < numSegments; ++i)
+        segments[i] = mixed.data() + 97 * i;
+
+    wvfrm::BandEnergies batched[numSegments];
+    analyzer.analyzeSegments(segments, lengths, numSegments, sampleRate, 0.35f, batched);
+
+    for (int i = 0; i < numSegments; ++i)
+    {
+        const auto scalar = analyzer.analyzeSegment(segments[i], lengths[i], sampleRate, 0.35f);
+        const auto tolerance = [](float reference) { return 1.0e-5f + 1.0e-4f * reference; };
+
+        if (std::abs(batched[i].low - scalar.low) > tolerance(scalar.low)
+            || std::abs(batched[i].mid - scalar.mid) > tolerance(scalar.mid)
+            || std::abs(batched[i].high - scalar.high) > tolerance(scalar.high))
+        {
+            std::cerr << "BandAnalyzer3: batched segment " << i << " differs from the scalar path." << std::endl;
+            ok = false;
+        }
+    }
+
     return ok;
 }
@@ -0,0 +1,147 @@
+#include "dsp/BandAnalyzer.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+constexpr auto sampleRate = 48000.0;
+
+std::vector<float> tone(double frequency, int numSamples)
+{
+    std::vector<float> samples(static_cast<size_t>(numSamples));
+    for (int i = 0; i < numSamples; ++i)
+        samples[static_cast<size_t>(i)] = static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * frequency * i / sampleRate));
+
+    return samples;
+}
+
+// RMS per band over the second half of a tone, once the filters have settled.
+template <int NumBands>
+typename wvfrm::BandAnalyzer<NumBands>::Energies settledEnergies(const wvfrm::BandAnalyzer<NumBands>& analyzer, double frequency)
+{
+    constexpr auto numSamples = 48000;
+    const auto samples = tone(frequency, numSamples);
+
+    typename wvfrm::BandAnalyzer<NumBands>::Stream stream;
+    typename wvfrm::BandAnalyzer<NumBands>::Energies sums {};
+    analyzer.accumulate(stream, samples.data(), numSamples / 2, sums);
+
+    sums = {};
+    analyzer.accumulate(stream, samples.data() + numSamples / 2, numSamples / 2, sums);
+
+    for (auto& sum : sums)
+        sum = std::sqrt(sum / static_cast<float>(numSamples / 2));
+
+    return sums;
+}
+
+template <int NumBands>
+bool runBandPlacementTest()
+{
+    using Analyzer = wvfrm::BandAnalyzer<NumBands>;
+    const Analyzer analyzer;
+    const auto& splits = analyzer.getSplitFrequencies();
+
+    for (int band = 0; band < NumBands; ++band)
+    {
+        // Geometric middle of the band; the outer bands end at the floor and the ceiling.
+        const auto lower = band > 0 ? splits[static_cast<size_t>(band - 1)] : Analyzer::defaultFloorHz;
+        const auto upper = band < NumBands - 1 ? splits[static_cast<size_t>(band)] : Analyzer::defaultCeilingHz;
+        const auto energies = settledEnergies(analyzer, std::sqrt(lower * upper));
+
+        for (int other = 0; other < NumBands; ++other)
+        {
+            if (other != band && energies[static_cast<size_t>(other)] >= energies[static_cast<size_t>(band)])
+            {
+                std::cerr << "BandAnalyzer<" << NumBands << ">: tone in band " << band << " favoured band " << other << "." << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // Exactly at a split both neighbours are 6 dB down, so they carry equal energy.
+    for (int split = 0; split < NumBands - 1; ++split)
+    {
+        const auto energies = settledEnergies(analyzer, splits[static_cast<size_t>(split)]);
+        const auto below = energies[static_cast<size_t>(split)];
+        const auto above = energies[static_cast<size_t>(split + 1)];
+        const auto expected = 0.5f / std::sqrt(2.0f);
+
+        if (std::abs(below - above) > 0.05f * expected || std::abs(below - expected) > 0.1f * expected)
+        {
+            std::cerr << "BandAnalyzer<" << NumBands << ">: split " << split << " gave " << below << " / " << above
+                      << " instead of " << expected << " each." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool runDefaultSplitsTest()
+{
+    const auto splits = wvfrm::BandAnalyzer<3>::defaultSplits();
+    if (std::abs(splits[0] - 200.0) > 1.0e-6 || std::abs(splits[1] - 2000.0) > 1.0e-6)
+    {
+        std::cerr << "BandAnalyzer<3>: default splits should match BandAnalyzer3's 200 Hz / 2 kHz." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool runCustomSplitsTest()
+{
+    wvfrm::BandAnalyzer<4> analyzer;
+    analyzer.prepare(sampleRate, { 100.0, 1000.0, 5000.0 });
+
+    const auto energies = settledEnergies(analyzer, 2500.0);
+    if (! (energies[2] > energies[0] && energies[2] > energies[1] && energies[2] > energies[3]))
+    {
+        std::cerr << "BandAnalyzer<4>: 2.5 kHz should land between custom splits at 1 and 5 kHz." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool runStreamingTest()
+{
+    const auto input = tone(730.0, 9000);
+    const wvfrm::BandAnalyzer<8> analyzer;
+
+    wvfrm::BandAnalyzer<8>::Stream whole;
+    wvfrm::BandAnalyzer<8>::Energies wholeSums {};
+    analyzer.accumulate(whole, input.data(), static_cast<int>(input.size()), wholeSums);
+
+    wvfrm::BandAnalyzer<8>::Stream chunked;
+    wvfrm::BandAnalyzer<8>::Energies chunkedSums {};
+    for (size_t offset = 0; offset < input.size(); offset += 41)
+        analyzer.accumulate(chunked, input.data() + offset, static_cast<int>(std::min<size_t>(41, input.size() - offset)), chunkedSums);
+
+    for (size_t band = 0; band < wholeSums.size(); ++band)
+    {
+        if (std::abs(wholeSums[band] - chunkedSums[band]) > 1.0e-3f * juce::jmax(1.0f, wholeSums[band]))
+        {
+            std::cerr << "BandAnalyzer<8>: band " << band << " depends on how the stream was split." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+} // namespace
+
+bool runCrossoverBandAnalyzerTests()
+{
+    bool ok = true;
+    ok = runDefaultSplitsTest() && ok;
+    ok = runBandPlacementTest<3>() && ok;
+    ok = runBandPlacementTest<4>() && ok;
+    ok = runBandPlacementTest<8>() && ok;
+    ok = runCustomSplitsTest() && ok;
+    ok = runStreamingTest() && ok;
+    return ok;
+}
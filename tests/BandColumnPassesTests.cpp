@@ -0,0 +1,231 @@
+#include "ui/BandColumnPasses.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+struct Track
+{
+    wvfrm::BandPlanes energies;
+    std::vector<uint8_t> active;
+    std::vector<float> amplitude;
+};
+
+Track makeTrack(int width, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    Track track;
+    track.energies.assign(static_cast<size_t>(width));
+    track.active.resize(static_cast<size_t>(width));
+    track.amplitude.resize(static_cast<size_t>(width));
+
+    for (size_t x = 0; x < track.active.size(); ++x)
+    {
+        track.energies.set(x, { unit(random), unit(random), unit(random) });
+        track.active[x] = static_cast<uint8_t>(unit(random) < 0.85f ? 1 : 0);
+        track.amplitude[x] = unit(random);
+    }
+
+    // A loud, abrupt seam that the blur must not smear across.
+    track.active.front() = track.active.back() = 1;
+    track.amplitude.front() = 0.9f;
+    track.energies.set(0, { 1.0f, 0.0f, 0.0f });
+    track.energies.set(track.active.size() - 1, { 0.0f, 0.0f, 1.0f });
+    return track;
+}
+
+// The per-column blur the passes replace, neighbour by neighbour.
+wvfrm::BandEnergies referenceBlur(const Track& track, int x, float colorMatch, bool wrap)
+{
+    const auto width = static_cast<int>(track.active.size());
+    const auto wide = colorMatch >= 0.55f;
+    const int narrowOffsets[3] = { -1, 0, 1 };
+    const float narrowWeights[3] = { 1.0f, 2.0f, 1.0f };
+    const int wideOffsets[5] = { -2, -1, 0, 1, 2 };
+    const float wideWeights[5] = { 1.0f, 2.0f, 3.0f, 2.0f, 1.0f };
+    const auto* offsets = wide ? wideOffsets : narrowOffsets;
+    const auto* weights = wide ? wideWeights : narrowWeights;
+    const auto mix = juce::jmap(colorMatch, 0.0f, 1.0f, 0.2f, 1.0f);
+
+    const auto self = track.energies.at(static_cast<size_t>(x));
+    float weightSum = 0.0f, lowSum = 0.0f, midSum = 0.0f, highSum = 0.0f;
+
+    for (int i = 0; i < (wide ? 5 : 3); ++i)
+    {
+        if (! wrap && (x + offsets[i] < 0 || x + offsets[i] >= width))
+            continue;
+
+        auto nx = (x + offsets[i] + width) % width;
+        const auto neighbour = track.energies.at(static_cast<size_t>(nx));
+        if (track.active[static_cast<size_t>(nx)] == 0)
+            continue;
+
+        if ((x == 0 && nx == width - 1) || (x == width - 1 && nx == 0))
+        {
+            const auto loudest = juce::jmax(track.amplitude[static_cast<size_t>(x)], track.amplitude[static_cast<size_t>(nx)]);
+            const auto delta = std::abs(self.low - neighbour.low) + std::abs(self.mid - neighbour.mid) + std::abs(self.high - neighbour.high);
+            if (loudest >= 0.08f && delta > 0.35f)
+                continue;
+        }
+
+        weightSum += weights[i];
+        lowSum += neighbour.low * weights[i];
+        midSum += neighbour.mid * weights[i];
+        highSum += neighbour.high * weights[i];
+    }
+
+    if (weightSum <= 0.0f)
+        return self;
+
+    return { juce::jmap(mix, self.low, lowSum / weightSum),
+             juce::jmap(mix, self.mid, midSum / weightSum),
+             juce::jmap(mix, self.high, highSum / weightSum) };
+}
+
+bool near(float a, float b, float tolerance)
+{
+    return std::abs(a - b) <= tolerance;
+}
+
+bool runBlurTest()
+{
+    constexpr auto width = 300;
+    const auto track = makeTrack(width, 3);
+
+    for (const auto wrap : { true, false })
+    {
+        for (const auto colorMatch : { 0.3f, 0.8f })
+        {
+            // Tiles of uneven sizes, including ones that start and end at the seam.
+            for (int first = 0; first < width;)
+            {
+                const auto end = juce::jmin(width, first + 1 + (first * 7) % 97);
+                std::vector<float> low(static_cast<size_t>(end - first)), mid(low.size()), high(low.size());
+                wvfrm::blurBandColumns(track.energies, track.active.data(), track.amplitude.data(), colorMatch, wrap, first, end, { low.data(), mid.data(), high.data() });
+
+                for (int x = first; x < end; ++x)
+                {
+                    const auto expected = referenceBlur(track, x, colorMatch, wrap);
+                    const auto i = static_cast<size_t>(x - first);
+
+                    if (! near(low[i], expected.low, 1.0e-5f) || ! near(mid[i], expected.mid, 1.0e-5f) || ! near(high[i], expected.high, 1.0e-5f))
+                    {
+                        std::cerr << "BandColumnPasses: blur of column " << x << " does not match the per-column reference." << std::endl;
+                        return false;
+                    }
+                }
+
+                first = end;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool runSmoothTest()
+{
+    constexpr auto width = 64;
+    const auto track = makeTrack(width, 11);
+    const auto attack = 0.6f;
+    const auto release = 0.9f;
+
+    wvfrm::BandPlanes state;
+    state.assign(width, 0.25f);
+    std::vector<uint8_t> initialised(width, 1);
+    initialised[5] = 0;
+
+    auto expectedState = state;
+    std::vector<float> low(track.energies.low), mid(track.energies.mid), high(track.energies.high);
+    wvfrm::smoothBandColumns(state, initialised.data(), track.active.data(), 0, width, attack, release, false, { low.data(), mid.data(), high.data() });
+
+    for (size_t x = 0; x < static_cast<size_t>(width); ++x)
+    {
+        const auto target = track.energies.at(x);
+        auto ease = [&](float previous, float value)
+        {
+            const auto alpha = x == 5 ? 0.0f : (value > previous ? attack : release);
+            return alpha * previous + (1.0f - alpha) * value;
+        };
+
+        const wvfrm::BandEnergies expected { ease(expectedState.low[x], target.low),
+                                             ease(expectedState.mid[x], target.mid),
+                                             ease(expectedState.high[x], target.high) };
+
+        if (track.active[x] != 0)
+        {
+            if (! near(state.low[x], expected.low, 1.0e-6f) || ! near(high[x], expected.high, 1.0e-6f) || initialised[x] == 0)
+            {
+                std::cerr << "BandColumnPasses: smoothing of active column " << x << " is wrong." << std::endl;
+                return false;
+            }
+        }
+        else if (state.mid[x] != 0.25f)
+        {
+            std::cerr << "BandColumnPasses: an inactive column should keep its smoothing state." << std::endl;
+            return false;
+        }
+    }
+
+    // A reset takes every active column straight to its value.
+    wvfrm::smoothBandColumns(state, initialised.data(), track.active.data(), 0, width, attack, release, true, { low.data(), mid.data(), high.data() });
+    if (state.low[0] != low[0])
+    {
+        std::cerr << "BandColumnPasses: a reset should take the value as is." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool runNormalizeAndPeakTest()
+{
+    constexpr auto width = 40;
+    const auto track = makeTrack(width, 17);
+
+    const auto peak = wvfrm::peakBandColumns(track.energies, track.active.data());
+    wvfrm::BandEnergies expected {};
+    for (size_t x = 0; x < static_cast<size_t>(width); ++x)
+    {
+        if (track.active[x] == 0)
+            continue;
+
+        expected.low = juce::jmax(expected.low, track.energies.low[x]);
+        expected.mid = juce::jmax(expected.mid, track.energies.mid[x]);
+        expected.high = juce::jmax(expected.high, track.energies.high[x]);
+    }
+
+    if (peak.low != expected.low || peak.mid != expected.mid || peak.high != expected.high)
+    {
+        std::cerr << "BandColumnPasses: peaks should cover exactly the active columns." << std::endl;
+        return false;
+    }
+
+    std::vector<float> low(track.energies.low), mid(track.energies.mid), high(track.energies.high);
+    low[3] = -0.5f;
+    wvfrm::normalizeBandColumns({ low.data(), mid.data(), high.data() }, width, { 0.5f, 2.0f, 1.0f });
+
+    if (low[3] != 0.0f || ! near(mid[7], track.energies.mid[7] / 2.0f, 1.0e-6f)
+        || low[10] != juce::jmin(1.0f, track.energies.low[10] / 0.5f))
+    {
+        std::cerr << "BandColumnPasses: normalization should divide by the peak and clamp to [0, 1]." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+} // namespace
+
+bool runBandColumnPassesTests()
+{
+    bool ok = true;
+    ok = runBlurTest() && ok;
+    ok = runSmoothTest() && ok;
+    ok = runNormalizeAndPeakTest() && ok;
+    return ok;
+}
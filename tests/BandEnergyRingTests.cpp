@@ -0,0 +1,372 @@
+#include "dsp/AnalysisRingBuffer.h"
+#include "dsp/AnalysisRingHost.h"
+#include "dsp/BandEnergyRing.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+using Lane = wvfrm::BandEnergyRing::Lane;
+constexpr auto sampleRate = 48000.0;
+
+std::vector<float> tone(double frequency, int numSamples, int64_t firstSample = 0)
+{
+    std::vector<float> samples(static_cast<size_t>(numSamples));
+    for (int i = 0; i < numSamples; ++i)
+        samples[static_cast<size_t>(i)] = static_cast<float>(0.5 * std::sin(juce::MathConstants<double>::twoPi * frequency
+                                                                             * static_cast<double>(firstSample + i) / sampleRate));
+
+    return samples;
+}
+
+// Pushes the same mono signal to both channels of ring in blocks of blockSize.
+void pushStereo(wvfrm::AnalysisRingBuffer& ring, const std::vector<float>& samples, int blockSize)
+{
+    for (size_t offset = 0; offset < samples.size(); offset += static_cast<size_t>(blockSize))
+    {
+        const auto count = static_cast<int>(std::min(samples.size() - offset, static_cast<size_t>(blockSize)));
+        const float* channels[] { samples.data() + offset, samples.data() + offset };
+        ring.pushSamples(channels, 2, count);
+    }
+}
+
+bool runChunkingIndependenceTest()
+{
+    const auto input = tone(440.0, 24000);
+
+    wvfrm::BandEnergyRing whole;
+    whole.prepare(1, 32768, sampleRate);
+    const float* wholeChannels[] { input.data() };
+    whole.update(wholeChannels, 1, 0, static_cast<int>(input.size()));
+
+    wvfrm::BandEnergyRing ragged;
+    ragged.prepare(1, 32768, sampleRate);
+    for (size_t offset = 0; offset < input.size(); offset += 37)
+    {
+        const auto count = static_cast<int>(std::min<size_t>(37, input.size() - offset));
+        const float* channels[] { input.data() + offset };
+        ragged.update(channels, 1, static_cast<int64_t>(offset), count);
+    }
+
+    const auto records = static_cast<int64_t>(input.size()) / wvfrm::BandEnergyRing::samplesPerRecord;
+    for (int64_t record = 0; record < records; ++record)
+    {
+        wvfrm::BandEnergies expected;
+        wvfrm::BandEnergies actual;
+
+        if (! whole.read(Lane::channel, 0, record, record + 1, expected) || ! ragged.read(Lane::channel, 0, record, record + 1, actual)
+            || std::abs(expected.low - actual.low) > 1.0e-6f || std::abs(expected.mid - actual.mid) > 1.0e-6f
+            || std::abs(expected.high - actual.high) > 1.0e-6f)
+        {
+            std::cerr << "BandEnergyRing: record " << record << " depends on how the stream was split." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool runBandSelectivityTest()
+{
+    struct Case
+    {
+        double frequency;
+        int dominant; // 0 low, 1 mid, 2 high
+    };
+
+    const Case cases[] { { 80.0, 0 }, { 700.0, 1 }, { 9000.0, 2 } };
+
+    for (const auto& testCase : cases)
+    {
+        wvfrm::AnalysisRingBuffer ring;
+        ring.prepare(2, 32768);
+        ring.enableBandEnergies(sampleRate);
+        pushStereo(ring, tone(testCase.frequency, 24000), 480);
+
+        // A 12 ms window deep into the stream, as the view would ask for it.
+        wvfrm::BandEnergies energies;
+        if (! ring.getBandEnergies(Lane::channel, 0, 23000 - 576, 23000, energies))
+        {
+            std::cerr << "BandEnergyRing: a fully written window should be answered." << std::endl;
+            return false;
+        }
+
+        const float bands[] { energies.low, energies.mid, energies.high };
+        for (int band = 0; band < 3; ++band)
+        {
+            if (band != testCase.dominant && bands[band] >= bands[testCase.dominant])
+            {
+                std::cerr << "BandEnergyRing: " << testCase.frequency << " Hz did not land in band " << testCase.dominant
+                          << " (" << energies.low << ", " << energies.mid << ", " << energies.high << ")." << std::endl;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool runSteadyStateTest()
+{
+    // The streaming filters have run since the start, so the same tone gives the same level in
+    // every window rather than each one ramping up from silence.
+    wvfrm::AnalysisRingBuffer ring;
+    ring.prepare(2, 32768);
+    ring.enableBandEnergies(sampleRate);
+    pushStereo(ring, tone(80.0, 24000), 256);
+
+    wvfrm::BandEnergies first;
+    wvfrm::BandEnergies later;
+    // Whole periods of the tone, whole records on both ends.
+    if (! ring.getBandEnergies(Lane::mid, 0, 6400, 11200, first) || ! ring.getBandEnergies(Lane::mid, 0, 16000, 20800, later))
+    {
+        std::cerr << "BandEnergyRing: steady-state windows should be answered." << std::endl;
+        return false;
+    }
+
+    if (std::abs(first.low - later.low) > 0.01f * later.low)
+    {
+        std::cerr << "BandEnergyRing: low band drifts between windows (" << first.low << " vs " << later.low << ")." << std::endl;
+        return false;
+    }
+
+    // Mid of two identical channels is the signal itself; side is silence.
+    wvfrm::BandEnergies channel;
+    wvfrm::BandEnergies side;
+    ring.getBandEnergies(Lane::channel, 0, 16000, 20800, channel);
+    ring.getBandEnergies(Lane::side, 0, 16000, 20800, side);
+
+    if (std::abs(channel.low - later.low) > 1.0e-4f || side.low > 1.0e-6f)
+    {
+        std::cerr << "BandEnergyRing: mid/side lanes do not follow the channels." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool runCoverageTest()
+{
+    wvfrm::AnalysisRingBuffer ring;
+    ring.prepare(2, 16384);
+    wvfrm::BandEnergies energies;
+
+    pushStereo(ring, tone(440.0, 4096), 512);
+    if (ring.getBandEnergies(Lane::channel, 0, 1024, 2048, energies))
+    {
+        std::cerr << "BandEnergyRing: a ring without band energies enabled should decline." << std::endl;
+        return false;
+    }
+
+    ring.prepare(2, 16384, wvfrm::SampleFormat::float32, 100);
+    ring.enableBandEnergies(sampleRate);
+    pushStereo(ring, tone(440.0, 40000), 512);
+
+    const auto end = ring.getTotalWrittenSamples();
+
+    // The record the ring started part-way through was never complete.
+    if (ring.getBandEnergies(Lane::channel, 0, 100, 700, energies))
+    {
+        std::cerr << "BandEnergyRing: a partly written first record should not be reported." << std::endl;
+        return false;
+    }
+
+    // Overwritten history is gone.
+    if (ring.getBandEnergies(Lane::channel, 0, end - 20000, end - 19000, energies))
+    {
+        std::cerr << "BandEnergyRing: records older than the ring should be rejected." << std::endl;
+        return false;
+    }
+
+    // Windows reaching past the newest complete record shrink to it instead of failing.
+    if (! ring.getBandEnergies(Lane::channel, 0, end - 600, end + 32, energies) || energies.mid <= 0.0f)
+    {
+        std::cerr << "BandEnergyRing: the newest complete records should be readable." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool runHostRebuildTest()
+{
+    wvfrm::AnalysisRingHost host;
+    wvfrm::AnalysisRingHost::Layout layout;
+    layout.channels = 2;
+    layout.capacity = 16384;
+    layout.sampleRate = sampleRate;
+    host.rebuild(layout);
+
+    int64_t position = 0;
+    auto push = [&](int numSamples)
+    {
+        const auto samples = tone(1000.0, numSamples, position);
+        const float* channels[] { samples.data(), samples.data() };
+        auto adopted = false;
+        host.beginBlock(adopted).pushSamples(channels, 2, numSamples);
+        position += numSamples;
+    };
+
+    for (int block = 0; block < 20; ++block)
+        push(480);
+
+    layout.capacity = 65536;
+    host.rebuild(layout);
+    for (int block = 0; block < 20; ++block)
+        push(480);
+
+    host.releaseRetired();
+
+    wvfrm::BandEnergies seeded;
+    wvfrm::BandEnergies live;
+    const auto& ring = host.reader();
+
+    if (ring.getCapacity() != 65536 || ! ring.getBandEnergies(Lane::channel, 1, 8000, 8576, seeded)
+        || ! ring.getBandEnergies(Lane::channel, 1, position - 576, position, live))
+    {
+        std::cerr << "BandEnergyRing: a rebuilt ring should carry energies for its seeded history and new blocks." << std::endl;
+        return false;
+    }
+
+    if (std::abs(seeded.mid - live.mid) > 0.03f * live.mid)
+    {
+        std::cerr << "BandEnergyRing: energies jump across the rebuild (" << seeded.mid << " vs " << live.mid << ")." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+bool runSpanAdditivityTest()
+{
+    // A small ring laps many times, so spans start, end and cross rebases everywhere.
+    wvfrm::BandEnergyRing ring;
+    ring.prepare(1, 2048, sampleRate);
+
+    std::vector<float> input(20000);
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = static_cast<float>((0.1 + 0.9 * static_cast<double>(i % 3000) / 3000.0)
+                                      * std::sin(juce::MathConstants<double>::twoPi * 523.0 * static_cast<double>(i) / sampleRate));
+
+    const float* channels[] { input.data() };
+    ring.update(channels, 1, 0, static_cast<int>(input.size()));
+
+    const auto lastRecord = static_cast<int64_t>(input.size()) / wvfrm::BandEnergyRing::samplesPerRecord;
+    const int64_t lengths[] { 1, 2, 7, 16, 31 };
+
+    for (const auto length : lengths)
+    {
+        for (auto first = lastRecord - 31; first + length <= lastRecord; ++first)
+        {
+            wvfrm::BandEnergies span;
+            if (! ring.read(Lane::channel, 0, first, first + length, span))
+            {
+                std::cerr << "BandEnergyRing: span " << first << " + " << length << " should be held." << std::endl;
+                return false;
+            }
+
+            // The same span as the mean of its single records.
+            double expected = 0.0;
+            for (auto record = first; record < first + length; ++record)
+            {
+                wvfrm::BandEnergies single;
+                ring.read(Lane::channel, 0, record, record + 1, single);
+                expected += static_cast<double>(single.mid) * single.mid;
+            }
+
+            expected = std::sqrt(expected / static_cast<double>(length));
+            if (std::abs(span.mid - expected) > 1.0e-4 * expected + 1.0e-7)
+            {
+                std::cerr << "BandEnergyRing: span " << first << " + " << length << " gave " << span.mid
+                          << " instead of " << expected << "." << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // The record before a span is part of the lookup, so a span can cover one slot less than held.
+    wvfrm::BandEnergies energies;
+    if (ring.read(Lane::channel, 0, lastRecord - 40, lastRecord, energies))
+    {
+        std::cerr << "BandEnergyRing: spans longer than the held records should be rejected." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool runQuietAfterLoudTest()
+{
+    // A minute of full-scale audio, then a tone 80 dB down: the quiet span must read the same as
+    // it does on a ring that never saw the loud part.
+    constexpr auto quietAmplitude = 1.0e-4f;
+    constexpr auto loudSamples = 60 * 48000;
+    constexpr auto quietSamples = 9600;
+
+    auto makeQuiet = [](int64_t firstSample)
+    {
+        auto samples = tone(1000.0, quietSamples, firstSample);
+        for (auto& sample : samples)
+            sample *= 2.0f * quietAmplitude;
+
+        return samples;
+    };
+
+    wvfrm::BandEnergyRing loudFirst;
+    loudFirst.prepare(1, 65536, sampleRate);
+
+    const auto loud = tone(1000.0, 48000);
+    for (int64_t position = 0; position < loudSamples; position += 48000)
+    {
+        std::vector<float> block(loud);
+        for (auto& sample : block)
+            sample *= 2.0f;
+
+        const float* channels[] { block.data() };
+        loudFirst.update(channels, 1, position, 48000);
+    }
+
+    const auto quiet = makeQuiet(loudSamples);
+    const float* quietChannels[] { quiet.data() };
+    loudFirst.update(quietChannels, 1, loudSamples, quietSamples);
+
+    wvfrm::BandEnergyRing quietOnly;
+    quietOnly.prepare(1, 65536, sampleRate);
+    quietOnly.update(quietChannels, 1, loudSamples, quietSamples);
+
+    // Past the filters' decay from the loud part; whole periods of the tone.
+    const auto firstRecord = (static_cast<int64_t>(loudSamples) + 4800) / wvfrm::BandEnergyRing::samplesPerRecord;
+    const auto endRecord = firstRecord + 4800 / wvfrm::BandEnergyRing::samplesPerRecord;
+
+    wvfrm::BandEnergies afterLoud;
+    wvfrm::BandEnergies reference;
+    if (! loudFirst.read(Lane::channel, 0, firstRecord, endRecord, afterLoud) || ! quietOnly.read(Lane::channel, 0, firstRecord, endRecord, reference))
+    {
+        std::cerr << "BandEnergyRing: the quiet span should be held." << std::endl;
+        return false;
+    }
+
+    if (std::abs(afterLoud.mid - reference.mid) > 0.01f * reference.mid)
+    {
+        std::cerr << "BandEnergyRing: a quiet passage after loud audio reads " << afterLoud.mid << " instead of "
+                  << reference.mid << "." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+} // namespace
+
+bool runBandEnergyRingTests()
+{
+    bool ok = true;
+    ok = runChunkingIndependenceTest() && ok;
+    ok = runBandSelectivityTest() && ok;
+    ok = runSteadyStateTest() && ok;
+    ok = runCoverageTest() && ok;
+    ok = runHostRebuildTest() && ok;
+    ok = runSpanAdditivityTest() && ok;
+    ok = runQuietAfterLoudTest() && ok;
+    return ok;
+}
@@ -0,0 +1,260 @@
+#include "dsp/BlockSummary.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+bool nearlyEqual(float a, float b, float tolerance = 1.0e-5f)
+{
+    return std::abs(a - b) <= tolerance;
+}
+
+bool runQueueOrderingTest()
+{
+    wvfrm::SpscQueue<int> queue(1000);
+
+    if (queue.getCapacity() != 1024)
+    {
+        std::cerr << "SpscQueue: capacity should round up to a power of two." << std::endl;
+        return false;
+    }
+
+    constexpr auto itemCount = 200000;
+    auto ok = true;
+
+    std::thread producer([&queue]
+    {
+        for (int i = 0; i < itemCount;)
+        {
+            if (queue.push(i))
+                ++i;
+            else
+                std::this_thread::yield();
+        }
+    });
+
+    auto expected = 0;
+    while (expected < itemCount)
+    {
+        auto item = -1;
+        if (! queue.pop(item))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        if (item != expected)
+        {
+            std::cerr << "SpscQueue: expected item " << expected << " but popped " << item << "." << std::endl;
+            ok = false;
+            break;
+        }
+
+        ++expected;
+    }
+
+    producer.join();
+    return ok;
+}
+} // namespace
+
+bool runBlockSummaryTests()
+{
+    bool ok = runQueueOrderingTest();
+
+    constexpr auto perSummary = 64;
+    constexpr auto totalSamples = 6000;
+
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> blockSize(1, 300);
+
+    std::vector<float> history[2];
+    for (auto& channel : history)
+    {
+        channel.resize(totalSamples);
+        for (auto& sample : channel)
+            sample = value(rng);
+    }
+
+    wvfrm::BlockSummaryQueue queue(4096);
+    wvfrm::BlockSummarizer summarizer;
+    summarizer.prepare(perSummary);
+
+    wvfrm::BlockSummaryHistory summaries;
+    summaries.prepare(1024, perSummary);
+
+    constexpr auto phasePerSample = 1.0 / 1000.0;
+    int64_t written = 0;
+
+    while (written < totalSamples)
+    {
+        const auto length = static_cast<int>(juce::jmin<int64_t>(blockSize(rng), totalSamples - written));
+        juce::AudioBuffer<float> block(2, length);
+        for (int channel = 0; channel < 2; ++channel)
+            for (int s = 0; s < length; ++s)
+                block.setSample(channel, s, history[channel][static_cast<size_t>(written + s)]);
+
+        summarizer.process(block, written, static_cast<double>(written) * phasePerSample, phasePerSample, queue);
+        written += length;
+    }
+
+    const auto expectedRecords = totalSamples / perSummary;
+    auto index = 0;
+    wvfrm::BlockSummary summary;
+
+    while (queue.pop(summary))
+    {
+        const auto start = static_cast<size_t>(index * perSummary);
+
+        if (summary.startSample != static_cast<int64_t>(start) || summary.numSamples != perSummary)
+        {
+            std::cerr << "BlockSummary: record " << index << " does not cover the expected samples." << std::endl;
+            ok = false;
+            break;
+        }
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            auto minimum = history[channel][start];
+            auto maximum = minimum;
+            auto sumSquares = 0.0;
+            for (size_t s = start; s < start + perSummary; ++s)
+            {
+                minimum = juce::jmin(minimum, history[channel][s]);
+                maximum = juce::jmax(maximum, history[channel][s]);
+                sumSquares += static_cast<double>(history[channel][s]) * history[channel][s];
+            }
+
+            const auto rms = static_cast<float>(std::sqrt(sumSquares / perSummary));
+            if (summary.minimum[channel] != minimum || summary.maximum[channel] != maximum
+                || ! nearlyEqual(summary.rms[channel], rms))
+            {
+                std::cerr << "BlockSummary: channel statistics mismatch in record " << index << "." << std::endl;
+                ok = false;
+            }
+        }
+
+        const auto expectedPhase = static_cast<float>(std::fmod(static_cast<double>(start) * phasePerSample, 1.0));
+        if (! nearlyEqual(summary.phase, expectedPhase, 1.0e-4f))
+        {
+            std::cerr << "BlockSummary: phase at record " << index << " was not interpolated from the block phase." << std::endl;
+            ok = false;
+        }
+
+        summaries.append(summary);
+        ++index;
+    }
+
+    if (index != expectedRecords)
+    {
+        std::cerr << "BlockSummary: expected " << expectedRecords << " records, got " << index << "." << std::endl;
+        ok = false;
+    }
+
+    {
+        float minimum = 0.0f;
+        float maximum = 0.0f;
+        constexpr int64_t start = 5 * perSummary;
+        constexpr int64_t end = 12 * perSummary;
+
+        if (! summaries.getRange(wvfrm::BlockSummaryHistory::Lane::side, 0, start, end, minimum, maximum))
+        {
+            std::cerr << "BlockSummaryHistory: aligned side range should be answered." << std::endl;
+            ok = false;
+        }
+        else
+        {
+            auto expectedMin = 1.0f;
+            auto expectedMax = -1.0f;
+            for (auto s = start; s < end; ++s)
+            {
+                const auto side = 0.5f * (history[0][static_cast<size_t>(s)] - history[1][static_cast<size_t>(s)]);
+                expectedMin = juce::jmin(expectedMin, side);
+                expectedMax = juce::jmax(expectedMax, side);
+            }
+
+            if (minimum != expectedMin || maximum != expectedMax)
+            {
+                std::cerr << "BlockSummaryHistory: side range mismatch." << std::endl;
+                ok = false;
+            }
+        }
+
+        if (summaries.getRange(wvfrm::BlockSummaryHistory::Lane::channel, 0, start, totalSamples + perSummary, minimum, maximum))
+        {
+            std::cerr << "BlockSummaryHistory: range past the newest record should be rejected." << std::endl;
+            ok = false;
+        }
+    }
+
+    {
+        // A restart at an unrelated position must not be stitched onto the old history.
+        juce::AudioBuffer<float> block(2, perSummary * 2);
+        block.clear();
+        summarizer.process(block, 100000, 0.0, phasePerSample, queue);
+        summaries.drain(queue);
+
+        float minimum = 0.0f;
+        float maximum = 0.0f;
+        if (summaries.getRange(wvfrm::BlockSummaryHistory::Lane::channel, 0, 0, perSummary, minimum, maximum))
+        {
+            std::cerr << "BlockSummaryHistory: history should reset after a sample position gap." << std::endl;
+            ok = false;
+        }
+
+        if (! summaries.getRange(wvfrm::BlockSummaryHistory::Lane::mid, 0, 100032, 100096, minimum, maximum)
+            || minimum != 0.0f || maximum != 0.0f)
+        {
+            std::cerr << "BlockSummaryHistory: records after a restart should be queryable." << std::endl;
+            ok = false;
+        }
+    }
+
+    {
+        // Mono folds to mid with silent side; wide buses keep every channel separate.
+        for (const auto channels : { 1, 12 })
+        {
+            wvfrm::BlockSummaryQueue wideQueue(16);
+            wvfrm::BlockSummarizer wide;
+            wide.prepare(perSummary);
+
+            juce::AudioBuffer<float> block(channels, perSummary);
+            for (int channel = 0; channel < channels; ++channel)
+                for (int s = 0; s < perSummary; ++s)
+                    block.setSample(channel, s, static_cast<float>(channel + 1) * 0.01f * static_cast<float>(s % 7));
+
+            wide.process(block, 0, 0.0, 0.0, wideQueue);
+
+            wvfrm::BlockSummary record;
+            if (! wideQueue.pop(record) || record.numChannels != channels)
+            {
+                std::cerr << "BlockSummary: " << channels << "-channel block did not produce a record." << std::endl;
+                ok = false;
+                continue;
+            }
+
+            for (int channel = 0; channel < channels; ++channel)
+            {
+                if (! nearlyEqual(record.maximum[channel], static_cast<float>(channel + 1) * 0.06f))
+                {
+                    std::cerr << "BlockSummary: channel " << channel << " of " << channels << " has the wrong peak." << std::endl;
+                    ok = false;
+                }
+            }
+
+            if (channels == 1 && (record.sideMinimum != 0.0f || record.sideMaximum != 0.0f
+                                  || record.midMaximum != record.maximum[0]))
+            {
+                std::cerr << "BlockSummary: mono input should fold to mid with a silent side." << std::endl;
+                ok = false;
+            }
+        }
+    }
+
+    return ok;
+}
@@ -0,0 +1,122 @@
+#include "ui/ColourLut.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+namespace
+{
+int channelError(juce::uint32 a, juce::uint32 b, int shift)
+{
+    return std::abs(static_cast<int>((a >> shift) & 0xffu) - static_cast<int>((b >> shift) & 0xffu));
+}
+
+// Against colourFor() over random energies and amplitudes, for every theme and both modes at
+// a spread of intensities and colour matches.
+bool runErrorBoundTest()
+{
+    wvfrm::ThemeEngine engine;
+    wvfrm::ColourLut lut;
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    auto worst = 0;
+    double total = 0.0;
+    auto samples = 0;
+
+    for (const auto theme : { wvfrm::ThemePreset::minimeters3Band,
+                              wvfrm::ThemePreset::rekordboxInspired,
+                              wvfrm::ThemePreset::classicAmber,
+                              wvfrm::ThemePreset::iceBlue })
+    {
+        for (const auto mode : { wvfrm::ColorMode::threeBand, wvfrm::ColorMode::flatTheme })
+        {
+            for (const auto intensity : { 0.0f, 35.0f, 100.0f })
+            {
+                for (const auto colorMatch : { 0.0f, 60.0f, 100.0f })
+                {
+                    lut.prepare(engine, { theme, mode, intensity, colorMatch });
+
+                    for (int i = 0; i < 2000; ++i)
+                    {
+                        const wvfrm::BandEnergies energies { unit(random), unit(random), unit(random) };
+                        const auto amplitude = unit(random);
+                        const auto expected = engine.colourFor(energies, theme, mode, intensity, amplitude, colorMatch).getARGB();
+                        const auto actual = lut.lookup(energies, amplitude);
+
+                        for (const auto shift : { 0, 8, 16, 24 })
+                        {
+                            const auto error = channelError(expected, actual, shift);
+                            worst = juce::jmax(worst, error);
+                            total += error;
+                            ++samples;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    const auto mean = total / samples;
+    if (worst > 8 || mean > 0.25)
+    {
+        std::cerr << "ColourLut: colours stray from colourFor() by up to " << worst << "/255 (mean " << mean << ")." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool runShapeCurveTest()
+{
+    wvfrm::ThemeEngine engine;
+    wvfrm::ColourLut lut;
+
+    for (const auto intensity : { 0.0f, 50.0f, 100.0f })
+    {
+        lut.prepare(engine, { wvfrm::ThemePreset::minimeters3Band, wvfrm::ColorMode::threeBand, intensity, 100.0f });
+
+        for (int i = 0; i <= 4000; ++i)
+        {
+            const auto normalized = static_cast<float>(i) / 4000.0f * 1.2f - 0.1f;
+            const auto error = std::abs(lut.shapeBand(normalized) - wvfrm::ThemeEngine::shapeBandIntensity(normalized, intensity));
+
+            if (error > 2.0e-3f)
+            {
+                std::cerr << "ColourLut: band shaping is off by " << error << " at " << normalized << "." << std::endl;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool runRebuildTest()
+{
+    wvfrm::ThemeEngine engine;
+    wvfrm::ColourLut lut;
+    const wvfrm::ColourLut::Settings settings { wvfrm::ThemePreset::iceBlue, wvfrm::ColorMode::threeBand, 80.0f, 40.0f };
+
+    auto changed = settings;
+    changed.colorMatchPercent = 41.0f;
+
+    if (! lut.prepare(engine, settings) || lut.prepare(engine, settings) || ! lut.prepare(engine, changed))
+    {
+        std::cerr << "ColourLut: tables should be rebuilt exactly when the settings change." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+} // namespace
+
+bool runColourLutTests()
+{
+    bool ok = true;
+    ok = runErrorBoundTest() && ok;
+    ok = runShapeCurveTest() && ok;
+    ok = runRebuildTest() && ok;
+    return ok;
+}
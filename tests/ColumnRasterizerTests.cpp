@@ -0,0 +1,173 @@
+#include "ui/ColumnRasterizer.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+using Column = wvfrm::ColumnRasterizer::Column;
+
+constexpr juce::uint32 background = 0xff040406u;
+
+juce::uint32 pixelAt(juce::Image& image, int x, int y)
+{
+    juce::Image::BitmapData bitmap(image, juce::Image::BitmapData::readOnly);
+    return *reinterpret_cast<const juce::uint32*>(bitmap.getPixelPointer(x, y));
+}
+
+int channel(juce::uint32 argb, int shift)
+{
+    return static_cast<int>((argb >> shift) & 0xffu);
+}
+
+// Reference source-over of a non-premultiplied colour at coverage onto an opaque pixel.
+bool matchesBlend(juce::uint32 actual, juce::uint32 under, juce::uint32 colour, float coverage, int tolerance)
+{
+    const auto alpha = static_cast<float>(colour >> 24) / 255.0f * coverage;
+
+    for (const auto shift : { 0, 8, 16 })
+    {
+        const auto expected = static_cast<float>(channel(colour, shift)) * alpha + static_cast<float>(channel(under, shift)) * (1.0f - alpha);
+        if (std::abs(static_cast<float>(channel(actual, shift)) - expected) > static_cast<float>(tolerance))
+            return false;
+    }
+
+    return channel(actual, 24) == 255;
+}
+
+wvfrm::ColumnRasterizer::Strip fullStrip(const juce::Image& image)
+{
+    wvfrm::ColumnRasterizer::Strip strip;
+    strip.pixelEnd = image.getWidth();
+    strip.centreY = image.getHeight() / 2;
+    strip.background = juce::Colour(background);
+    strip.centreLine = juce::Colour(background);
+    return strip;
+}
+
+bool runCoverageTest()
+{
+    wvfrm::ColumnRasterizer rasterizer;
+    juce::Image image(juce::Image::ARGB, 16, 16, true);
+
+    // A one-pixel core on column 3 fills pixel 3 exactly; a two-pixel one on column 8 spans
+    // [7.5, 9.5), so pixel 8 is covered and pixels 7 and 9 are half covered.
+    Column columns[16];
+    columns[3] = { 0xffff0000u, 2.0f, 10.0f };
+    columns[8] = { 0xff00ff00u, 2.0f, 10.5f };
+
+    wvfrm::ColumnRasterizer::Style style;
+    style.coreThickness = 1.0f;
+    rasterizer.paintStrip(image, 1.0f, fullStrip(image), columns, 0, 8, style);
+
+    // The second strip leaves the first one's pixels alone.
+    auto rightHalf = fullStrip(image);
+    rightHalf.pixelStart = 6;
+    style.coreThickness = 2.0f;
+    rasterizer.paintStrip(image, 1.0f, rightHalf, columns, 8, 16, style);
+
+    if (pixelAt(image, 3, 5) != 0xffff0000u || pixelAt(image, 2, 5) != background || pixelAt(image, 4, 5) != background
+        || pixelAt(image, 3, 1) != background || pixelAt(image, 3, 10) != background)
+    {
+        std::cerr << "ColumnRasterizer: an opaque whole-pixel line should fill exactly its pixels." << std::endl;
+        return false;
+    }
+
+    if (pixelAt(image, 8, 5) != 0xff00ff00u || ! matchesBlend(pixelAt(image, 7, 5), background, 0xff00ff00u, 0.5f, 1)
+        || ! matchesBlend(pixelAt(image, 9, 5), background, 0xff00ff00u, 0.5f, 1)
+        || ! matchesBlend(pixelAt(image, 8, 10), background, 0xff00ff00u, 0.5f, 1))
+    {
+        std::cerr << "ColumnRasterizer: edge pixels should blend by the area the line covers." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool runTranslucentBlendTest()
+{
+    // A wide translucent glow under an opaque core, at a fractional scale: glow pixels take
+    // the SIMD path in groups of four and the scalar path for the rest, and both must agree
+    // with the reference blend.
+    wvfrm::ColumnRasterizer rasterizer;
+    juce::Image image(juce::Image::ARGB, 64, 32, true);
+
+    Column columns[32];
+    columns[10] = { 0x80c08040u, 4.0f, 20.0f };
+
+    wvfrm::ColumnRasterizer::Style style;
+    style.coreThickness = 1.0f;
+    style.glowThickness = 5.0f;
+    style.glowAlpha = 0.5f;
+
+    rasterizer.paintStrip(image, 1.5f, fullStrip(image), columns, 0, 32, style);
+
+    // Column 10 is centred on 15.75 image pixels; the glow spans [12, 19.5), the core [15, 16.5).
+    const auto glow = 0x40c08040u;
+
+    for (int x = 12; x < 15; ++x)
+    {
+        if (! matchesBlend(pixelAt(image, x, 12), background, glow, 1.0f, 2))
+        {
+            std::cerr << "ColumnRasterizer: glow pixel " << x << " does not match the reference blend." << std::endl;
+            return false;
+        }
+    }
+
+    if (! matchesBlend(pixelAt(image, 19, 12), background, glow, 0.5f, 2))
+    {
+        std::cerr << "ColumnRasterizer: the glow's half-covered edge does not match the reference blend." << std::endl;
+        return false;
+    }
+
+    const auto underCore = pixelAt(image, 13, 12);
+    if (! matchesBlend(pixelAt(image, 15, 12), underCore, 0x80c08040u, 1.0f, 2))
+    {
+        std::cerr << "ColumnRasterizer: the core should blend over the glow." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool runStripClipTest()
+{
+    wvfrm::ColumnRasterizer rasterizer;
+    juce::Image image(juce::Image::ARGB, 32, 8, true);
+
+    Column columns[32];
+    for (auto& column : columns)
+        column = { 0xffffffffu, 0.0f, 8.0f };
+
+    wvfrm::ColumnRasterizer::Style style;
+    style.coreThickness = 3.0f;
+
+    auto strip = fullStrip(image);
+    strip.pixelStart = 8;
+    strip.pixelEnd = 12;
+    rasterizer.paintStrip(image, 1.0f, strip, columns, 0, 32, style);
+
+    // Everything outside the strip keeps the cleared image, even where wide lines reach.
+    for (int x = 0; x < 32; ++x)
+    {
+        const auto inside = x >= 8 && x < 12;
+        const auto pixel = pixelAt(image, x, 4);
+        if (inside != (pixel == 0xffffffffu) || (! inside && pixel != 0u))
+        {
+            std::cerr << "ColumnRasterizer: pixel " << x << " was painted against the strip." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+} // namespace
+
+bool runColumnRasterizerTests()
+{
+    bool ok = true;
+    ok = runCoverageTest() && ok;
+    ok = runTranslucentBlendTest() && ok;
+    ok = runStripClipTest() && ok;
+    return ok;
+}
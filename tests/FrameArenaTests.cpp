@@ -0,0 +1,193 @@
+#include "ui/ColourLut.h"
+#include "ui/ColumnRasterizer.h"
+#include "ui/FrameArena.h"
+#include "ui/FrameMailbox.h"
+#include "ui/WorkStealingPool.h"
+#include "dsp/BandAnalyzer3.h"
+
+#include "AllocationHook.h"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+bool runArenaTest()
+{
+    wvfrm::FrameArena arena;
+    arena.reserve(1024);
+
+    {
+        AllocationProbe probe;
+        arena.reset();
+        auto* bytes = arena.allocate<uint8_t>(3);
+        auto* doubles = arena.allocate<double>(16);
+        auto* aligned = arena.allocate<std::array<float, 16>>(2);
+
+        if (probe.count() != 0)
+        {
+            std::cerr << "FrameArena: allocations within the reserved block should not touch the heap." << std::endl;
+            return false;
+        }
+
+        if (bytes[0] != 0 || doubles[15] != 0.0 || reinterpret_cast<uintptr_t>(doubles) % alignof(double) != 0
+            || reinterpret_cast<uintptr_t>(aligned) % alignof(std::array<float, 16>) != 0)
+        {
+            std::cerr << "FrameArena: allocations should be value-initialised and aligned." << std::endl;
+            return false;
+        }
+    }
+
+    // A frame that outgrows the block pays once; the next one fits.
+    arena.reset();
+    auto* first = arena.allocate<float>(200);
+    auto* second = arena.allocate<float>(400);
+    first[199] = 1.0f;
+    second[399] = 2.0f;
+
+    if (first[199] != 1.0f || arena.getBytesUsed() < 600 * sizeof(float))
+    {
+        std::cerr << "FrameArena: overflow allocations should be usable alongside the block." << std::endl;
+        return false;
+    }
+
+    arena.reset();
+
+    {
+        AllocationProbe probe;
+        arena.allocate<float>(200);
+        arena.allocate<float>(400);
+
+        if (probe.count() != 0 || arena.getCapacity() < 600 * sizeof(float))
+        {
+            std::cerr << "FrameArena: reset should fold the overflow into the block." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+struct SteadyFrame
+{
+    juce::Image image;
+    std::vector<int> columnsPerTile;
+};
+
+// One frame's worth of the render path's steady state: arena scratch, the tile pool, colour
+// analysis, colour lookups, rasterizing and the mailbox handoff. Once warmed up, none of it may
+// allocate.
+bool runSteadyStateTest()
+{
+    constexpr auto width = 512;
+    constexpr auto height = 64;
+    constexpr auto windowSamples = 256;
+    constexpr auto tileColumns = 128;
+    constexpr auto numTiles = width / tileColumns;
+
+    wvfrm::WorkStealingPool pool(2);
+    wvfrm::FrameArena arena;
+    wvfrm::ThemeEngine theme;
+    wvfrm::ColourLut colours;
+    colours.prepare(theme, { wvfrm::ThemePreset::minimeters3Band, wvfrm::ColorMode::threeBand, 100.0f, 100.0f });
+    wvfrm::ColumnRasterizer rasterizer;
+    wvfrm::FrameMailbox<SteadyFrame> frames;
+    std::vector<wvfrm::BandAnalyzer3> analyzers(static_cast<size_t>(pool.getNumLanes()));
+    std::vector<float*> laneScratch(static_cast<size_t>(pool.getNumLanes()));
+
+    std::vector<float> samples(width * 4 + windowSamples);
+    for (size_t i = 0; i < samples.size(); ++i)
+        samples[i] = std::sin(static_cast<float>(i) * 0.05f) * 0.8f;
+
+    arena.reserve(sizeof(wvfrm::ColumnRasterizer::Column) * width + sizeof(float) * windowSamples * 8 * laneScratch.size() + 256);
+
+    wvfrm::ColumnRasterizer::Style style;
+    style.coreThickness = 1.35f;
+    style.glowThickness = 3.0f;
+    style.glowAlpha = 0.3f;
+
+    auto renderOnce = [&](int frameIndex)
+    {
+        arena.reset();
+        auto* columns = arena.allocate<wvfrm::ColumnRasterizer::Column>(width);
+        for (auto& scratch : laneScratch)
+            scratch = arena.allocate<float>(static_cast<size_t>(windowSamples * wvfrm::BandAnalyzer3::batchSize));
+
+        auto& frame = frames.back();
+        if (! frame.image.isValid())
+        {
+            frame.image = juce::Image(juce::Image::ARGB, width, height, true);
+            frame.columnsPerTile.resize(numTiles);
+        }
+
+        auto tile = [&](int tileIndex, int lane)
+        {
+            auto& analyzer = analyzers[static_cast<size_t>(lane)];
+            auto* scratch = laneScratch[static_cast<size_t>(lane)];
+            std::array<const float*, wvfrm::BandAnalyzer3::batchSize> segments {};
+            std::array<int, wvfrm::BandAnalyzer3::batchSize> lengths {};
+            std::array<wvfrm::BandEnergies, wvfrm::BandAnalyzer3::batchSize> energies {};
+
+            for (int x = tileIndex * tileColumns; x < (tileIndex + 1) * tileColumns; x += wvfrm::BandAnalyzer3::batchSize)
+            {
+                for (int i = 0; i < wvfrm::BandAnalyzer3::batchSize; ++i)
+                {
+                    auto* segment = scratch + i * windowSamples;
+                    std::copy_n(samples.data() + x + i + frameIndex, windowSamples, segment);
+                    segments[static_cast<size_t>(i)] = segment;
+                    lengths[static_cast<size_t>(i)] = windowSamples;
+                }
+
+                analyzer.analyzeSegments(segments.data(), lengths.data(), wvfrm::BandAnalyzer3::batchSize, 48000.0, 0.35f, energies.data());
+
+                for (int i = 0; i < wvfrm::BandAnalyzer3::batchSize; ++i)
+                {
+                    const auto amplitude = std::abs(samples[static_cast<size_t>(x + i)]);
+                    columns[x + i] = { colours.lookup(energies[static_cast<size_t>(i)], amplitude),
+                                       32.0f - amplitude * 28.0f,
+                                       32.0f + amplitude * 28.0f };
+                }
+            }
+
+            wvfrm::ColumnRasterizer::Strip strip;
+            strip.pixelStart = tileIndex * tileColumns;
+            strip.pixelEnd = (tileIndex + 1) * tileColumns;
+            strip.centreY = height / 2;
+            strip.background = juce::Colour::fromRGB(4, 4, 6);
+            rasterizer.paintStrip(frame.image, 1.0f, strip, columns, juce::jmax(0, strip.pixelStart - 4), juce::jmin(width, strip.pixelEnd + 4), style);
+            frame.columnsPerTile[static_cast<size_t>(tileIndex)] = tileColumns;
+        };
+
+        pool.run(numTiles, tile);
+        frames.publish();
+        frames.fetch();
+    };
+
+    // Warm-up: the first frames size every buffer and fill each mailbox slot.
+    for (int frameIndex = 0; frameIndex < 4; ++frameIndex)
+        renderOnce(frameIndex);
+
+    AllocationProbe probe;
+    for (int frameIndex = 4; frameIndex < 20; ++frameIndex)
+        renderOnce(frameIndex);
+
+    if (const auto allocations = probe.count(); allocations != 0)
+    {
+        std::cerr << "Render path: " << allocations << " heap allocations in 16 steady-state frames." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+} // namespace
+
+bool runFrameArenaTests()
+{
+    bool ok = true;
+    ok = runArenaTest() && ok;
+    ok = runSteadyStateTest() && ok;
+    return ok;
+}
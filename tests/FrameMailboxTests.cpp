@@ -0,0 +1,139 @@
+#include "ui/FrameMailbox.h"
+
+#include <array>
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+struct TestFrame
+{
+    uint64_t serial = 0;
+    std::array<uint64_t, 256> payload {};
+};
+
+using Mailbox = wvfrm::FrameMailbox<TestFrame>;
+
+void fill(TestFrame& frame, uint64_t serial)
+{
+    frame.serial = serial;
+    frame.payload.fill(serial * 2654435761u);
+}
+
+bool isWhole(const TestFrame& frame)
+{
+    for (const auto value : frame.payload)
+    {
+        if (value != frame.serial * 2654435761u)
+            return false;
+    }
+
+    return true;
+}
+
+bool runHandoffTest()
+{
+    Mailbox mailbox;
+
+    if (mailbox.fetch())
+    {
+        std::cerr << "FrameMailbox: nothing has been published yet." << std::endl;
+        return false;
+    }
+
+    fill(mailbox.back(), 1);
+    mailbox.publish();
+
+    if (! mailbox.fetch() || mailbox.front().serial != 1 || mailbox.fetch() || mailbox.front().serial != 1)
+    {
+        std::cerr << "FrameMailbox: a published frame should be fetched exactly once and then stay in front." << std::endl;
+        return false;
+    }
+
+    // Three frames published while the consumer looks away: only the newest reaches it.
+    for (uint64_t serial = 2; serial <= 4; ++serial)
+    {
+        fill(mailbox.back(), serial);
+        mailbox.publish();
+    }
+
+    if (! mailbox.fetch() || mailbox.front().serial != 4 || mailbox.getDroppedFrames() != 2)
+    {
+        std::cerr << "FrameMailbox: stale frames should be dropped in favour of the newest." << std::endl;
+        return false;
+    }
+
+    // The producer never gets handed the frame the consumer is holding.
+    for (uint64_t serial = 5; serial <= 8; ++serial)
+    {
+        if (&mailbox.back() == &mailbox.front())
+        {
+            std::cerr << "FrameMailbox: the producer was given the consumer's frame." << std::endl;
+            return false;
+        }
+
+        fill(mailbox.back(), serial);
+        mailbox.publish();
+    }
+
+    return mailbox.front().serial == 4;
+}
+
+bool runConcurrentTest()
+{
+    Mailbox mailbox;
+    std::atomic<bool> done { false };
+    constexpr uint64_t frameCount = 20000;
+
+    std::thread producer([&]
+    {
+        for (uint64_t serial = 1; serial <= frameCount; ++serial)
+        {
+            fill(mailbox.back(), serial);
+            mailbox.publish();
+        }
+
+        done.store(true);
+    });
+
+    uint64_t lastSerial = 0;
+    uint64_t fetched = 0;
+    auto ok = true;
+
+    while (ok)
+    {
+        const auto finished = done.load();
+
+        if (mailbox.fetch())
+        {
+            const auto& frame = mailbox.front();
+            ok = frame.serial > lastSerial && isWhole(frame);
+            lastSerial = frame.serial;
+            ++fetched;
+        }
+        else if (finished)
+        {
+            break;
+        }
+    }
+
+    producer.join();
+
+    if (! ok || lastSerial != frameCount || fetched + mailbox.getDroppedFrames() != frameCount)
+    {
+        std::cerr << "FrameMailbox: frames must arrive whole, in order, and each be either fetched or dropped." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+} // namespace
+
+bool runFrameMailboxTests()
+{
+    bool ok = true;
+    ok = runHandoffTest() && ok;
+    ok = runConcurrentTest() && ok;
+    return ok;
+}
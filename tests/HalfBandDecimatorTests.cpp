@@ -0,0 +1,339 @@
+#include "dsp/AnalysisRingBuffer.h"
+#include "dsp/BlockSummary.h"
+#include "dsp/HalfBandDecimator.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+// Runs a mono signal through the decimator in blocks of blockSize; returns the filtered output
+// and, optionally, the envelope maximum.
+std::vector<float> decimate(wvfrm::HalfBandDecimator& decimator,
+                            const std::vector<float>& input,
+                            int blockSize,
+                            std::vector<float>* envelopeMaximum = nullptr)
+{
+    std::vector<float> output;
+
+    for (size_t offset = 0; offset < input.size(); offset += static_cast<size_t>(blockSize))
+    {
+        const auto count = static_cast<int>(std::min(input.size() - offset, static_cast<size_t>(blockSize)));
+        const float* channels[] { input.data() + offset };
+        const auto produced = decimator.process(channels, 1, count);
+
+        output.insert(output.end(), decimator.getOutput()[0], decimator.getOutput()[0] + produced);
+        if (envelopeMaximum != nullptr)
+            envelopeMaximum->insert(envelopeMaximum->end(),
+                                    decimator.getEnvelopeMaximum()[0],
+                                    decimator.getEnvelopeMaximum()[0] + produced);
+    }
+
+    return output;
+}
+
+std::vector<float> tone(double frequency, double sampleRate, int numSamples)
+{
+    std::vector<float> samples(static_cast<size_t>(numSamples));
+    for (int i = 0; i < numSamples; ++i)
+        samples[static_cast<size_t>(i)] = static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * frequency * i / sampleRate));
+
+    return samples;
+}
+
+float peakAfter(const std::vector<float>& samples, size_t settle)
+{
+    auto peak = 0.0f;
+    for (auto i = settle; i < samples.size(); ++i)
+        peak = juce::jmax(peak, std::abs(samples[i]));
+
+    return peak;
+}
+
+bool runStageSelectionTest()
+{
+    using Decimator = wvfrm::HalfBandDecimator;
+
+    if (Decimator::stagesForRate(44100.0) != 1 || Decimator::stagesForRate(48000.0) != 1
+        || Decimator::stagesForRate(96000.0) != 2 || Decimator::stagesForRate(192000.0) != 3
+        || Decimator::stagesForRate(24000.0) != 0)
+    {
+        std::cerr << "HalfBandDecimator: stage selection should land every common rate at 22.05-24 kHz." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool runResponseTest()
+{
+    constexpr auto sampleRate = 192000.0;
+    wvfrm::HalfBandDecimator decimator;
+    decimator.prepare(1, 512);
+    decimator.setNumStages(wvfrm::HalfBandDecimator::stagesForRate(sampleRate));
+
+    if (decimator.getFactor() != 8)
+    {
+        std::cerr << "HalfBandDecimator: 192 kHz should decimate by 8." << std::endl;
+        return false;
+    }
+
+    // In band: a 1 kHz tone keeps its level at 24 kHz.
+    const auto passed = peakAfter(decimate(decimator, tone(1000.0, sampleRate, 96000), 512), 500);
+    if (std::abs(passed - 1.0f) > 0.01f)
+    {
+        std::cerr << "HalfBandDecimator: 1 kHz tone came out at " << passed << " instead of 1." << std::endl;
+        return false;
+    }
+
+    // Out of band: 40 kHz would alias to 8 kHz; it must be gone, not folded into the picture.
+    decimator.reset();
+    const auto rejected = peakAfter(decimate(decimator, tone(40000.0, sampleRate, 96000), 512), 500);
+    if (rejected > 0.01f)
+    {
+        std::cerr << "HalfBandDecimator: 40 kHz tone leaked through at " << rejected << "." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool runBlockSizeIndependenceTest()
+{
+    const auto input = tone(3100.0, 96000.0, 20000);
+
+    wvfrm::HalfBandDecimator whole;
+    whole.prepare(1, 4096);
+    whole.setNumStages(2);
+    const auto reference = decimate(whole, input, 4096);
+
+    wvfrm::HalfBandDecimator ragged;
+    ragged.prepare(1, 4096);
+    ragged.setNumStages(2);
+    const auto chunked = decimate(ragged, input, 37);
+
+    if (reference.size() != input.size() / 4 || chunked.size() != reference.size())
+    {
+        std::cerr << "HalfBandDecimator: expected one output per four inputs regardless of block size." << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < reference.size(); ++i)
+    {
+        if (std::abs(reference[i] - chunked[i]) > 1.0e-6f)
+        {
+            std::cerr << "HalfBandDecimator: output depends on block size at " << i << "." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool runPeakPreservationTest()
+{
+    constexpr auto factor = 8;
+    constexpr auto numSamples = 64000;
+    const int clicks[] { 1001, 20003, 33338, 50007 };
+
+    std::vector<float> input(static_cast<size_t>(numSamples), 0.0f);
+    for (const auto click : clicks)
+        input[static_cast<size_t>(click)] = 0.9f;
+
+    wvfrm::HalfBandDecimator decimator;
+    decimator.prepare(1, 480);
+    decimator.setNumStages(3);
+
+    wvfrm::AnalysisRingBuffer ring;
+    ring.prepare(1, numSamples / factor);
+    wvfrm::BlockSummarizer summarizer;
+    summarizer.prepare(wvfrm::BlockSummarizer::defaultSamplesPerSummary);
+    wvfrm::BlockSummaryQueue queue(1024);
+    auto filteredPeak = 0.0f;
+
+    for (int offset = 0; offset < numSamples; offset += 480)
+    {
+        const float* channels[] { input.data() + offset };
+        const auto produced = decimator.process(channels, 1, juce::jmin(480, numSamples - offset));
+        const auto start = ring.getTotalWrittenSamples();
+
+        ring.pushSamples(decimator.getOutput(), decimator.getEnvelopeMinimum(), decimator.getEnvelopeMaximum(), 1, produced);
+        summarizer.process(decimator.getOutput(), 1, produced, start, 0.0, 0.0, queue,
+                           decimator.getEnvelopeMinimum(), decimator.getEnvelopeMaximum());
+
+        for (int i = 0; i < produced; ++i)
+            filteredPeak = juce::jmax(filteredPeak, decimator.getOutput()[0][i]);
+    }
+
+    // The smoothed stream alone would under-draw a one-sample click badly.
+    if (filteredPeak > 0.5f)
+    {
+        std::cerr << "HalfBandDecimator: expected the filtered stream to soften an isolated click." << std::endl;
+        return false;
+    }
+
+    const auto latency = decimator.getLatencySamples();
+    constexpr auto blockSize = 1 << wvfrm::PeakPyramid::baseLevelShift;
+
+    for (const auto click : clicks)
+    {
+        // Around where the filtered stream puts the click, whole pyramid blocks must report it.
+        const auto centre = static_cast<int64_t>((click + latency) / factor);
+        const auto start = (centre / blockSize - 1) * blockSize;
+        const auto end = (centre / blockSize + 2) * blockSize;
+        float minimum = 0.0f;
+        float maximum = 0.0f;
+
+        if (! ring.getPeakRange(0, start, end, minimum, maximum) || maximum < 0.9f)
+        {
+            std::cerr << "HalfBandDecimator: click at " << click << " lost from the ring peaks (" << maximum << ")." << std::endl;
+            return false;
+        }
+    }
+
+    auto summaryClicks = 0;
+    wvfrm::BlockSummary summary;
+    while (queue.pop(summary))
+        summaryClicks += summary.maximum[0] >= 0.9f ? 1 : 0;
+
+    if (summaryClicks != static_cast<int>(std::size(clicks)))
+    {
+        std::cerr << "HalfBandDecimator: summaries held " << summaryClicks << " of " << std::size(clicks) << " clicks." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool runDerivedPeakPreservationTest()
+{
+    // One-sample clicks on either side of a stereo pair: each moves mid (which mono draws from)
+    // and side by half its height, in the signs listed.
+    constexpr auto factor = 8;
+    constexpr auto numSamples = 64000;
+    constexpr auto height = 0.9f;
+    struct Click
+    {
+        int position;
+        int channel;
+        float value;
+    };
+    const Click clicks[] { { 1001, 0, height }, { 20003, 1, height }, { 33338, 0, -height }, { 50007, 1, -height } };
+
+    std::vector<float> left(static_cast<size_t>(numSamples), 0.0f);
+    std::vector<float> right(static_cast<size_t>(numSamples), 0.0f);
+    for (const auto& click : clicks)
+        (click.channel == 0 ? left : right)[static_cast<size_t>(click.position)] = click.value;
+
+    wvfrm::HalfBandDecimator decimator;
+    decimator.prepare(2, 480);
+    decimator.setNumStages(3);
+
+    wvfrm::BlockSummarizer summarizer;
+    summarizer.prepare(wvfrm::BlockSummarizer::defaultSamplesPerSummary);
+    wvfrm::BlockSummaryQueue queue(1024);
+    wvfrm::BlockSummaryHistory history;
+    history.prepare(numSamples / factor / wvfrm::BlockSummarizer::defaultSamplesPerSummary + 1,
+                    wvfrm::BlockSummarizer::defaultSamplesPerSummary);
+    auto filteredPeak = 0.0f;
+    int64_t written = 0;
+
+    for (int offset = 0; offset < numSamples; offset += 480)
+    {
+        const float* channels[] { left.data() + offset, right.data() + offset };
+        const auto produced = decimator.process(channels, 2, juce::jmin(480, numSamples - offset));
+
+        summarizer.process(decimator.getOutput(), 2, produced, written, 0.0, 0.0, queue,
+                           decimator.getEnvelopeMinimum(), decimator.getEnvelopeMaximum(),
+                           decimator.getDerivedEnvelopeMinimum(), decimator.getDerivedEnvelopeMaximum());
+        history.drain(queue);
+
+        for (int i = 0; i < produced; ++i)
+        {
+            const auto mid = 0.5f * (decimator.getOutput()[0][i] + decimator.getOutput()[1][i]);
+            filteredPeak = juce::jmax(filteredPeak, std::abs(mid));
+        }
+
+        written += produced;
+    }
+
+    // Mid and side of the smoothed stream alone would under-draw every click.
+    if (filteredPeak > 0.5f * 0.5f * height)
+    {
+        std::cerr << "HalfBandDecimator: expected the filtered mid to soften an isolated click." << std::endl;
+        return false;
+    }
+
+    const auto latency = decimator.getLatencySamples();
+    const auto recordSamples = history.getSamplesPerSummary();
+    auto ok = true;
+
+    for (const auto& click : clicks)
+    {
+        // The records around where the filtered stream puts the click must carry its full height.
+        const auto centre = static_cast<int64_t>((click.position + latency) / factor);
+        const auto start = (centre / recordSamples - 1) * recordSamples;
+        const auto end = (centre / recordSamples + 2) * recordSamples;
+        const auto half = 0.5f * click.value;
+        const auto sideHalf = click.channel == 0 ? half : -half;
+
+        for (const auto lane : { wvfrm::BlockSummaryHistory::Lane::mid, wvfrm::BlockSummaryHistory::Lane::side })
+        {
+            const auto expected = lane == wvfrm::BlockSummaryHistory::Lane::mid ? half : sideHalf;
+            float minimum = 0.0f;
+            float maximum = 0.0f;
+            const auto held = history.getRange(lane, 0, start, end, minimum, maximum)
+                && (expected > 0.0f ? maximum >= expected - 1.0e-6f : minimum <= expected + 1.0e-6f);
+
+            if (! held)
+            {
+                std::cerr << "HalfBandDecimator: click at " << click.position << " lost from the "
+                          << (lane == wvfrm::BlockSummaryHistory::Lane::mid ? "mid" : "side") << " summaries ("
+                          << minimum << ", " << maximum << ")." << std::endl;
+                ok = false;
+            }
+        }
+    }
+
+    return ok;
+}
+
+bool runEnvelopeContainsOutputTest()
+{
+    const auto input = tone(9000.0, 96000.0, 8192);
+    wvfrm::HalfBandDecimator decimator;
+    decimator.prepare(1, 1024);
+    decimator.setNumStages(2);
+
+    for (size_t offset = 0; offset < input.size(); offset += 1024)
+    {
+        const float* channels[] { input.data() + offset };
+        const auto produced = decimator.process(channels, 1, 1024);
+
+        for (int i = 0; i < produced; ++i)
+        {
+            const auto value = decimator.getOutput()[0][i];
+            if (value < decimator.getEnvelopeMinimum()[0][i] || value > decimator.getEnvelopeMaximum()[0][i])
+            {
+                std::cerr << "HalfBandDecimator: envelope does not contain the filtered sample." << std::endl;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+} // namespace
+
+bool runHalfBandDecimatorTests()
+{
+    bool ok = true;
+    ok = runStageSelectionTest() && ok;
+    ok = runResponseTest() && ok;
+    ok = runBlockSizeIndependenceTest() && ok;
+    ok = runPeakPreservationTest() && ok;
+    ok = runDerivedPeakPreservationTest() && ok;
+    ok = runEnvelopeContainsOutputTest() && ok;
+    return ok;
+}
@@ -0,0 +1,100 @@
+#include "dsp/AnalysisRingBuffer.h"
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+bool runPeakPyramidTests()
+{
+    bool ok = true;
+
+    constexpr auto capacity = 1000;
+
+    wvfrm::AnalysisRingBuffer ring;
+    ring.prepare(2, capacity);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> blockSize(1, 97);
+
+    std::vector<float> history[2];
+
+    while (history[0].size() < 5000)
+    {
+        juce::AudioBuffer<float> block(2, blockSize(rng));
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            for (int s = 0; s < block.getNumSamples(); ++s)
+            {
+                const auto v = value(rng);
+                block.setSample(channel, s, v);
+                history[channel].push_back(v);
+            }
+        }
+
+        ring.pushBuffer(block);
+
+        const auto written = ring.getTotalWrittenSamples();
+        const auto earliest = juce::jmax<int64_t>(0, written - capacity);
+        std::uniform_int_distribution<int64_t> position(earliest, written);
+
+        for (int query = 0; query < 8 && ok; ++query)
+        {
+            auto a = position(rng);
+            auto b = position(rng);
+            if (a > b)
+                std::swap(a, b);
+
+            if (a == b)
+                continue;
+
+            const auto channel = query & 1;
+            float minimum = 0.0f;
+            float maximum = 0.0f;
+
+            if (! ring.getPeakRange(channel, a, b, minimum, maximum))
+            {
+                std::cerr << "PeakPyramid: query inside retained history failed." << std::endl;
+                ok = false;
+                break;
+            }
+
+            auto expectedMin = std::numeric_limits<float>::max();
+            auto expectedMax = -std::numeric_limits<float>::max();
+            for (auto s = a; s < b; ++s)
+            {
+                expectedMin = juce::jmin(expectedMin, history[channel][static_cast<size_t>(s)]);
+                expectedMax = juce::jmax(expectedMax, history[channel][static_cast<size_t>(s)]);
+            }
+
+            if (minimum != expectedMin || maximum != expectedMax)
+            {
+                std::cerr << "PeakPyramid: min/max mismatch for range [" << a << ", " << b << ")." << std::endl;
+                ok = false;
+            }
+        }
+    }
+
+    {
+        float minimum = 0.0f;
+        float maximum = 0.0f;
+        const auto written = ring.getTotalWrittenSamples();
+
+        if (ring.getPeakRange(0, 0, written - capacity, minimum, maximum))
+        {
+            std::cerr << "PeakPyramid: range older than the retained history should be rejected." << std::endl;
+            ok = false;
+        }
+
+        if (! ring.getPeakRange(0, written - 2 * capacity, written, minimum, maximum))
+        {
+            std::cerr << "PeakPyramid: partially retained range should clamp to history." << std::endl;
+            ok = false;
+        }
+    }
+
+    return ok;
+}
@@ -0,0 +1,171 @@
+#include "dsp/AnalysisRingBuffer.h"
+#include "dsp/SampleCodec.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+const char* formatName(wvfrm::SampleFormat format)
+{
+    switch (format)
+    {
+        case wvfrm::SampleFormat::float16: return "float16";
+        case wvfrm::SampleFormat::int16: return "int16";
+        case wvfrm::SampleFormat::float32:
+        default: return "float32";
+    }
+}
+
+bool runRoundTripTest(wvfrm::SampleFormat format)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> exponent(-24.0f, 1.0f);
+    std::uniform_int_distribution<int> sign(0, 1);
+
+    std::vector<float> input(4096);
+    for (auto& sample : input)
+        sample = (sign(rng) != 0 ? -1.0f : 1.0f) * std::pow(2.0f, exponent(rng));
+
+    input[0] = 0.0f;
+    input[1] = 1.0f;
+    input[2] = -1.0f;
+
+    std::vector<uint16_t> packed(input.size() * 2);
+    std::vector<float> output(input.size());
+    wvfrm::SampleCodec::encode(format, input.data(), packed.data(), static_cast<int>(input.size()));
+    wvfrm::SampleCodec::decode(format, packed.data(), output.data(), static_cast<int>(input.size()));
+
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        const auto error = std::abs(output[i] - input[i]);
+        if (error > wvfrm::SampleCodec::maxError(format, input[i]))
+        {
+            std::cerr << "SampleCodec: " << formatName(format) << " error " << error << " for sample " << input[i]
+                      << " exceeds its bound." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// What the view would draw: gain, clamp to full scale, map onto a 1000 px tall track.
+float toPixels(float sample, float gainLinear)
+{
+    constexpr auto halfHeightPixels = 500.0f;
+    return juce::jlimit(-1.0f, 1.0f, sample * gainLinear) * halfHeightPixels;
+}
+
+bool runVisualErrorTest(wvfrm::SampleFormat format)
+{
+    constexpr auto capacity = 48000;
+    constexpr auto blockSize = 480;
+    constexpr auto maxPixelError = 0.5f;
+
+    wvfrm::AnalysisRingBuffer ring;
+    ring.prepare(2, capacity, format);
+
+    if (ring.getStorageBytes() * 2 != static_cast<size_t>(2 * capacity) * sizeof(float))
+    {
+        std::cerr << "SampleCodec: " << formatName(format) << " ring should use half the float32 footprint." << std::endl;
+        return false;
+    }
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    std::vector<float> history[2];
+
+    for (int block = 0; block < 120; ++block)
+    {
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            for (int s = 0; s < blockSize; ++s)
+            {
+                // Decaying tone plus noise so both loud and near-silent passages are covered.
+                const auto n = static_cast<float>(history[channel].size());
+                const auto v = std::exp(-n / 9000.0f) * (0.9f * std::sin(0.01f * n) + 0.1f * noise(rng));
+                buffer.setSample(channel, s, v);
+                history[channel].push_back(v);
+            }
+        }
+
+        ring.pushBuffer(buffer);
+    }
+
+    wvfrm::AnalysisRingBuffer::ReadSpans spans;
+    if (! ring.readWindowEndingAt(spans, capacity, ring.getTotalWrittenSamples()) || ! spans.needsDecode())
+    {
+        std::cerr << "SampleCodec: compact storage should describe the window and ask for a decode." << std::endl;
+        return false;
+    }
+
+    juce::AudioBuffer<float> decoded;
+    int64_t firstSample = 0;
+    if (! ring.copyWindowEndingAt(decoded, capacity, ring.getTotalWrittenSamples(), &firstSample))
+    {
+        std::cerr << "SampleCodec: decoding copy of compact storage failed." << std::endl;
+        return false;
+    }
+
+    for (const auto gainDb : { 0.0f, 24.0f })
+    {
+        const auto gain = juce::Decibels::decibelsToGain(gainDb);
+        auto worst = 0.0f;
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            for (int s = 0; s < decoded.getNumSamples(); ++s)
+            {
+                const auto original = history[channel][static_cast<size_t>(firstSample + s)];
+                worst = juce::jmax(worst, std::abs(toPixels(decoded.getSample(channel, s), gain) - toPixels(original, gain)));
+            }
+
+            float minimum = 0.0f;
+            float maximum = 0.0f;
+            const auto end = ring.getTotalWrittenSamples();
+            if (! ring.getPeakRange(channel, end - 1003, end - 7, minimum, maximum))
+            {
+                std::cerr << "SampleCodec: peak query on " << formatName(format) << " storage failed." << std::endl;
+                return false;
+            }
+
+            auto expectedMin = 1.0f;
+            auto expectedMax = -1.0f;
+            for (auto s = end - 1003; s < end - 7; ++s)
+            {
+                expectedMin = juce::jmin(expectedMin, history[channel][static_cast<size_t>(s)]);
+                expectedMax = juce::jmax(expectedMax, history[channel][static_cast<size_t>(s)]);
+            }
+
+            worst = juce::jmax(worst, std::abs(toPixels(minimum, gain) - toPixels(expectedMin, gain)));
+            worst = juce::jmax(worst, std::abs(toPixels(maximum, gain) - toPixels(expectedMax, gain)));
+        }
+
+        if (worst > maxPixelError)
+        {
+            std::cerr << "SampleCodec: " << formatName(format) << " drifts " << worst << " px at +" << gainDb
+                      << " dB visual gain." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+} // namespace
+
+bool runSampleCodecTests()
+{
+    bool ok = true;
+
+    for (const auto format : { wvfrm::SampleFormat::float32, wvfrm::SampleFormat::float16, wvfrm::SampleFormat::int16 })
+        ok = runRoundTripTest(format) && ok;
+
+    for (const auto format : { wvfrm::SampleFormat::float16, wvfrm::SampleFormat::int16 })
+        ok = runVisualErrorTest(format) && ok;
+
+    return ok;
+}
@@ -0,0 +1,110 @@
+#include "dsp/ViewActivity.h"
+
+#include <iostream>
+
+namespace
+{
+constexpr int blockSize = 512;
+constexpr double windowSamples = 4096.0;
+
+int64_t feed(wvfrm::ViewActivityState& state, int64_t& blockEnd, bool playing, float minimum, float maximum)
+{
+    blockEnd += blockSize;
+
+    wvfrm::ViewActivityInput input;
+    input.isPlaying = playing;
+    input.minimum = minimum;
+    input.maximum = maximum;
+    input.blockEndSample = blockEnd;
+    input.windowSamples = windowSamples;
+    return wvfrm::updateViewActivity(input, state);
+}
+}
+
+bool runViewActivityTests()
+{
+    bool ok = true;
+
+    {
+        // A stopped host feeding silence settles once the silence fills the window, and stays
+        // settled on the same sample however many more blocks arrive.
+        wvfrm::ViewActivityState state;
+        int64_t blockEnd = 0;
+        feed(state, blockEnd, true, -0.5f, 0.5f);
+        const auto lastActive = feed(state, blockEnd, false, -0.5f, 0.5f) < 0 ? blockEnd : -1;
+
+        auto settledAfter = -1;
+        int64_t settledAt = -1;
+        for (int block = 0; block < 64; ++block)
+        {
+            const auto result = feed(state, blockEnd, false, 0.0f, 0.0f);
+            if (settledAfter < 0 && result >= 0)
+            {
+                settledAfter = block;
+                settledAt = result;
+            }
+            else if (settledAfter >= 0 && result != settledAt)
+            {
+                std::cerr << "ViewActivity: a settled view moved with the sample counter." << std::endl;
+                ok = false;
+                break;
+            }
+        }
+
+        // The first silent block still differs from the audio before it, so the window counts
+        // from its end.
+        const auto expectedBlocks = static_cast<int>(windowSamples) / blockSize;
+        if (settledAfter != expectedBlocks || settledAt != lastActive + blockSize)
+        {
+            std::cerr << "ViewActivity: silence should settle the view exactly once it fills the window." << std::endl;
+            ok = false;
+        }
+    }
+
+    {
+        // A held DC level is as unchanging as silence; a level step or the transport starting is not.
+        wvfrm::ViewActivityState state;
+        int64_t blockEnd = 0;
+        int64_t settled = -1;
+        for (int block = 0; block < 32; ++block)
+            settled = feed(state, blockEnd, false, 0.25f, 0.25f);
+
+        if (settled < 0)
+        {
+            std::cerr << "ViewActivity: a held level with the transport stopped should settle." << std::endl;
+            ok = false;
+        }
+
+        if (feed(state, blockEnd, false, 0.3f, 0.3f) >= 0)
+        {
+            std::cerr << "ViewActivity: a level step must wake the view." << std::endl;
+            ok = false;
+        }
+
+        for (int block = 0; block < 32; ++block)
+            feed(state, blockEnd, false, 0.3f, 0.3f);
+
+        if (feed(state, blockEnd, true, 0.3f, 0.3f) >= 0)
+        {
+            std::cerr << "ViewActivity: a playing transport must keep the view live." << std::endl;
+            ok = false;
+        }
+    }
+
+    {
+        // Audio with the transport stopped is still new audio.
+        wvfrm::ViewActivityState state;
+        int64_t blockEnd = 0;
+        for (int block = 0; block < 32; ++block)
+        {
+            if (feed(state, blockEnd, false, -0.1f, 0.1f) >= 0)
+            {
+                std::cerr << "ViewActivity: input that moves must keep the view live." << std::endl;
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    return ok;
+}
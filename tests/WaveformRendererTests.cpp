@@ -0,0 +1,296 @@
+#include "Parameters.h"
+#include "dsp/AnalysisRingHost.h"
+#include "dsp/BlockSummary.h"
+#include "ui/RenderSource.h"
+#include "ui/WaveformRenderer.h"
+
+#include "AllocationHook.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+constexpr double sampleRate = 48000.0;
+constexpr int blockSize = 480;
+
+// Stands in for the processor: a ring fed with a sine, block summaries beside it and a loop
+// clock that follows the newest sample. Of the view parameters only the loop switch and the
+// colour mode exist, the latter at the plugin's three-band default; the ring's sample format
+// can be picked.
+class FakeRenderSource : public wvfrm::RenderSource
+{
+public:
+    explicit FakeRenderSource(bool loop, wvfrm::SampleFormat format = wvfrm::SampleFormat::float32)
+        : block(2, blockSize)
+    {
+        wvfrm::AnalysisRingHost::Layout layout;
+        layout.channels = 2;
+        layout.capacity = 1 << 16;
+        layout.format = format;
+        layout.sampleRate = sampleRate;
+        ring.rebuild(layout);
+        summarizer.prepare(wvfrm::BlockSummarizer::defaultSamplesPerSummary);
+        waveLoop.store(loop ? 1.0f : 0.0f);
+    }
+
+    // Stands in for processBlock.
+    void pushBlock() noexcept
+    {
+        for (int channel = 0; channel < 2; ++channel)
+            for (int s = 0; s < blockSize; ++s)
+                block.setSample(channel, s, 0.8f * std::sin(static_cast<float>(position + s) * (channel == 0 ? 0.01f : 0.37f)));
+
+        auto adopted = false;
+        auto& target = ring.beginBlock(adopted);
+        const auto blockStart = target.getTotalWrittenSamples();
+        target.pushBuffer(block);
+        if (isSummaryConsumerAttached())
+            summarizer.process(block, blockStart, 0.0, 0.0, summaries);
+
+        position += blockSize;
+        newestSample.store(target.getTotalWrittenSamples(), std::memory_order_release);
+    }
+
+    const std::atomic<float>* getViewParameter(const char* parameterID) const noexcept override
+    {
+        if (std::strcmp(parameterID, wvfrm::ParamIDs::waveLoop) == 0)
+            return &waveLoop;
+
+        return std::strcmp(parameterID, wvfrm::ParamIDs::colorMode) == 0 ? &colorMode : nullptr;
+    }
+
+    juce::AudioChannelSet getCaptureLayout() const override
+    {
+        return juce::AudioChannelSet::stereo();
+    }
+
+    wvfrm::TimeWindowResolver::ResolvedWindow resolveCurrentWindow() const noexcept override
+    {
+        return { 250.0, true, 120.0 };
+    }
+
+    bool getLoopRenderFrame(LoopRenderFrame& out, int requestedSamples) const override
+    {
+        const auto endSample = newestSample.load(std::memory_order_acquire);
+        if (! ring.reader().readWindowEndingAt(out.spans, requestedSamples, endSample))
+            return false;
+
+        out.phaseNormalized = static_cast<float>(endSample % requestedSamples) / static_cast<float>(requestedSamples);
+        out.phaseReliable = true;
+        out.phaseSample = endSample;
+        out.isPlaying = true;
+        return true;
+    }
+
+    wvfrm::AnalysisRingHost::ReadScope pinAnalysis() const noexcept override
+    {
+        return wvfrm::AnalysisRingHost::ReadScope(ring);
+    }
+
+    bool isAnalysisReadCurrent(const wvfrm::AnalysisRingBuffer::ReadSpans& spans) const noexcept override
+    {
+        return ring.reader().isReadStillValid(spans);
+    }
+
+    bool copyAnalysisWindow(juce::AudioBuffer<float>& destination,
+                            int numSamples,
+                            int64_t endSample,
+                            int64_t& firstSample) const override
+    {
+        return ring.reader().copyWindowEndingAt(destination, numSamples, endSample, &firstSample);
+    }
+
+    bool getPeakRange(int channel, int64_t startSample, int64_t endSample, float& minimum, float& maximum) const noexcept override
+    {
+        return ring.reader().getPeakRange(channel, startSample, endSample, minimum, maximum);
+    }
+
+    bool getBandEnergies(wvfrm::BandEnergyRing::Lane lane,
+                         int channel,
+                         int64_t startSample,
+                         int64_t endSample,
+                         wvfrm::BandEnergies& energies) const noexcept override
+    {
+        return ring.reader().getBandEnergies(lane, channel, startSample, endSample, energies);
+    }
+
+    double getCurrentSampleRateHz() const noexcept override { return sampleRate; }
+    double getAnalysisSampleRateHz() const noexcept override { return sampleRate; }
+    int getAnalysisCapacity() const noexcept override { return ring.reader().getCapacity(); }
+
+    int drainBlockSummaries(wvfrm::BlockSummaryHistory& history) noexcept override
+    {
+        return history.drain(summaries);
+    }
+
+    void setSummaryConsumerAttached(bool attached) noexcept override
+    {
+        summaryConsumerAttached.store(attached, std::memory_order_release);
+    }
+
+    bool isSummaryConsumerAttached() const noexcept
+    {
+        return summaryConsumerAttached.load(std::memory_order_acquire);
+    }
+
+private:
+    wvfrm::AnalysisRingHost ring;
+    wvfrm::BlockSummaryQueue summaries { 4096 };
+    wvfrm::BlockSummarizer summarizer;
+    juce::AudioBuffer<float> block;
+    int64_t position = 0;
+    std::atomic<int64_t> newestSample { 0 };
+    std::atomic<float> waveLoop { 1.0f };
+    std::atomic<float> colorMode { static_cast<float>(wvfrm::ColorMode::threeBand) };
+    std::atomic<bool> summaryConsumerAttached { false };
+};
+
+// Feeds a block unless the audio stopped, asks for a frame and waits for it, the way the view
+// does once per vblank.
+bool renderNextFrame(FakeRenderSource& source, wvfrm::WaveformRenderer& renderer, bool feed = true)
+{
+    if (feed)
+        source.pushBlock();
+
+    renderer.requestFrame({ 0, 0, 640, 240 }, 1.0f);
+
+    for (int attempt = 0; attempt < 2000; ++attempt)
+    {
+        if (renderer.fetchFrame())
+            return true;
+
+        juce::Thread::sleep(1);
+    }
+
+    return false;
+}
+
+// Compact formats cannot be read in place, so every frame decodes its window through
+// copyAnalysisWindow into the renderer's scratch buffer, which must keep its size.
+bool runSteadyStateTest(bool loop, wvfrm::SampleFormat format = wvfrm::SampleFormat::float32)
+{
+    const auto* mode = format != wvfrm::SampleFormat::float32 ? (loop ? "loop, int16" : "scroll, int16")
+                                                              : (loop ? "loop" : "scroll");
+    FakeRenderSource source(loop, format);
+    wvfrm::WaveformRenderer renderer(source);
+
+    // Warm-up: the first frames size every buffer, cache and image, and fill each mailbox slot.
+    for (int frameIndex = 0; frameIndex < 8; ++frameIndex)
+    {
+        if (! renderNextFrame(source, renderer))
+        {
+            std::cerr << "WaveformRenderer (" << mode << "): no frame arrived during warm-up." << std::endl;
+            return false;
+        }
+    }
+
+    if (! renderer.currentFrame().hasAudio || renderer.currentFrame().columnsAnalysed <= 0)
+    {
+        std::cerr << "WaveformRenderer (" << mode << "): warm-up frames should show the fed audio." << std::endl;
+        return false;
+    }
+
+    auto framesOk = true;
+    auto allocations = 0;
+    {
+        AllocationProbe probe;
+        for (int frameIndex = 0; frameIndex < 16 && framesOk; ++frameIndex)
+            framesOk = renderNextFrame(source, renderer);
+
+        allocations = probe.count();
+    }
+
+    if (! framesOk)
+    {
+        std::cerr << "WaveformRenderer (" << mode << "): a steady-state frame never arrived." << std::endl;
+        return false;
+    }
+
+    if (allocations != 0)
+    {
+        std::cerr << "WaveformRenderer (" << mode << "): " << allocations << " heap allocations in 16 steady-state frames." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// While the audio moves the colours chase it; once it stops they finish easing and the renderer
+// says so, which is what lets an idle view stop asking for frames.
+bool runSettlingTest()
+{
+    FakeRenderSource source(true);
+    wvfrm::WaveformRenderer renderer(source);
+    auto sawSettling = false;
+
+    for (int frameIndex = 0; frameIndex < 8; ++frameIndex)
+    {
+        if (! renderNextFrame(source, renderer))
+        {
+            std::cerr << "WaveformRenderer (settling): no frame arrived while feeding." << std::endl;
+            return false;
+        }
+
+        sawSettling = sawSettling || renderer.currentFrame().settling;
+    }
+
+    if (! sawSettling)
+    {
+        std::cerr << "WaveformRenderer: colours chasing fresh audio should be reported as settling." << std::endl;
+        return false;
+    }
+
+    for (int frameIndex = 0; frameIndex < 1000; ++frameIndex)
+    {
+        if (! renderNextFrame(source, renderer, false))
+        {
+            std::cerr << "WaveformRenderer (settling): no frame arrived after the audio stopped." << std::endl;
+            return false;
+        }
+
+        if (! renderer.currentFrame().settling)
+            return true;
+    }
+
+    std::cerr << "WaveformRenderer: colours never settled once the audio stopped." << std::endl;
+    return false;
+}
+
+// Summaries are published only while a renderer is there to drain them.
+bool runConsumerAttachTest()
+{
+    FakeRenderSource source(true);
+
+    {
+        wvfrm::WaveformRenderer renderer(source);
+        if (! source.isSummaryConsumerAttached())
+        {
+            std::cerr << "WaveformRenderer: a live renderer should attach as the summary consumer." << std::endl;
+            return false;
+        }
+    }
+
+    if (source.isSummaryConsumerAttached())
+    {
+        std::cerr << "WaveformRenderer: a destroyed renderer should detach from the summaries." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+} // namespace
+
+bool runWaveformRendererTests()
+{
+    bool ok = true;
+    ok = runSteadyStateTest(true) && ok;
+    ok = runSteadyStateTest(false) && ok;
+    ok = runSteadyStateTest(true, wvfrm::SampleFormat::int16) && ok;
+    ok = runSteadyStateTest(false, wvfrm::SampleFormat::int16) && ok;
+    ok = runSettlingTest() && ok;
+    ok = runConsumerAttachTest() && ok;
+    return ok;
+}
@@ -0,0 +1,83 @@
+#include "ui/WorkStealingPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+bool runEveryTaskOnceTest()
+{
+    for (const auto numWorkers : { 0, 1, 3 })
+    {
+        wvfrm::WorkStealingPool pool(numWorkers);
+        std::vector<std::atomic<int>> counts(257);
+
+        // Many small batches back to back, so late wake-ups overlap the next batch.
+        for (int batch = 0; batch < 200; ++batch)
+        {
+            const auto numTasks = 1 + (batch * 37) % static_cast<int>(counts.size());
+            auto task = [&](int taskIndex, int lane)
+            {
+                if (lane >= 0 && lane < pool.getNumLanes())
+                    counts[static_cast<size_t>(taskIndex)].fetch_add(1);
+            };
+
+            pool.run(numTasks, task);
+
+            for (int i = 0; i < static_cast<int>(counts.size()); ++i)
+            {
+                if (counts[static_cast<size_t>(i)].exchange(0) != (i < numTasks ? 1 : 0))
+                {
+                    std::cerr << "WorkStealingPool: task " << i << " of " << numTasks << " did not run exactly once with "
+                              << numWorkers << " workers." << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool runStealTest()
+{
+    wvfrm::WorkStealingPool pool(3);
+    const auto numLanes = pool.getNumLanes();
+    constexpr auto numTasks = 32;
+
+    // The first lane is dealt the slow tasks; the others finish theirs at once and must take
+    // some of the slow ones off its back.
+    std::vector<int> ranOn(numTasks, -1);
+    auto task = [&](int taskIndex, int lane)
+    {
+        ranOn[static_cast<size_t>(taskIndex)] = lane;
+        if (taskIndex < numTasks / numLanes)
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    };
+
+    pool.run(numTasks, task);
+
+    auto stolen = 0;
+    for (int i = 0; i < numTasks / numLanes; ++i)
+        stolen += ranOn[static_cast<size_t>(i)] != 0 ? 1 : 0;
+
+    if (stolen == 0)
+    {
+        std::cerr << "WorkStealingPool: idle lanes should steal from a busy one." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+} // namespace
+
+bool runWorkStealingPoolTests()
+{
+    bool ok = true;
+    ok = runEveryTaskOnceTest() && ok;
+    ok = runStealTest() && ok;
+    return ok;
+}
@@ -3,23 +3,53 @@
 
 bool runTimeWindowResolverTests();
 bool runBandAnalyzerTests();
+bool runCrossoverBandAnalyzerTests();
 bool runChannelViewsTests();
 bool runAnalysisRingBufferTests();
+bool runAnalysisRingHostTests();
+bool runPeakPyramidTests();
+bool runBlockSummaryTests();
+bool runSampleCodecTests();
+bool runHalfBandDecimatorTests();
+bool runBandEnergyRingTests();
+bool runSpectralBandEngineTests();
 bool runLoopClockTests();
 bool runParametersTests();
 bool runThemeEngineTests();
+bool runColumnRasterizerTests();
+bool runFrameMailboxTests();
+bool runWorkStealingPoolTests();
+bool runColourLutTests();
+bool runBandColumnPassesTests();
+bool runSincInterpolatorTests();
+bool runViewActivityTests();
 
 int main()
 {
     const auto ringOk = runAnalysisRingBufferTests();
+    const auto ringHostOk = runAnalysisRingHostTests();
+    const auto peakPyramidOk = runPeakPyramidTests();
+    const auto blockSummaryOk = runBlockSummaryTests();
+    const auto sampleCodecOk = runSampleCodecTests();
+    const auto decimatorOk = runHalfBandDecimatorTests();
+    const auto bandEnergyOk = runBandEnergyRingTests();
+    const auto spectralOk = runSpectralBandEngineTests();
     const auto clockOk = runLoopClockTests();
     const auto timeOk = runTimeWindowResolverTests();
     const auto bandOk = runBandAnalyzerTests();
+    const auto crossoverOk = runCrossoverBandAnalyzerTests();
     const auto channelOk = runChannelViewsTests();
     const auto parametersOk = runParametersTests();
     const auto themeEngineOk = runThemeEngineTests();
+    const auto rasterizerOk = runColumnRasterizerTests();
+    const auto mailboxOk = runFrameMailboxTests();
+    const auto poolOk = runWorkStealingPoolTests();
+    const auto colourLutOk = runColourLutTests();
+    const auto bandPassesOk = runBandColumnPassesTests();
+    const auto sincOk = runSincInterpolatorTests();
+    const auto viewActivityOk = runViewActivityTests();
 
-    if (ringOk && clockOk && timeOk && bandOk && channelOk && parametersOk && themeEngineOk)
+    if (ringOk && ringHostOk && peakPyramidOk && blockSummaryOk && sampleCodecOk && decimatorOk && bandEnergyOk && spectralOk && clockOk && timeOk && bandOk && crossoverOk && channelOk && parametersOk && themeEngineOk && rasterizerOk && mailboxOk && poolOk && colourLutOk && bandPassesOk && sincOk && viewActivityOk)
     {
         std::cout << "All tests passed." << std::endl;
         return EXIT_SUCCESS;